@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BENCH_HPP
+#define LIBBITCOIN_NETWORK_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace libbitcoin {
+namespace network {
+namespace bench {
+
+typedef std::chrono::steady_clock timer;
+typedef std::function<void(std::ostream&)> benchmark;
+
+/// A named benchmark, which writes its own results to the stream.
+struct entry
+{
+    std::string name;
+    benchmark run;
+};
+
+/// The benchmarks registered during static initialization.
+std::vector<entry>& registry();
+
+/// Register a benchmark during static initialization.
+struct registrar
+{
+    registrar(const std::string& name, benchmark run);
+};
+
+/// The number of heap allocations made by the process so far.
+size_t allocations();
+
+/// Write a result line with the count and cost per operation.
+void report(std::ostream& out, const std::string& name, size_t count,
+    timer::duration elapsed);
+
+/// Write a result line with the latency distribution of the samples.
+void report(std::ostream& out, const std::string& name,
+    std::vector<timer::duration>& samples);
+
+/// Write a result line with the count and allocations per operation.
+void report_allocations(std::ostream& out, const std::string& name,
+    size_t count, size_t allocations);
+
+} // namespace bench
+} // namespace network
+} // namespace libbitcoin
+
+#define BENCHMARK(name) \
+    static void name(std::ostream& out); \
+    static const libbitcoin::network::bench::registrar name##_registrar( \
+        #name, name); \
+    static void name(std::ostream& out)
+
+#endif
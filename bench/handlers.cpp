@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+using namespace bc::network::bench;
+using namespace std::placeholders;
+
+static const size_t round_trips = 100000;
+static const uint32_t level = version::level::maximum;
+static const uint32_t magic = 0xd9b4bef9;
+
+// A stand-in for a pair of ping protocols, bound as protocol::send and
+// protocol::subscribe bind them. Socket writes and reads are excluded, the
+// payload is passed directly from the serializer to the other subscriber.
+template <typename Handler>
+class peer
+  : public std::enable_shared_from_this<peer<Handler>>
+{
+public:
+    typedef std::shared_ptr<peer<Handler>> ptr;
+
+    peer(threadpool& pool)
+      : subscriber_(pool)
+    {
+        subscriber_.start();
+    }
+
+    void start(ptr other)
+    {
+        other_ = other;
+        const auto self = this->shared_from_this();
+        subscriber_.subscribe<ping>(
+            std::bind(&peer::handle_receive_ping, self, _1, _2),
+            delivery::invoke);
+        subscriber_.subscribe<pong>(
+            std::bind(&peer::handle_receive_pong, self, _1, _2),
+            delivery::invoke);
+    }
+
+    // Release the subscriptions and the other peer, which hold this one.
+    void stop()
+    {
+        subscriber_.broadcast(error::channel_stopped);
+        subscriber_.stop();
+        other_.reset();
+    }
+
+    template <class Message>
+    void send(const Message& packet)
+    {
+        const auto payload = std::make_shared<const data_chunk>(
+            message::serialize(level, packet, magic));
+
+        Handler handler(std::bind(&peer::handle_send, this->shared_from_this(),
+            _1, packet.command));
+
+        handler(error::success);
+        other_->receive(packet.command == ping::command ?
+            message_type::ping : message_type::pong, *payload);
+    }
+
+private:
+    void receive(message_type type, const data_chunk& data)
+    {
+        auto source = make_safe_deserializer(
+            data.begin() + heading::satoshi_fixed_size(), data.end());
+        subscriber_.load(type, level, source);
+    }
+
+    void handle_send(const code&, const std::string&)
+    {
+    }
+
+    bool handle_receive_ping(const code& ec, ping::const_ptr message)
+    {
+        if (!ec)
+            send(pong(message->nonce()));
+
+        return !ec;
+    }
+
+    bool handle_receive_pong(const code& ec, pong::const_ptr)
+    {
+        return !ec;
+    }
+
+    ptr other_;
+    message_subscriber subscriber_;
+};
+
+template <typename Handler>
+static void ping_pong(std::ostream& out, const std::string& name)
+{
+    threadpool pool(1);
+    const auto left = std::make_shared<peer<Handler>>(pool);
+    const auto right = std::make_shared<peer<Handler>>(pool);
+    left->start(right);
+    right->start(left);
+
+    // Warm up lazily created subscribers and thread local state.
+    left->send(ping(0));
+
+    const auto start = allocations();
+
+    for (size_t nonce = 0; nonce < round_trips; ++nonce)
+        left->send(ping(nonce));
+
+    report_allocations(out, name, round_trips, allocations() - start);
+
+    left->stop();
+    right->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+// Allocations per ping/pong round trip, by send handler type.
+BENCHMARK(ping_pong_allocations)
+{
+    ping_pong<proxy::result_handler>(out, "ping_pong_std_function");
+    ping_pong<proxy::send_handler>(out, "ping_pong_small_handler");
+}
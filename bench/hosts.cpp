@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+using namespace bc::network::bench;
+
+#define HOSTS_FILE "hosts_bench.cache"
+
+static const size_t capacity = 10000;
+static const size_t fetches = 100000;
+static const size_t writers = 2;
+
+// Generate distinct ipv4-mapped addresses from a sequence number.
+static network_address make_address(uint32_t sequence)
+{
+    const ip_address ip
+    {
+        {
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff,
+            static_cast<uint8_t>(sequence >> 24),
+            static_cast<uint8_t>(sequence >> 16),
+            static_cast<uint8_t>(sequence >> 8),
+            static_cast<uint8_t>(sequence)
+        }
+    };
+
+    return network_address(0, 0, ip, 8333);
+}
+
+static network_address::list make_addresses(uint32_t start, size_t count)
+{
+    network_address::list out;
+    out.reserve(count);
+
+    for (size_t index = 0; index < count; ++index)
+        out.push_back(make_address(start + static_cast<uint32_t>(index)));
+
+    return out;
+}
+
+// Measure fetch latency while writers flood the pool with addr messages.
+static void fetch_under_store(std::ostream& out, uint32_t shards)
+{
+    boost::filesystem::remove_all(HOSTS_FILE);
+    network::settings configuration;
+    configuration.host_pool_capacity = capacity;
+    configuration.host_pool_shards = shards;
+    configuration.hosts_file = HOSTS_FILE;
+
+    hosts pool(configuration);
+    pool.start();
+
+    for (const auto& host: make_addresses(0, capacity))
+        pool.store(host);
+
+    std::atomic<bool> done(false);
+    std::atomic<size_t> stored(0);
+    std::vector<std::thread> threads;
+    const auto ignore = [](const code&) {};
+
+    for (size_t writer = 0; writer < writers; ++writer)
+    {
+        threads.emplace_back([&, writer]()
+        {
+            auto start = static_cast<uint32_t>(capacity * (writer + 1));
+
+            while (!done)
+            {
+                pool.store(make_addresses(start, max_address), ignore);
+                start += max_address;
+                stored += max_address;
+            }
+        });
+    }
+
+    network_address host;
+    std::vector<timer::duration> samples;
+    samples.reserve(fetches);
+    const auto begin = timer::now();
+
+    for (size_t count = 0; count < fetches; ++count)
+    {
+        const auto start = timer::now();
+        pool.fetch(host);
+        samples.push_back(timer::now() - start);
+    }
+
+    const auto elapsed = timer::now() - begin;
+    done = true;
+
+    for (auto& thread: threads)
+        thread.join();
+
+    const auto name = "hosts fetch, shards " + std::to_string(shards);
+    report(out, name, fetches, elapsed);
+    report(out, name, samples);
+    report(out, "hosts store (concurrent), shards " + std::to_string(shards),
+        stored, elapsed);
+
+    pool.stop();
+    boost::filesystem::remove_all(HOSTS_FILE);
+}
+
+BENCHMARK(hosts__fetch__concurrent_store)
+{
+    fetch_under_store(out, 1);
+    fetch_under_store(out, 8);
+    fetch_under_store(out, 32);
+}
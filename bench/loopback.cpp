@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "loopback.hpp"
+
+#include <future>
+#include <memory>
+#include <boost/asio.hpp>
+#include <bitcoin/network.hpp>
+
+namespace libbitcoin {
+namespace network {
+namespace bench {
+
+using namespace boost::asio;
+
+static void start_channel(channel::ptr channel)
+{
+    std::promise<code> started;
+    channel->start([&started](const code& ec)
+    {
+        started.set_value(ec);
+    });
+
+    started.get_future().wait();
+}
+
+loopback::loopback(threadpool& pool, const settings& settings,
+    buffer_pool::ptr buffers, timer_wheel::ptr timers)
+{
+    const ip::tcp::endpoint local(ip::address_v4::loopback(), 0);
+    ip::tcp::acceptor listener(pool.service(), local);
+    const auto client = std::make_shared<bc::socket>(pool);
+    const auto server = std::make_shared<bc::socket>(pool);
+
+    // The connection completes in the backlog, before it is accepted.
+    client->get().connect(listener.local_endpoint());
+    listener.accept(server->get());
+
+    connected_ = std::make_shared<channel>(pool, client, settings, buffers,
+        timers);
+    accepted_ = std::make_shared<channel>(pool, server, settings, buffers,
+        timers);
+
+    start_channel(connected_);
+    start_channel(accepted_);
+}
+
+loopback::~loopback()
+{
+    connected_->stop(error::channel_stopped);
+    accepted_->stop(error::channel_stopped);
+}
+
+channel::ptr loopback::connected() const
+{
+    return connected_;
+}
+
+channel::ptr loopback::accepted() const
+{
+    return accepted_;
+}
+
+settings offline_settings()
+{
+    settings configuration(config::settings::mainnet);
+    configuration.seeds.clear();
+    configuration.host_pool_capacity = 0;
+    configuration.inbound_connections = 0;
+    configuration.outbound_connections = 0;
+    configuration.send_high_water_bytes = max_uint32;
+    configuration.send_high_water_messages = max_uint32;
+    return configuration;
+}
+
+code start(p2p& network)
+{
+    std::promise<code> started;
+    network.start([&started](const code& ec)
+    {
+        started.set_value(ec);
+    });
+
+    return started.get_future().get();
+}
+
+code run(p2p& network)
+{
+    std::promise<code> running;
+    network.run([&running](const code& ec)
+    {
+        running.set_value(ec);
+    });
+
+    return running.get_future().get();
+}
+
+} // namespace bench
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BENCH_LOOPBACK_HPP
+#define LIBBITCOIN_NETWORK_BENCH_LOOPBACK_HPP
+
+#include <bitcoin/network.hpp>
+
+namespace libbitcoin {
+namespace network {
+namespace bench {
+
+/// A pair of started channels connected over the loopback interface.
+/// Both channels are stopped upon destruct.
+class loopback
+  : noncopyable
+{
+public:
+    /// Connect on the pool, with the buffers and timers of the channels.
+    loopback(threadpool& pool, const settings& settings,
+        buffer_pool::ptr buffers, timer_wheel::ptr timers);
+
+    ~loopback();
+
+    /// The channel that connected.
+    channel::ptr connected() const;
+
+    /// The channel that accepted.
+    channel::ptr accepted() const;
+
+private:
+    channel::ptr connected_;
+    channel::ptr accepted_;
+};
+
+/// Settings with the mainnet identifier that start a network offline,
+/// without seeding, hosts or sessions, and without send back-pressure.
+settings offline_settings();
+
+/// Start the network and wait for the result.
+code start(p2p& network);
+
+/// Run the network and wait for the result.
+code run(p2p& network);
+
+} // namespace bench
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// Count heap allocations made by the process, for allocation benchmarks.
+static std::atomic<size_t> allocated(0);
+
+void* operator new(size_t size)
+{
+    ++allocated;
+    const auto block = std::malloc(size == 0 ? 1 : size);
+
+    if (block == nullptr)
+        throw std::bad_alloc();
+
+    return block;
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+namespace libbitcoin {
+namespace network {
+namespace bench {
+
+using namespace std::chrono;
+
+std::vector<entry>& registry()
+{
+    static std::vector<entry> entries;
+    return entries;
+}
+
+registrar::registrar(const std::string& name, benchmark run)
+{
+    registry().push_back({ name, run });
+}
+
+size_t allocations()
+{
+    return allocated.load();
+}
+
+static double to_nanoseconds(timer::duration elapsed)
+{
+    return static_cast<double>(duration_cast<nanoseconds>(elapsed).count());
+}
+
+void report(std::ostream& out, const std::string& name, size_t count,
+    timer::duration elapsed)
+{
+    const auto total = to_nanoseconds(elapsed);
+    const auto each = count == 0 ? 0.0 : total / count;
+
+    out << std::left << std::setw(48) << name << std::right
+        << std::setw(12) << count << " ops "
+        << std::setw(12) << std::fixed << std::setprecision(1) << each
+        << " ns/op" << std::endl;
+}
+
+void report(std::ostream& out, const std::string& name,
+    std::vector<timer::duration>& samples)
+{
+    if (samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+    const auto at = [&samples](size_t percent)
+    {
+        return to_nanoseconds(samples[(samples.size() - 1) * percent / 100]);
+    };
+
+    out << std::left << std::setw(48) << name << std::right
+        << std::fixed << std::setprecision(0)
+        << " p50 " << std::setw(10) << at(50)
+        << " p99 " << std::setw(10) << at(99)
+        << " max " << std::setw(10) << at(100) << " ns" << std::endl;
+}
+
+void report_allocations(std::ostream& out, const std::string& name,
+    size_t count, size_t allocations)
+{
+    const auto each = count == 0 ? 0.0 :
+        static_cast<double>(allocations) / count;
+
+    out << std::left << std::setw(48) << name << std::right
+        << std::setw(12) << count << " ops "
+        << std::setw(12) << std::fixed << std::setprecision(1) << each
+        << " allocs/op" << std::endl;
+}
+
+} // namespace bench
+} // namespace network
+} // namespace libbitcoin
+
+// Run all benchmarks, or those with names containing the first argument.
+int main(int argc, char* argv[])
+{
+    using namespace libbitcoin::network::bench;
+    const std::string filter(argc > 1 ? argv[1] : "");
+
+    for (const auto& benchmark: registry())
+        if (benchmark.name.find(filter) != std::string::npos)
+            benchmark.run(std::cout);
+
+    return 0;
+}
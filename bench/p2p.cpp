@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+#include "loopback.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+using namespace bc::network::bench;
+
+static const size_t rounds = 2000;
+static const size_t handshakes = 200;
+static const uint16_t handshake_port = 28333;
+
+// Measure the completion of broadcasts, each a ping to every channel,
+// from the accepting side of each of the loopback connections.
+static void broadcast_fan_out(std::ostream& out, size_t channels)
+{
+    const auto configuration = offline_settings();
+    p2p network(configuration);
+
+    if (bench::start(network))
+    {
+        out << "p2p broadcast: failed to start network" << std::endl;
+        return;
+    }
+
+    std::vector<std::shared_ptr<loopback>> links;
+    links.reserve(channels);
+
+    for (size_t index = 0; index < channels; ++index)
+    {
+        const auto link = std::make_shared<loopback>(network.channel_pool(),
+            configuration, network.buffers(), network.timers());
+        link->accepted()->set_nonce(index + 1);
+        network.store(link->accepted());
+        links.push_back(link);
+    }
+
+    const auto ignore = [](const code&, channel::ptr) {};
+    const auto start = timer::now();
+
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        std::promise<code> complete;
+        network.broadcast(ping(round), ignore, [&complete](const code& ec)
+        {
+            complete.set_value(ec);
+        });
+
+        complete.get_future().wait();
+    }
+
+    report(out, "p2p broadcast ping, channels " + std::to_string(channels),
+        rounds, timer::now() - start);
+
+    links.clear();
+    network.close();
+}
+
+BENCHMARK(p2p__broadcast__fan_out)
+{
+    broadcast_fan_out(out, 8);
+    broadcast_fan_out(out, 64);
+    broadcast_fan_out(out, 256);
+}
+
+// Distinct loopback hosts keep the connections unique by authority, as is
+// required of them by the connecting network (this relies on the whole
+// 127.0.0.0/8 block being routed to the loopback interface).
+static std::string loopback_host(size_t index)
+{
+    return "127.0." + std::to_string(1 + index / 250) + "." +
+        std::to_string(1 + index % 250);
+}
+
+// Measure the rate of manual connections that complete the handshake with
+// session_inbound over localhost, one at a time.
+BENCHMARK(session_inbound__handshake__localhost)
+{
+    auto server_configuration = offline_settings();
+    server_configuration.inbound_port = handshake_port;
+    server_configuration.inbound_connections = handshakes;
+    p2p server(server_configuration);
+
+    const auto client_configuration = offline_settings();
+    p2p client(client_configuration);
+
+    if (bench::start(server) || bench::run(server) || bench::start(client))
+    {
+        out << "session_inbound handshake: failed to start networks"
+            << std::endl;
+        return;
+    }
+
+    std::vector<timer::duration> samples;
+    samples.reserve(handshakes);
+    const auto start = timer::now();
+
+    for (size_t index = 0; index < handshakes; ++index)
+    {
+        std::promise<code> connected;
+        const auto begin = timer::now();
+
+        client.connect(loopback_host(index), handshake_port,
+            [&connected](const code& ec, channel::ptr)
+            {
+                connected.set_value(ec);
+            });
+
+        if (connected.get_future().get())
+            break;
+
+        samples.push_back(timer::now() - begin);
+    }
+
+    const auto elapsed = timer::now() - start;
+    report(out, "session_inbound handshake", samples.size(), elapsed);
+    report(out, "session_inbound handshake", samples);
+
+    client.close();
+    server.close();
+}
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+#include "loopback.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+using namespace bc::network::bench;
+
+static const size_t messages = 20000;
+static const size_t inventories = 500;
+static const size_t headings = 2000;
+static const size_t addresses = 1000;
+
+// Measure the rate at which the accepting channel reads and decodes the
+// messages written by the connecting channel, from first send to last
+// receipt. The sender queues all messages at once, so writes coalesce.
+template <class Message>
+static void read_throughput(std::ostream& out, const std::string& name,
+    const Message& packet)
+{
+    const auto configuration = offline_settings();
+    threadpool pool(2);
+    const auto buffers = std::make_shared<buffer_pool>(
+        configuration.buffer_pool_capacity());
+    const auto timers = std::make_shared<timer_wheel>(pool, asio::seconds(1),
+        64);
+    timers->start();
+
+    std::atomic<size_t> received(0);
+    std::promise<void> done;
+
+    {
+        loopback link(pool, configuration, buffers, timers);
+
+        link.accepted()->subscribe<Message>(
+            [&](const code& ec, std::shared_ptr<const Message>)
+            {
+                if (ec)
+                    return false;
+
+                if (++received != messages)
+                    return true;
+
+                done.set_value();
+                return false;
+            }, delivery::invoke);
+
+        const auto ignore = [](const code&) {};
+        const auto start = timer::now();
+
+        for (size_t count = 0; count < messages; ++count)
+            link.connected()->send(packet, ignore);
+
+        done.get_future().wait();
+        report(out, name, messages, timer::now() - start);
+    }
+
+    timers->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BENCHMARK(proxy__read__by_message_type)
+{
+    read_throughput(out, "proxy read ping", ping(42));
+
+    inventory inventory_message;
+    inventory_message.inventories().assign(inventories,
+        { inventory_vector::type_id::block, null_hash });
+    read_throughput(out, "proxy read inventory (500)", inventory_message);
+
+    headers headers_message;
+    headers_message.elements().assign(headings, message::header{});
+    read_throughput(out, "proxy read headers (2000)", headers_message);
+
+    const ip_address localhost
+    {
+        {
+            0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 127, 0, 0, 1
+        }
+    };
+
+    address address_message;
+    address_message.addresses().assign(addresses,
+        network_address(0, 0, localhost, 8333));
+    read_throughput(out, "proxy read address (1000)", address_message);
+}
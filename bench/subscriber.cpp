@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "bench.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+using namespace bc::network::bench;
+
+static const size_t loads = 1000000;
+static const uint32_t level = version::level::maximum;
+
+// Measure message_subscriber::load, from the deserialization of a ping
+// payload to the invocation of its subscriber on the loading thread.
+static void load_dispatch(std::ostream& out, const std::string& name,
+    bool subscribed)
+{
+    threadpool pool(1);
+    message_subscriber subscriber(pool);
+    subscriber.start();
+
+    if (subscribed)
+        subscriber.subscribe<ping>([](const code& ec, ping::const_ptr)
+        {
+            return !ec;
+        }, delivery::invoke);
+
+    const auto payload = ping(42).to_data(level);
+    const auto start = timer::now();
+
+    for (size_t count = 0; count < loads; ++count)
+    {
+        auto source = make_safe_deserializer(payload.begin(), payload.end());
+        subscriber.load(message_type::ping, level, source);
+    }
+
+    report(out, name, loads, timer::now() - start);
+
+    subscriber.broadcast(error::channel_stopped);
+    subscriber.stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BENCHMARK(message_subscriber__load__dispatch)
+{
+    load_dispatch(out, "message_subscriber load ping, subscribed", true);
+    load_dispatch(out, "message_subscriber load ping, unsubscribed", false);
+}
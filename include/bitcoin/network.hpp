@@ -16,18 +16,44 @@
 
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/acceptor.hpp>
+#include <bitcoin/network/anchors.hpp>
+#include <bitcoin/network/backoff.hpp>
+#include <bitcoin/network/blacklist.hpp>
+#include <bitcoin/network/block_download.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/channel_cache.hpp>
+#include <bitcoin/network/channel_metrics.hpp>
+#include <bitcoin/network/channel_registry.hpp>
+#include <bitcoin/network/checksum.hpp>
 #include <bitcoin/network/connector.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
+#include <bitcoin/network/header_sync.hpp>
 #include <bitcoin/network/hosts.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
 #include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/partial_block.hpp>
+#include <bitcoin/network/pipe_transport.hpp>
 #include <bitcoin/network/proxy.hpp>
+#include <bitcoin/network/relay_filter.hpp>
+#include <bitcoin/network/rolling_bloom.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/small_handler.hpp>
+#include <bitcoin/network/socket_transport.hpp>
+#include <bitcoin/network/statistics_exporter.hpp>
+#include <bitcoin/network/stream_decoder.hpp>
+#include <bitcoin/network/subnet.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/transport.hpp>
 #include <bitcoin/network/version.hpp>
 #include <bitcoin/network/protocols/protocol.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_block_download.hpp>
+#include <bitcoin/network/protocols/protocol_compact_block.hpp>
 #include <bitcoin/network/protocols/protocol_events.hpp>
+#include <bitcoin/network/protocols/protocol_header_sync.hpp>
+#include <bitcoin/network/protocols/protocol_inventory_relay.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
@@ -37,9 +63,12 @@
 #include <bitcoin/network/protocols/protocol_version_70002.hpp>
 #include <bitcoin/network/sessions/session.hpp>
 #include <bitcoin/network/sessions/session_batch.hpp>
+#include <bitcoin/network/sessions/session_block_download.hpp>
+#include <bitcoin/network/sessions/session_header_sync.hpp>
 #include <bitcoin/network/sessions/session_inbound.hpp>
 #include <bitcoin/network/sessions/session_manual.hpp>
 #include <bitcoin/network/sessions/session_outbound.hpp>
 #include <bitcoin/network/sessions/session_seed.hpp>
+#include <bitcoin/network/sessions/session_sync.hpp>
 
 #endif
@@ -24,9 +24,12 @@
 #include <functional>
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/channel_cache.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -34,15 +37,26 @@ namespace network {
 /// Create inbound socket connections.
 /// This class is thread safe against stop.
 /// This class is not safe for concurrent listening attempts.
+/// This class is safe for concurrent accept attempts.
 class BCT_API acceptor
   : public enable_shared_from_base<acceptor>, noncopyable, track<acceptor>
 {
 public:
     typedef std::shared_ptr<acceptor> ptr;
     typedef std::function<void(const code&, channel::ptr)> accept_handler;
+    typedef std::function<code(const config::authority&)> admission_handler;
+    typedef std::function<threadpool&()> pool_selector;
 
-    /// Construct an instance.
-    acceptor(threadpool& pool, const settings& settings);
+    /// Construct an instance, with accepted channels on the acceptor pool.
+    acceptor(threadpool& pool, const settings& settings,
+        buffer_pool::ptr buffers, channel_cache::ptr allocations,
+        timer_wheel::ptr timers);
+
+    /// Construct an instance, with each accepted channel on the pool
+    /// returned by the selector at the start of its accept.
+    acceptor(threadpool& pool, const settings& settings,
+        buffer_pool::ptr buffers, channel_cache::ptr allocations,
+        timer_wheel::ptr timers, pool_selector select);
 
     /// Validate acceptor stopped.
     ~acceptor();
@@ -53,6 +67,11 @@ public:
     /// Accept the next connection available, until canceled.
     virtual void accept(accept_handler handler);
 
+    /// Accept the next connection available, until canceled. The admission
+    /// handler is invoked with the remote authority of the raw socket before
+    /// creation of a channel, and a socket that it rejects is closed.
+    virtual void accept(admission_handler admit, accept_handler handler);
+
     /// Cancel outstanding accept attempt.
     virtual void stop(const code& ec);
 
@@ -60,12 +79,16 @@ private:
     virtual bool stopped() const;
 
     void handle_accept(const boost_code& ec, socket::ptr socket,
-        accept_handler handler);
+        threadpool& pool, admission_handler admit, accept_handler handler);
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     threadpool& pool_;
     const settings& settings_;
+    buffer_pool::ptr buffers_;
+    channel_cache::ptr allocations_;
+    timer_wheel::ptr timers_;
+    const pool_selector select_;
     mutable dispatcher dispatch_;
 
     // These are protected by mutex.
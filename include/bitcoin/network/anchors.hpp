@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_ANCHORS_HPP
+#define LIBBITCOIN_NETWORK_ANCHORS_HPP
+
+#include <cstdint>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A file of the outbound peers connected at stop, for reconnection at the
+/// next start. Each line is the authority, negotiated version and round trip
+/// microseconds of a peer. The file is removed upon load, so that anchors are
+/// tried only by the start that follows their save. An empty path disables.
+class BCT_API anchors
+  : noncopyable
+{
+public:
+    struct anchor
+    {
+        config::authority authority;
+        uint32_t version;
+        asio::duration round_trip;
+    };
+
+    typedef std::vector<anchor> list;
+
+    /// Construct an instance.
+    anchors(const boost::filesystem::path& file_path);
+
+    /// Load and remove the file, empty if the file is absent or invalid.
+    virtual list load() const;
+
+    /// Replace the file with the anchors, removing it if there are none.
+    virtual bool save(const list& values) const;
+
+private:
+    const boost::filesystem::path file_path_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BACKOFF_HPP
+#define LIBBITCOIN_NETWORK_BACKOFF_HPP
+
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// An exponential retry delay with jitter, doubling upon each failure up to a
+/// maximum and restored to its initial value upon success. Each delay is
+/// randomized to within the upper half of the current base delay.
+class BCT_API backoff
+  : noncopyable
+{
+public:
+    /// Construct an instance.
+    backoff(const asio::duration& initial, const asio::duration& maximum);
+
+    /// The jittered delay for the next retry, doubles the base delay.
+    asio::duration next();
+
+    /// Restore the initial base delay.
+    void reset();
+
+private:
+    // These are thread safe.
+    const asio::duration initial_;
+    const asio::duration maximum_;
+
+    // This is protected by mutex.
+    asio::duration current_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
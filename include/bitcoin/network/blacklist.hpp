@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BLACKLIST_HPP
+#define LIBBITCOIN_NETWORK_BLACKLIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/subnet.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A set of blocked address ranges, held as a binary prefix trie over the
+/// IPv6 address space (IPv4 as mapped addresses). Lookup walks at most one
+/// node per prefix bit, independent of the number of ranges.
+class BCT_API blacklist
+  : noncopyable
+{
+public:
+    /// Construct an instance.
+    blacklist(const subnet::list& subnets);
+
+    /// Determine if the host of the authority is within a blocked range.
+    bool contains(const config::authority& authority) const;
+
+    /// Determine if the address is within a blocked range.
+    bool contains(const asio::ipv6& ip) const;
+
+    /// Replace all blocked ranges.
+    void load(const subnet::list& subnets);
+
+private:
+    // A zero child is empty, as the root is never a child.
+    struct node
+    {
+        uint32_t children[2];
+        bool terminal;
+    };
+
+    typedef std::vector<node> nodes;
+
+    static nodes build(const subnet::list& subnets);
+
+    // This is protected by mutex.
+    nodes nodes_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
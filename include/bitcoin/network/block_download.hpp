@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BLOCK_DOWNLOAD_HPP
+#define LIBBITCOIN_NETWORK_BLOCK_DOWNLOAD_HPP
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The shared state of block download across channels, thread safe.
+/// Queued blocks are claimed by channels in height order and returned to
+/// the queue if not received, such as upon a stall. Blocks are received in
+/// any order and delivered to the handler in height order, and no block is
+/// claimed beyond the buffer of heights above the next to be delivered, so
+/// at most that number of blocks is held here.
+class BCT_API block_download
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<block_download> ptr;
+    typedef std::pair<size_t, hash_digest> item;
+    typedef std::vector<item> items;
+
+    /// Notify the supplier of a block that the block has been rejected.
+    typedef std::function<void(const code&)> result_handler;
+
+    /// Deliver the block at the height, invoked in order of height.
+    /// Returning an error rejects the block, which is returned to the queue
+    /// and its supplier notified, and the height is not advanced.
+    typedef std::function<code(size_t height, block_const_ptr block)>
+        block_handler;
+
+    /// Construct an instance, the first block delivered is at the height.
+    block_download(size_t first_height, size_t buffer, block_handler handler);
+
+    /// Queue the block of the hash at the height for download.
+    void enqueue(const hash_digest& hash, size_t height);
+
+    /// Claim up to count queued blocks, lowest heights first.
+    void claim(size_t count, items& out_items);
+
+    /// Return claimed blocks that will not be received to the queue.
+    void release(const items& claimed);
+
+    /// Accept a claimed block, delivering all that are then in order.
+    /// The rejected handler is retained with the block and invoked with the
+    /// error if the block handler later rejects it.
+    /// Returns error::not_found if the block is not claimed.
+    code accept(block_const_ptr block, result_handler rejected);
+
+    /// All queued blocks have been delivered.
+    bool complete() const;
+
+    /// The height of the next block to be delivered.
+    size_t next_height() const;
+
+private:
+    typedef std::pair<block_const_ptr, result_handler> supplied;
+
+    void deliver();
+
+    const size_t buffer_;
+    const block_handler handler_;
+
+    // These are protected by mutex_.
+    size_t next_height_;
+    std::map<size_t, hash_digest> queued_;
+    std::map<hash_digest, size_t> claimed_;
+    std::map<size_t, supplied> received_;
+    mutable shared_mutex mutex_;
+
+    // This serializes delivery, so that it is in order of height.
+    mutable shared_mutex delivery_mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
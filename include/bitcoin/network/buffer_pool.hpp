@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_BUFFER_POOL_HPP
+#define LIBBITCOIN_NETWORK_BUFFER_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/message_subscriber.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A shared store of reusable payload buffers, partitioned by size class.
+/// Each size class is a power of two, buffers are returned to their class
+/// upon release of the last reference, up to the configured byte capacity.
+class BCT_API buffer_pool
+  : public enable_shared_from_base<buffer_pool>, noncopyable
+{
+public:
+    typedef std::shared_ptr<buffer_pool> ptr;
+
+    /// Construct an instance, a zero capacity disables buffer retention.
+    buffer_pool(size_t capacity);
+
+    /// Obtain a buffer resized to the specified number of bytes.
+    virtual payload_ptr get(size_t size);
+
+    /// The number of bytes currently retained for reuse.
+    virtual size_t retained() const;
+
+    /// The number of requests satisfied by a retained buffer.
+    virtual size_t hits() const;
+
+    /// The number of requests satisfied by a new allocation.
+    virtual size_t misses() const;
+
+private:
+    typedef std::unique_ptr<data_chunk> buffer;
+    typedef std::vector<buffer> buffers;
+
+    static size_t size_class(size_t size);
+
+    void put(data_chunk* chunk);
+
+    // These are thread safe.
+    const size_t capacity_;
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> misses_;
+
+    // These are protected by mutex.
+    size_t retained_;
+    std::vector<buffers> classes_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -26,23 +26,37 @@
 #include <utility>
 #include <string>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
+#include <bitcoin/network/channel_metrics.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/socket_transport.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
 
 /// A concrete proxy with timers and state, mostly thread safe.
+/// The expiration and inactivity timers are those of the shared timer wheel.
+/// Activity only records the time, and the inactivity timer reschedules itself
+/// for the remainder when it fires before the channel is idle for its period.
 class BCT_API channel
   : public proxy, track<channel>
 {
 public:
     typedef std::shared_ptr<channel> ptr;
 
-    /// Construct an instance.
-    channel(threadpool& pool, socket::ptr socket, const settings& settings);
+    /// Construct an instance on a connected socket.
+    channel(threadpool& pool, socket::ptr socket, const settings& settings,
+        buffer_pool::ptr buffers, timer_wheel::ptr timers);
+
+    /// Construct an instance on a connected transport.
+    channel(threadpool& pool, transport::ptr transport,
+        const settings& settings, buffer_pool::ptr buffers,
+        timer_wheel::ptr timers);
 
     void start(result_handler handler) override;
 
@@ -54,11 +68,30 @@ public:
     virtual uint64_t nonce() const;
     virtual void set_nonce(uint64_t value);
 
+    channel_statistics statistics() const override;
+
     virtual version_const_ptr peer_version() const;
     virtual void set_peer_version(version_const_ptr value);
 
+    /// Record a ping round trip, updating the smoothed and minimum times.
+    virtual void record_round_trip(const asio::duration& value);
+
+    /// The smoothed ping round trip time, zero if not yet measured.
+    virtual asio::duration round_trip() const;
+
+    /// The minimum ping round trip time, zero if not yet measured.
+    virtual asio::duration minimum_round_trip() const;
+
+    /// The latency by which peers are ranked, lower is better.
+    /// This is the smoothed round trip, or the maximum if not yet measured.
+    virtual asio::duration latency_score() const;
+
+    /// The time since the peer last relayed data, or since channel creation.
+    virtual asio::duration useful_idle() const;
+
 protected:
     virtual void signal_activity() override;
+    virtual void signal_useful() override;
     virtual void handle_stopping() override;
     virtual bool stopped(const code& ec) const;
 
@@ -71,14 +104,23 @@ private:
     void start_expiration();
     void handle_expiration(const code& ec);
 
-    void start_inactivity();
+    void start_inactivity(const asio::duration& delay);
     void handle_inactivity(const code& ec);
+    void set_timer(std::atomic<timer_wheel::key>& timer,
+        timer_wheel::key value);
 
     std::atomic<bool> notify_;
     std::atomic<uint64_t> nonce_;
+    std::atomic<int64_t> round_trip_;
+    std::atomic<int64_t> minimum_round_trip_;
     bc::atomic<version_const_ptr> peer_version_;
-    deadline::ptr expiration_;
-    deadline::ptr inactivity_;
+    std::atomic<int64_t> last_activity_;
+    std::atomic<int64_t> last_useful_;
+    std::atomic<timer_wheel::key> expiration_timer_;
+    std::atomic<timer_wheel::key> inactivity_timer_;
+    const asio::duration expiration_;
+    const asio::duration inactivity_;
+    timer_wheel::ptr timers_;
 };
 
 } // namespace network
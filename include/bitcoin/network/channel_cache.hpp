@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_CHANNEL_CACHE_HPP
+#define LIBBITCOIN_NETWORK_CHANNEL_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A shared store of reusable channel allocations. A channel is created in
+/// a single block with its shared pointer control block, which is returned
+/// to the store upon release of the last reference, up to the configured
+/// number of blocks. Each channel is constructed anew in its block, so no
+/// state survives from its predecessor.
+class BCT_API channel_cache
+  : public enable_shared_from_base<channel_cache>, noncopyable
+{
+public:
+    typedef std::shared_ptr<channel_cache> ptr;
+
+    /// Construct an instance, a zero limit disables block retention.
+    channel_cache(size_t limit);
+
+    /// Free the retained blocks.
+    ~channel_cache();
+
+    /// Create a channel with the arguments of a channel constructor.
+    template <typename... Args>
+    channel::ptr create(Args&&... args)
+    {
+        const allocator<channel> alloc(shared_from_this());
+        return std::allocate_shared<channel>(alloc,
+            std::forward<Args>(args)...);
+    }
+
+    /// The number of blocks currently retained for reuse.
+    virtual size_t retained() const;
+
+    /// The number of creations satisfied by a retained block.
+    virtual size_t hits() const;
+
+    /// The number of creations satisfied by a new allocation.
+    virtual size_t misses() const;
+
+private:
+    // The cache may be destroyed before a channel, so blocks are returned
+    // to it only if it remains, and are otherwise freed.
+    template <typename Type>
+    class allocator
+    {
+    public:
+        typedef Type value_type;
+
+        allocator(const std::weak_ptr<channel_cache>& cache)
+          : cache_(cache)
+        {
+        }
+
+        template <typename Other>
+        allocator(const allocator<Other>& other)
+          : cache_(other.cache_)
+        {
+        }
+
+        Type* allocate(size_t count)
+        {
+            const auto size = count * sizeof(Type);
+            const auto cache = cache_.lock();
+            return static_cast<Type*>(cache ? cache->get(size) :
+                ::operator new(size));
+        }
+
+        void deallocate(Type* block, size_t count)
+        {
+            const auto size = count * sizeof(Type);
+            const auto cache = cache_.lock();
+
+            if (cache)
+                cache->put(block, size);
+            else
+                ::operator delete(block);
+        }
+
+        template <typename Other>
+        bool operator==(const allocator<Other>& other) const
+        {
+            return !cache_.owner_before(other.cache_) &&
+                !other.cache_.owner_before(cache_);
+        }
+
+        template <typename Other>
+        bool operator!=(const allocator<Other>& other) const
+        {
+            return !(*this == other);
+        }
+
+        std::weak_ptr<channel_cache> cache_;
+    };
+
+    void* get(size_t size);
+    void put(void* block, size_t size);
+
+    // These are thread safe.
+    const size_t limit_;
+    std::atomic<size_t> hits_;
+    std::atomic<size_t> misses_;
+
+    // These are protected by mutex.
+    size_t block_size_;
+    std::vector<void*> blocks_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
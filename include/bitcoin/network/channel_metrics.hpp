@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_CHANNEL_METRICS_HPP
+#define LIBBITCOIN_NETWORK_CHANNEL_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The traffic of one message type in one direction, in wire bytes.
+struct BCT_API message_traffic
+{
+    typedef std::vector<message_traffic> list;
+
+    uint64_t messages;
+    uint64_t bytes;
+};
+
+/// The cumulative and maximum durations of socket operations.
+struct BCT_API operation_latency
+{
+    uint64_t count;
+    std::chrono::microseconds total;
+    std::chrono::microseconds maximum;
+};
+
+/// A copy of the metrics of a channel at a point in time.
+struct BCT_API channel_statistics
+{
+    typedef std::vector<channel_statistics> list;
+
+    config::authority authority;
+    uint64_t nonce;
+
+    /// Traffic indexed by message type.
+    message_traffic::list received;
+    message_traffic::list sent;
+
+    /// Payload reads, from heading to payload completion, and batch writes.
+    operation_latency reads;
+    operation_latency writes;
+
+    /// The smoothed and minimum ping round trip times, zero if unmeasured.
+    std::chrono::microseconds round_trip;
+    std::chrono::microseconds minimum_round_trip;
+
+    /// The time since a message was last received.
+    std::chrono::milliseconds idle;
+
+    /// The depth of the send queue.
+    size_t queued_messages;
+    size_t queued_bytes;
+
+    /// The effective options of the transport, as read upon connection.
+    transport_options options;
+};
+
+/// This class is thread safe.
+/// Lock-free traffic and latency counters of a channel, cheap enough to be
+/// updated on each message. Counters are read individually, so a copy taken
+/// during traffic may not reflect a single instant.
+class BCT_API channel_metrics
+  : noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /// Construct an instance with zeroed counters.
+    channel_metrics();
+
+    /// The message type of a command, unknown if not recognized.
+    static message::message_type to_type(const std::string& command);
+
+    /// The command of a message type, "unknown" if not recognized.
+    static std::string to_command(message::message_type type);
+
+    /// Record a received message and the duration of its payload read.
+    void received(message::message_type type, size_t bytes,
+        clock::duration elapsed);
+
+    /// Record a sent message.
+    void sent(message::message_type type, size_t bytes);
+
+    /// Record the duration of a completed write.
+    void written(clock::duration elapsed);
+
+    /// Populate the traffic, latency and idle time of the statistics.
+    void copy(channel_statistics& out) const;
+
+private:
+    struct counter
+    {
+        std::atomic<uint64_t> messages;
+        std::atomic<uint64_t> bytes;
+    };
+
+    // Durations are in microseconds.
+    struct timing
+    {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> total;
+        std::atomic<uint64_t> maximum;
+    };
+
+    static void record(counter& traffic, size_t bytes);
+    static void record(timing& latency, clock::duration elapsed);
+    static message_traffic::list copy(const counter* traffic, size_t size);
+    static operation_latency copy(const timing& latency);
+
+    size_t index(message::message_type type) const;
+
+    const size_t types_;
+    std::unique_ptr<counter[]> received_;
+    std::unique_ptr<counter[]> sent_;
+    timing reads_;
+    timing writes_;
+    std::atomic<clock::rep> last_received_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
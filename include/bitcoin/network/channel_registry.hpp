@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_CHANNEL_REGISTRY_HPP
+#define LIBBITCOIN_NETWORK_CHANNEL_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A collection of channels indexed by authority and by version nonce.
+/// Iteration is by snapshot, an immutable vector shared by all readers until
+/// the next change to the collection, so that broadcast does not copy.
+class BCT_API channel_registry
+  : noncopyable
+{
+public:
+    typedef std::vector<channel::ptr> channels;
+    typedef std::shared_ptr<const channels> snapshot_ptr;
+
+    /// Construct an instance.
+    channel_registry(size_t initial_capacity);
+
+    /// The number of registered channels.
+    size_t size() const;
+
+    /// Determine if a channel is registered for the authority.
+    bool exists(const config::authority& authority) const;
+
+    /// Determine if a channel is registered with the version nonce.
+    bool exists(uint64_t version_nonce) const;
+
+    /// The registered channels, shared until the next change.
+    snapshot_ptr snapshot() const;
+
+    /// Register the channel, returns error::service_stopped if stopped.
+    code store(channel::ptr channel);
+
+    /// Register the channel unless another is registered for its authority,
+    /// returns error::address_in_use or error::service_stopped if stopped.
+    code store_unique(channel::ptr channel);
+
+    /// Unregister the channel, if registered.
+    void remove(channel::ptr channel);
+
+    /// Prevent registration and stop all registered channels.
+    void stop(const code& ec);
+
+private:
+    typedef byte_array<sizeof(message::ip_address) + sizeof(uint16_t)> key;
+
+    struct key_hash
+    {
+        size_t operator()(const key& value) const;
+    };
+
+    struct keys
+    {
+        key authority;
+        uint64_t nonce;
+    };
+
+    typedef std::unordered_map<channel::ptr, keys> channel_map;
+    typedef std::unordered_multimap<key, channel::ptr, key_hash> authority_map;
+    typedef std::unordered_multimap<uint64_t, channel::ptr> nonce_map;
+
+    static key make_key(const config::authority& authority);
+    code do_store(channel::ptr channel, bool unique);
+
+    // This is protected by mutex.
+    bool stopped_;
+    channel_map channels_;
+    authority_map authorities_;
+    nonce_map nonces_;
+    mutable snapshot_ptr snapshot_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
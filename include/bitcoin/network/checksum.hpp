@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_CHECKSUM_HPP
+#define LIBBITCOIN_NETWORK_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The message checksum of a payload received in parts, not thread safe.
+/// Each part is hashed as it is added, so that the checksum of the whole
+/// is available immediately upon the last.
+class BCT_API payload_hasher
+{
+public:
+    /// Construct an instance.
+    payload_hasher();
+
+    /// Discard any parts added since the last checksum.
+    void reset();
+
+    /// Hash the next part of the payload.
+    void update(const uint8_t* data, size_t size);
+
+    /// The checksum of the parts added since the last, then reset.
+    uint32_t checksum();
+
+private:
+    uint32_t state_[8];
+    uint8_t pending_[64];
+    size_t pending_size_;
+    uint64_t size_;
+};
+
+/// The message checksum of the payload, equal to bitcoin_checksum.
+/// Computed with the processor's sha extensions where they are available.
+BCT_API uint32_t payload_checksum(const data_chunk& payload);
+
+/// The processor's sha extensions are used by payload_checksum.
+BCT_API bool checksum_accelerated();
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
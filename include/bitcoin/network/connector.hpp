@@ -20,18 +20,27 @@
 #define LIBBITCOIN_NETWORK_CONNECTOR_HPP
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/channel_cache.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
 
 namespace libbitcoin {
 namespace network {
 
 /// Create outbound socket connections.
+/// Resolved endpoints are raced with staggered starts (RFC 8305), alternating
+/// address families, and the first established socket wins.
 /// This class is thread safe against stop.
 /// This class is not safe for concurrent connection attempts.
 class BCT_API connector
@@ -42,7 +51,9 @@ public:
     typedef std::function<void(const code& ec, channel::ptr)> connect_handler;
 
     /// Construct an instance.
-    connector(threadpool& pool, const settings& settings);
+    connector(threadpool& pool, const settings& settings,
+        buffer_pool::ptr buffers, channel_cache::ptr allocations,
+        dns_cache::ptr names, timer_wheel::ptr timers);
 
     /// Validate connector stopped.
     ~connector();
@@ -51,39 +62,59 @@ public:
     virtual void connect(const config::endpoint& endpoint,
         connect_handler handler);
 
-    /// Try to connect to the authority.
+    /// Try to connect to the authority, without name resolution.
     virtual void connect(const config::authority& authority,
         connect_handler handler);
 
-    /// Try to connect to host:port.
+    /// Try to connect to the address, without name resolution.
+    virtual void connect(const message::network_address& address,
+        connect_handler handler);
+
+    /// Try to connect to host:port, resolving the host unless numeric.
     virtual void connect(const std::string& hostname, uint16_t port,
         connect_handler handler);
 
+    /// The time since the connection attempt started, after resolution.
+    virtual asio::duration elapsed() const;
+
     /// Cancel outstanding connection attempt.
     void stop(const code& ec);
 
 private:
-    typedef std::shared_ptr<asio::query> query_ptr;
+    typedef dns_cache::endpoints endpoints;
+    typedef std::vector<socket::ptr> sockets;
 
     bool stopped() const;
+    void release();
+    void connect(const endpoints& endpoints, connect_handler handler);
+    void start(const endpoints& endpoints, connect_handler handler);
+    void start_attempt(connect_handler handler);
 
-    void handle_resolve(const boost_code& ec, asio::iterator iterator,
+    void handle_resolve(const code& ec, const endpoints& resolved,
         connect_handler handler);
-    void handle_connect(const boost_code& ec, asio::iterator iterator,
-        socket::ptr socket, connect_handler handler);
-    void handle_timer(const code& ec, socket::ptr socket,
+    void handle_attempt(const code& ec, connect_handler handler);
+    void handle_connect(const boost_code& ec, socket::ptr socket,
         connect_handler handler);
+    void handle_timer(const code& ec, connect_handler handler);
 
     // These are thread safe
     std::atomic<bool> stopped_;
     threadpool& pool_;
     const settings& settings_;
+    buffer_pool::ptr buffers_;
+    channel_cache::ptr allocations_;
+    dns_cache::ptr names_;
+    timer_wheel::ptr timers_;
     mutable dispatcher dispatch_;
 
     // These are protected by mutex.
-    query_ptr query_;
+    connect_handler resolving_;
+    endpoints endpoints_;
+    size_t next_;
+    std::chrono::steady_clock::time_point started_;
+    sockets sockets_;
     deadline::ptr timer_;
-    asio::resolver resolver_;
+    deadline::ptr attempt_timer_;
     mutable upgrade_mutex mutex_;
 };
 
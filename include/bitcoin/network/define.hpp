@@ -40,6 +40,11 @@
 // Log name.
 #define LOG_NETWORK "network"
 
+// Format a verbose record only if verbose logging is enabled. Formatting a
+// record is otherwise paid in full on hot paths although the sink drops it.
+#define LOG_VERBOSE_IF(enabled, name) \
+    if (!(enabled)) {} else LOG_VERBOSE(name)
+
 // Avoid namespace conflict between boost::placeholders and std::placeholders.
 #define BOOST_BIND_NO_PLACEHOLDERS
 
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_DNS_CACHE_HPP
+#define LIBBITCOIN_NETWORK_DNS_CACHE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/settings.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A shared cache of host name resolutions, keyed by host and port.
+/// Successful resolutions are retained for dns_cache_minutes and failures for
+/// dns_negative_cache_seconds. An expired resolution continues to be served
+/// while it is refreshed in the background, and is retained if the refresh
+/// fails, so that reconnection does not wait on (or fail with) name service.
+class BCT_API dns_cache
+  : public enable_shared_from_base<dns_cache>, noncopyable
+{
+public:
+    typedef std::shared_ptr<dns_cache> ptr;
+    typedef std::vector<asio::endpoint> endpoints;
+    typedef std::function<void(const code&, const endpoints&)>
+        resolve_handler;
+
+    /// Construct an instance.
+    dns_cache(threadpool& pool, const settings& settings);
+
+    /// Obtain the endpoints of host:port, resolving only if not cached.
+    virtual void resolve(const std::string& hostname, uint16_t port,
+        resolve_handler handler);
+
+    /// Cancel pending resolutions and clear the cache.
+    virtual void stop();
+
+private:
+    typedef std::chrono::steady_clock clock;
+    typedef std::shared_ptr<asio::resolver> resolver_ptr;
+    typedef std::vector<resolve_handler> handlers;
+
+    struct entry
+    {
+        code ec;
+        endpoints resolved;
+        clock::time_point expiration;
+        resolver_ptr resolver;
+        handlers waiting;
+    };
+
+    typedef std::unordered_map<std::string, entry> entries;
+
+    bool fresh(const entry& entry) const;
+    void refresh(const std::string& hostname, uint16_t port, entry& entry);
+
+    void handle_resolve(const boost_code& ec, asio::iterator iterator,
+        const std::string& key, resolver_ptr resolver);
+
+    // These are thread safe.
+    threadpool& pool_;
+    const asio::duration positive_;
+    const asio::duration negative_;
+    mutable dispatcher dispatch_;
+
+    // These are protected by mutex.
+    entries entries_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_HEADER_SYNC_HPP
+#define LIBBITCOIN_NETWORK_HEADER_SYNC_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The shared state of header download across channels, thread safe.
+/// The span from the start to the last checkpoint is divided into ranges
+/// between checkpoints, each downloaded by one channel at a time, so that
+/// ranges proceed in parallel. A final open range follows the last
+/// checkpoint and completes upon a response of less than the maximum count.
+/// Each response is linked and checkpoint verified as it arrives and then
+/// passed to the store handler, so headers are not retained here.
+class BCT_API header_sync
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<header_sync> ptr;
+
+    /// Store headers, the first of which is at the height, in range order.
+    /// Returning an error stops the channel and retries the range.
+    typedef std::function<code(size_t height,
+        const message::header::list& headers)> store_handler;
+
+    /// Construct an instance, starting after the start header.
+    /// Checkpoints at or below the start height are ignored.
+    header_sync(const config::checkpoint& start,
+        const config::checkpoint::list& checkpoints, store_handler store);
+
+    /// Assign an incomplete range that is not assigned to another channel.
+    /// Returns false if there is none.
+    bool assign(size_t& out_range);
+
+    /// Return the range, so that it may be assigned to another channel.
+    void release(size_t range);
+
+    /// The request that continues the range from its last stored header.
+    message::get_headers request(size_t range) const;
+
+    /// The hash at which the range stops, null for the open range.
+    hash_digest stop_hash(size_t range) const;
+
+    /// Link, verify and store a response to the request of the range.
+    /// Complete is set if the range is complete upon return.
+    code accept(size_t range, const message::headers& response,
+        bool& complete);
+
+    /// All ranges are complete.
+    bool complete() const;
+
+    /// The highest header linked to the start, by ranges stored in full.
+    config::checkpoint top() const;
+
+private:
+    struct range
+    {
+        config::checkpoint last;
+        config::checkpoint stop;
+        bool open;
+        bool assigned;
+        bool complete;
+    };
+
+    const store_handler store_;
+
+    // These are protected by mutex_.
+    std::vector<range> ranges_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -21,8 +21,10 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/define.hpp>
@@ -34,8 +36,18 @@ namespace network {
 /// This class is thread safe.
 /// The hosts class manages a thread-safe dynamic store of network addresses.
 /// The store can be loaded and saved from/to the specified file path.
-/// The file is a line-oriented set of config::authority serializations.
+/// The file is a versioned, checksummed set of fixed size network_address
+/// records, preserving services and timestamps. The original line-oriented
+/// config::authority format is accepted on load.
 /// Duplicate addresses and those with zero-valued ports are disacarded.
+/// Addresses are indexed by ip and port, so find, store and remove are O(1).
+/// The store is sharded by address hash, each shard with its own lock, so
+/// that fetch does not block on stores to other shards. Each shard buckets
+/// its addresses into new and tried tables, where connection outcomes
+/// promote and demote addresses, and fetch prefers tried addresses.
+/// Each address carries the time that it was last known to be active, which
+/// is set upon connection and aged upon failure. Fetch favors and eviction
+/// disfavors recently active addresses.
 class BCT_API hosts
   : noncopyable
 {
@@ -50,9 +62,12 @@ public:
     /// Load hosts file if found.
     virtual code start();
 
-    // Save hosts to file.
+    /// Save hosts to file.
     virtual code stop();
 
+    /// Checkpoint hosts to file, without stopping.
+    virtual code save();
+
     virtual size_t count() const;
     virtual code fetch(address& out) const;
     virtual code fetch(address::list& out) const;
@@ -60,21 +75,105 @@ public:
     virtual code store(const address& host);
     virtual void store(const address::list& hosts, result_handler handler);
 
+    /// Record a successful connection, promoting the address to tried.
+    virtual code good(const address& host);
+
+    /// Record a failed connection, aging the address, and removing a new
+    /// address or demoting a tried address after repeated failures.
+    virtual code failed(const address& host);
+
 private:
-    typedef boost::circular_buffer<address> list;
-    typedef list::iterator iterator;
+    typedef byte_array<sizeof(message::ip_address) + sizeof(uint16_t)> key;
+
+    struct key_hash
+    {
+        size_t operator()(const key& value) const;
+    };
+
+    /// This class is not thread safe.
+    /// A bounded store of addresses indexed by ip and port. The stalest of a
+    /// sample, or the oldest entry if none is staler, is evicted upon insert
+    /// when full.
+    class table
+    {
+    public:
+        table(size_t capacity);
+
+        size_t size() const;
+        bool full() const;
+        bool exists(const address& host) const;
+        address* find(const address& host);
+        const address* find(const address& host) const;
+        const address& stalest() const;
+        const address& freshest() const;
+        const address& operator[](size_t index) const;
+        bool insert(const address& host);
+        bool erase(const address& host);
+        void clear();
+
+    private:
+        typedef boost::circular_buffer<address> list;
+
+        // Maps each address to its sequence, where front is at base_.
+        typedef std::unordered_map<key, size_t, key_hash> index;
+
+        list buffer_;
+        index index_;
+        size_t base_;
+    };
 
-    iterator find(const address& host);
+    typedef std::unordered_map<key, size_t, key_hash> failure_map;
+
+    /// A partition of the store, selected by address hash.
+    /// Addresses are new until connected, and then tried until demoted.
+    struct shard
+    {
+        shard(size_t capacity);
+
+        size_t size() const;
+        bool exists(const address& host) const;
+        bool outdated(const address& host) const;
+        void refresh(const address& host);
+        const address& operator[](size_t index) const;
+        void promote(const address& host);
+        void demote(const address& host);
+        void clear();
+
+        // These are protected by mutex.
+        table fresh;
+        table tried;
+        failure_map failures;
+        mutable upgrade_mutex mutex;
+    };
+
+    typedef std::unique_ptr<shard> shard_ptr;
+    typedef std::vector<shard_ptr> shards;
+
+    static key make_key(const address& host);
+    static address sanitize(const address& host);
+    static shards make_shards(size_t capacity, size_t count);
+
+    shard& partition(const address& host) const;
+    size_t select_shard() const;
+    void load(const address& host, bool tried);
+    data_chunk snapshot(bool clear);
+
+    bool write(const data_chunk& data) const;
+    bool from_data(const data_chunk& data);
+    void from_text(const data_chunk& data);
 
     const size_t capacity_;
 
-    // These are protected by a mutex.
-    list buffer_;
+    // These are thread safe.
+    const shards shards_;
     std::atomic<bool> stopped_;
-    mutable upgrade_mutex mutex_;
+
+    // This serializes start, stop and save.
+    upgrade_mutex mutex_;
 
     // HACK: we use this because the buffer capacity cannot be set to zero.
     const bool disabled_;
+    const bool verbose_;
     const boost::filesystem::path file_path_;
 };
 
@@ -82,4 +181,3 @@ private:
 } // namespace libbitcoin
 
 #endif
-
@@ -19,69 +19,78 @@
 #ifndef LIBBITCOIN_NETWORK_MESSAGE_SUBSCRIBER_HPP
 #define LIBBITCOIN_NETWORK_MESSAGE_SUBSCRIBER_HPP
 
+#include <atomic>
 #include <istream>
 #include <functional>
 #include <map>
 #include <memory>
 #include <utility>
 #include <string>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/define.hpp>
 
 namespace libbitcoin {
 namespace network {
 
-#define DEFINE_SUBSCRIBER_TYPE(value) \
-    typedef resubscriber<code, message::value::const_ptr> \
-        value##_subscriber_type
-
-#define DEFINE_SUBSCRIBER_OVERLOAD(value) \
+#define DEFINE_SUBSCRIBER_OVERLOAD(value, policy) \
     template <typename Handler> \
-    void subscribe(message::value&&, Handler&& handler) \
+    void subscribe(message::value&&, Handler&& handler, \
+        delivery mode = delivery::policy) \
     { \
-        value##_subscriber_->subscribe(std::forward<Handler>(handler), \
-            error::channel_stopped, {}); \
+        subscriber<message::value>(message::message_type::value, mode)-> \
+            subscribe(std::forward<Handler>(handler), error::channel_stopped, \
+                {}); \
     }
 
-#define DECLARE_SUBSCRIBER(value) \
-    value##_subscriber_type::ptr value##_subscriber_
+/// The thread context in which a message handler is invoked.
+enum class delivery
+{
+    /// Invoke on the reading thread, blocking the reader until handled.
+    invoke,
+
+    /// Relay to the threadpool, allowing the reader to continue.
+    relay
+};
 
 template <class Message>
 using message_handler =
     std::function<bool(const code&, std::shared_ptr<const Message>)>;
 
-/// Aggregation of subscribers by messasge type, thread safe.
+typedef std::shared_ptr<data_chunk> payload_ptr;
+typedef std::function<bool(const code&, message::message_type, payload_ptr)>
+    payload_handler;
+
+typedef std::shared_ptr<const chain::header> streamed_header_ptr;
+typedef std::shared_ptr<const chain::transaction> streamed_transaction_ptr;
+
+/// The header of a block and one of its transactions, by position.
+typedef std::function<bool(const code&, streamed_header_ptr, size_t,
+    streamed_transaction_ptr)> block_stream_handler;
+
+/// One of the headers of a headers message, by position.
+typedef std::function<bool(const code&, size_t, streamed_header_ptr)>
+    headers_stream_handler;
+
+/// Aggregation of subscribers by message type, thread safe.
+/// Subscribers are created upon first subscription to their type and held in
+/// a table indexed by message type.
 class BCT_API message_subscriber
   : noncopyable
 {
 public:
-    DEFINE_SUBSCRIBER_TYPE(address);
-    DEFINE_SUBSCRIBER_TYPE(alert);
-    DEFINE_SUBSCRIBER_TYPE(block);
-    DEFINE_SUBSCRIBER_TYPE(block_transactions);
-    DEFINE_SUBSCRIBER_TYPE(compact_block);
-    DEFINE_SUBSCRIBER_TYPE(fee_filter);
-    DEFINE_SUBSCRIBER_TYPE(filter_add);
-    DEFINE_SUBSCRIBER_TYPE(filter_clear);
-    DEFINE_SUBSCRIBER_TYPE(filter_load);
-    DEFINE_SUBSCRIBER_TYPE(get_address);
-    DEFINE_SUBSCRIBER_TYPE(get_blocks);
-    DEFINE_SUBSCRIBER_TYPE(get_block_transactions);
-    DEFINE_SUBSCRIBER_TYPE(get_data);
-    DEFINE_SUBSCRIBER_TYPE(get_headers);
-    DEFINE_SUBSCRIBER_TYPE(headers);
-    DEFINE_SUBSCRIBER_TYPE(inventory);
-    DEFINE_SUBSCRIBER_TYPE(memory_pool);
-    DEFINE_SUBSCRIBER_TYPE(merkle_block);
-    DEFINE_SUBSCRIBER_TYPE(not_found);
-    DEFINE_SUBSCRIBER_TYPE(ping);
-    DEFINE_SUBSCRIBER_TYPE(pong);
-    DEFINE_SUBSCRIBER_TYPE(reject);
-    DEFINE_SUBSCRIBER_TYPE(send_compact);
-    DEFINE_SUBSCRIBER_TYPE(send_headers);
-    DEFINE_SUBSCRIBER_TYPE(transaction);
-    DEFINE_SUBSCRIBER_TYPE(verack);
-    DEFINE_SUBSCRIBER_TYPE(version);
+    template <class Message>
+    using subscriber_type =
+        resubscriber<code, std::shared_ptr<const Message>>;
+
+    typedef resubscriber<code, message::message_type, payload_ptr>
+        payload_subscriber_type;
+
+    typedef resubscriber<code, streamed_header_ptr, size_t,
+        streamed_transaction_ptr> block_stream_subscriber_type;
+
+    typedef resubscriber<code, size_t, streamed_header_ptr>
+        headers_stream_subscriber_type;
 
     /**
      * Create an instance of this class.
@@ -102,47 +111,90 @@ public:
     }
 
     /**
-     * Load a stream into a message instance and notify subscribers.
-     * @param[in]  stream      The stream from which to load the message.
-     * @param[in]  version     The peer protocol version.
-     * @param[in]  subscriber  The subscriber for the message type.
-     * @return                 Returns error::bad_stream if failed.
+     * Subscribe to receive a notification when a message of type is received,
+     * overriding the default delivery of the message type.
+     * Invoked handlers must not block, as the peer is not read until return.
+     * @param[in]  handler  The handler to register.
+     * @param[in]  mode     The thread context of handler invocation.
      */
-    template <class Message, class Subscriber>
-    code relay(std::istream& stream, uint32_t version,
-        Subscriber& subscriber) const
+    template <class Message, typename Handler>
+    void subscribe(Handler&& handler, delivery mode)
     {
-        const auto message = std::make_shared<Message>();
+        subscribe(Message(), std::forward<Handler>(handler), mode);
+    }
 
-        // Subscribers are invoked only with stop and success codes.
-        if (!message->from_data(version, stream))
-            return error::bad_stream;
+    /**
+     * Subscribe to receive the raw payload buffer of each decoded message.
+     * The buffer is not reused by the reader once relayed, so subscribers
+     * share ownership of it and may retain it without copying.
+     * @param[in]  handler  The handler to register.
+     */
+    virtual void subscribe_payload(payload_handler&& handler);
 
-        ////const auto const_ptr = std::const_pointer_cast<const Message>(message);
-        subscriber->relay(error::success, message);
-        return error::success;
-    }
+    /**
+     * Determine if there has been a subscription to raw payloads.
+     */
+    virtual bool payload_subscribed() const;
 
     /**
-     * Load a stream into a message instance and invoke subscribers.
-     * @param[in]  stream      The stream from which to load the message.
-     * @param[in]  version     The peer protocol version.
-     * @param[in]  subscriber  The subscriber for the message type.
-     * @return                 Returns error::bad_stream if failed.
+     * Notify raw payload subscribers, transferring the buffer to them.
+     * @param[in]  type     The payload message type identifier.
+     * @param[in]  payload  The payload buffer, not to be reused by caller.
      */
-    template <class Message, class Subscriber>
-    code handle(std::istream& stream, uint32_t version,
-        Subscriber& subscriber) const
-    {
-        const auto message = std::make_shared<Message>();
+    virtual void relay(message::message_type type, payload_ptr payload);
+
+    /**
+     * Subscribe to the transactions of each block as its payload arrives.
+     * Handlers are invoked on the reading thread, in order of position,
+     * before the payload is complete, its checksum validated, or the block
+     * notified. A part is not notified if the payload fails to parse.
+     * @param[in]  handler  The handler to register.
+     */
+    virtual void subscribe_block_stream(block_stream_handler&& handler);
 
-        // Subscribers are invoked only with stop and success codes.
-        if (!message->from_data(version, stream))
-            return error::bad_stream;
+    /**
+     * Subscribe to the headers of each headers message as it arrives.
+     * Handlers are invoked as are those of subscribe_block_stream.
+     * @param[in]  handler  The handler to register.
+     */
+    virtual void subscribe_headers_stream(headers_stream_handler&& handler);
 
-        ////const auto const_ptr = std::const_pointer_cast<const Message>(message);
-        subscriber->invoke(error::success, message);
-        return error::success;
+    /**
+     * Determine if there has been a stream subscription to the type.
+     */
+    virtual bool stream_subscribed(message::message_type type) const;
+
+    /**
+     * Invoke block stream subscribers with a transaction of the block.
+     */
+    virtual void notify_block_part(streamed_header_ptr header, size_t index,
+        streamed_transaction_ptr transaction) const;
+
+    /**
+     * Invoke headers stream subscribers with a header of the message.
+     */
+    virtual void notify_headers_part(size_t index,
+        streamed_header_ptr header) const;
+
+    /**
+     * Determine if there has been a subscription to the message type.
+     */
+    virtual bool subscribed(message::message_type type) const;
+
+    /**
+     * Notify subscribers of a message that has been decoded by the caller.
+     * @param[in]  type     The message type identifier of Message.
+     * @param[in]  message  The decoded message.
+     */
+    template <class Message>
+    void notify(message::message_type type,
+        std::shared_ptr<const Message> message) const
+    {
+        const auto found = find(type);
+
+        if (found)
+            std::static_pointer_cast<typed_entry<Message>>(found)->notify(
+                message);
     }
 
     /**
@@ -159,10 +211,24 @@ public:
      * @param[in]  version  The peer protocol version.
      * @param[in]  stream   The stream from which to load the message.
      * @return              Returns error::bad_stream if failed.
+     * A message of a type without subscription is not read, see subscribed.
      */
     virtual code load(message::message_type type, uint32_t version,
         std::istream& stream) const;
 
+    /*
+     * Load a reader of the specified command type.
+     * This avoids stream overhead when reading from a contiguous buffer.
+     * Creates an instance of the indicated message type.
+     * Sends the message instance to each subscriber of the type.
+     * @param[in]  type     The message type identifier.
+     * @param[in]  version  The peer protocol version.
+     * @param[in]  source   The reader from which to load the message.
+     * @return              Returns error::bad_stream if failed.
+     */
+    virtual code load(message::message_type type, uint32_t version,
+        reader& source) const;
+
     /**
      * Start all subscribers so that they accept subscription.
      */
@@ -174,66 +240,235 @@ public:
     virtual void stop();
 
 private:
-    DEFINE_SUBSCRIBER_OVERLOAD(address)
-    DEFINE_SUBSCRIBER_OVERLOAD(alert)
-    DEFINE_SUBSCRIBER_OVERLOAD(block)
-    DEFINE_SUBSCRIBER_OVERLOAD(block_transactions)
-    DEFINE_SUBSCRIBER_OVERLOAD(compact_block)
-    DEFINE_SUBSCRIBER_OVERLOAD(fee_filter)
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_add)
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_clear)
-    DEFINE_SUBSCRIBER_OVERLOAD(filter_load)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_address)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_blocks)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_block_transactions)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_data)
-    DEFINE_SUBSCRIBER_OVERLOAD(get_headers)
-    DEFINE_SUBSCRIBER_OVERLOAD(headers)
-    DEFINE_SUBSCRIBER_OVERLOAD(inventory)
-    DEFINE_SUBSCRIBER_OVERLOAD(memory_pool)
-    DEFINE_SUBSCRIBER_OVERLOAD(merkle_block)
-    DEFINE_SUBSCRIBER_OVERLOAD(not_found)
-    DEFINE_SUBSCRIBER_OVERLOAD(ping)
-    DEFINE_SUBSCRIBER_OVERLOAD(pong)
-    DEFINE_SUBSCRIBER_OVERLOAD(reject)
-    DEFINE_SUBSCRIBER_OVERLOAD(send_compact)
-    DEFINE_SUBSCRIBER_OVERLOAD(send_headers)
-    DEFINE_SUBSCRIBER_OVERLOAD(transaction)
-    DEFINE_SUBSCRIBER_OVERLOAD(verack)
-    DEFINE_SUBSCRIBER_OVERLOAD(version)
-
-    DECLARE_SUBSCRIBER(address);
-    DECLARE_SUBSCRIBER(alert);
-    DECLARE_SUBSCRIBER(block);
-    DECLARE_SUBSCRIBER(block_transactions);
-    DECLARE_SUBSCRIBER(compact_block);
-    DECLARE_SUBSCRIBER(fee_filter);
-    DECLARE_SUBSCRIBER(filter_add);
-    DECLARE_SUBSCRIBER(filter_clear);
-    DECLARE_SUBSCRIBER(filter_load);
-    DECLARE_SUBSCRIBER(get_address);
-    DECLARE_SUBSCRIBER(get_blocks);
-    DECLARE_SUBSCRIBER(get_block_transactions);
-    DECLARE_SUBSCRIBER(get_data);
-    DECLARE_SUBSCRIBER(get_headers);
-    DECLARE_SUBSCRIBER(headers);
-    DECLARE_SUBSCRIBER(inventory);
-    DECLARE_SUBSCRIBER(memory_pool);
-    DECLARE_SUBSCRIBER(merkle_block);
-    DECLARE_SUBSCRIBER(not_found);
-    DECLARE_SUBSCRIBER(ping);
-    DECLARE_SUBSCRIBER(pong);
-    DECLARE_SUBSCRIBER(reject);
-    DECLARE_SUBSCRIBER(send_compact);
-    DECLARE_SUBSCRIBER(send_headers);
-    DECLARE_SUBSCRIBER(transaction);
-    DECLARE_SUBSCRIBER(verack);
-    DECLARE_SUBSCRIBER(version);
+    /// A type-erased subscriber to a message type.
+    class entry
+    {
+    public:
+        typedef std::shared_ptr<entry> ptr;
+
+        virtual ~entry()
+        {
+        }
+
+        virtual code load(uint32_t version, reader& source) = 0;
+        virtual void broadcast(const code& ec) = 0;
+        virtual void start() = 0;
+        virtual void stop() = 0;
+    };
+
+    /// The subscribers to a message type, by delivery.
+    template <class Message>
+    class typed_entry
+      : public entry
+    {
+    public:
+        typedef std::shared_ptr<typed_entry> ptr;
+
+        typed_entry(threadpool& pool)
+          : invoking_(false),
+            relaying_(false),
+            invoked_(std::make_shared<subscriber_type<Message>>(pool,
+                Message::command + "_sub")),
+            relayed_(std::make_shared<subscriber_type<Message>>(pool,
+                Message::command + "_sub"))
+        {
+        }
+
+        typename subscriber_type<Message>::ptr subscriber(delivery mode)
+        {
+            if (mode == delivery::invoke)
+            {
+                invoking_ = true;
+                return invoked_;
+            }
+
+            relaying_ = true;
+            return relayed_;
+        }
+
+        code load(uint32_t version, reader& source) override
+        {
+            const auto message = std::make_shared<Message>();
+
+            // Subscribers are invoked only with stop and success codes.
+            if (!message->from_data(version, source))
+                return error::bad_stream;
+
+            notify(message);
+            return error::success;
+        }
+
+        void notify(std::shared_ptr<const Message> message)
+        {
+            // The relay is skipped if unused, as it always costs a thread hop.
+            if (relaying_)
+                relayed_->relay(error::success, message);
+
+            // Invocation blocks the peer while handling the message.
+            if (invoking_)
+                invoked_->invoke(error::success, message);
+        }
+
+        void broadcast(const code& ec) override
+        {
+            invoked_->relay(ec, {});
+            relayed_->relay(ec, {});
+        }
+
+        void start() override
+        {
+            invoked_->start();
+            relayed_->start();
+        }
+
+        void stop() override
+        {
+            invoked_->stop();
+            relayed_->stop();
+        }
+
+    private:
+        std::atomic<bool> invoking_;
+        std::atomic<bool> relaying_;
+        const typename subscriber_type<Message>::ptr invoked_;
+        const typename subscriber_type<Message>::ptr relayed_;
+    };
+
+    typedef std::vector<entry::ptr> table;
+
+    template <class Message>
+    typename subscriber_type<Message>::ptr subscriber(
+        message::message_type type, delivery mode)
+    {
+        typedef typed_entry<Message> typed;
+        const auto index = static_cast<size_t>(type);
+        BITCOIN_ASSERT(index < table_.size());
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        mutex_.lock_upgrade();
+
+        const auto found = table_[index];
+
+        if (found)
+        {
+            mutex_.unlock_upgrade();
+            //-----------------------------------------------------------------
+            return std::static_pointer_cast<typed>(found)->subscriber(mode);
+        }
+
+        mutex_.unlock_upgrade_and_lock();
+        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        // A subscriber created after stop remains stopped.
+        const auto created = std::make_shared<typed>(pool_);
+
+        if (!stopped_)
+            created->start();
+
+        table_[index] = created;
+        mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        return created->subscriber(mode);
+    }
+
+    // A stream subscriber is created upon its first subscription.
+    template <class Subscriber>
+    std::shared_ptr<Subscriber> stream_subscriber(
+        std::shared_ptr<Subscriber>& subscriber, const std::string& name)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        mutex_.lock_upgrade();
+
+        const auto found = subscriber;
+
+        if (found)
+        {
+            mutex_.unlock_upgrade();
+            //-----------------------------------------------------------------
+            return found;
+        }
+
+        mutex_.unlock_upgrade_and_lock();
+        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        // A subscriber created after stop remains stopped.
+        const auto created = std::make_shared<Subscriber>(pool_, name);
+
+        if (!stopped_)
+            created->start();
+
+        subscriber = created;
+        mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+
+        return created;
+    }
+
+    template <class Subscriber>
+    std::shared_ptr<Subscriber> find_stream(
+        const std::shared_ptr<Subscriber>& subscriber) const
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(mutex_);
+
+        return subscriber;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    entry::ptr find(message::message_type type) const;
+    code do_load(message::message_type type, uint32_t version,
+        reader& source) const;
+
+    // The default delivery of each message type.
+    DEFINE_SUBSCRIBER_OVERLOAD(address, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(alert, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(block, invoke)
+    DEFINE_SUBSCRIBER_OVERLOAD(block_transactions, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(compact_block, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(fee_filter, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(filter_add, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(filter_clear, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(filter_load, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(get_address, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(get_blocks, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(get_block_transactions, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(get_data, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(get_headers, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(headers, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(inventory, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(memory_pool, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(merkle_block, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(not_found, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(ping, invoke)
+    DEFINE_SUBSCRIBER_OVERLOAD(pong, invoke)
+    DEFINE_SUBSCRIBER_OVERLOAD(reject, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(send_compact, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(send_headers, relay)
+    DEFINE_SUBSCRIBER_OVERLOAD(transaction, invoke)
+    DEFINE_SUBSCRIBER_OVERLOAD(verack, invoke)
+    DEFINE_SUBSCRIBER_OVERLOAD(version, invoke)
+
+    // This is thread safe.
+    threadpool& pool_;
+
+    // These are protected by mutex.
+    bool stopped_;
+    table table_;
+    block_stream_subscriber_type::ptr block_stream_subscriber_;
+    headers_stream_subscriber_type::ptr headers_stream_subscriber_;
+    mutable upgrade_mutex mutex_;
+
+    std::atomic<bool> payload_subscribed_;
+    payload_subscriber_type::ptr payload_subscriber_;
+    std::atomic<bool> block_stream_subscribed_;
+    std::atomic<bool> headers_stream_subscribed_;
 };
 
-#undef DEFINE_SUBSCRIBER_TYPE
 #undef DEFINE_SUBSCRIBER_OVERLOAD
-#undef DECLARE_SUBSCRIBER
 
 } // namespace network
 } // namespace libbitcoin
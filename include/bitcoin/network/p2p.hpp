@@ -19,16 +19,25 @@
 #ifndef LIBBITCOIN_NETWORK_P2P_HPP
 #define LIBBITCOIN_NETWORK_P2P_HPP
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/blacklist.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/channel_cache.hpp>
+#include <bitcoin/network/channel_metrics.hpp>
+#include <bitcoin/network/channel_registry.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
 #include <bitcoin/network/hosts.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
 #include <bitcoin/network/sessions/session_inbound.hpp>
@@ -36,6 +45,10 @@
 #include <bitcoin/network/sessions/session_outbound.hpp>
 #include <bitcoin/network/sessions/session_seed.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/statistics_exporter.hpp>
+#include <bitcoin/network/subnet.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -54,28 +67,55 @@ public:
     typedef std::function<void(const code&, const address&)> address_handler;
     typedef std::function<void(const code&, channel::ptr)> channel_handler;
     typedef std::function<bool(const code&, channel::ptr)> connect_handler;
+    typedef std::function<bool(channel::ptr)> channel_predicate;
+    typedef std::function<bool(channel::ptr left, channel::ptr right)>
+        channel_ranking;
+    typedef std::function<bool(const code&,
+        const message::inventory_vector&)> inventory_handler;
     typedef subscriber<code> stop_subscriber;
     typedef resubscriber<code, channel::ptr> channel_subscriber;
 
     // Templates (send/receive).
     // ------------------------------------------------------------------------
 
-    /// Send message to all connections.
+    /// Send message to all connections, lowest latency peers first.
+    /// The channel handler is invoked for each channel sent to or throttled.
+    /// Channels skipped by relay filter or known inventory are not notified,
+    /// though each is counted toward completion.
     template <typename Message>
     void broadcast(const Message& message, channel_handler handle_channel,
         result_handler handle_complete)
     {
-        // Safely copy the channel collection.
-        const auto channels = pending_close_.collection();
+        send(message, ranked_channels(), handle_channel, handle_complete);
+    }
 
-        // Invoke the completion handler after send complete on all channels.
-        const auto join_handler = synchronize(handle_complete, channels.size(),
-            "p2p_join", synchronizer_terminate::on_count);
+    /// Send message to the connections that satisfy the predicate, lowest
+    /// latency peers first, such as witness peers or outbound peers only.
+    template <typename Message>
+    void broadcast_if(const Message& message, channel_predicate predicate,
+        channel_handler handle_channel, result_handler handle_complete)
+    {
+        auto channels = ranked_channels();
+        const auto excluded = [&predicate](channel::ptr channel)
+        {
+            return !predicate(channel);
+        };
 
-        // No pre-serialize, channels may have different protocol versions.
-        for (const auto channel: channels)
-            channel->send(message, std::bind(&p2p::handle_send, this,
-                std::placeholders::_1, channel, handle_channel, join_handler));
+        channels.erase(std::remove_if(channels.begin(), channels.end(),
+            excluded), channels.end());
+
+        send(message, channels, handle_channel, handle_complete);
+    }
+
+    /// Send message to the first count connections in order of the ranking,
+    /// or in order of latency if the ranking is empty.
+    template <typename Message>
+    void broadcast_to(const Message& message, size_t count,
+        channel_ranking ranking, channel_handler handle_channel,
+        result_handler handle_complete)
+    {
+        send(message, ranked_channels(count, ranking), handle_channel,
+            handle_complete);
     }
 
     // Constructors.
@@ -133,12 +173,38 @@ public:
     /// Set the current top header identity.
     virtual void set_top_header(const config::checkpoint& top);
 
+    /// Determine if the address is within a blacklisted range.
+    virtual bool blacklisted(const address& address) const;
+
+    /// Replace the blacklisted ranges, including configured hosts.
+    virtual void set_blacklist(const subnet::list& subnets);
+
     /// Determine if the network is stopped.
     virtual bool stopped() const;
 
     /// Return a reference to the network threadpool.
     virtual threadpool& thread_pool();
 
+    /// Return the threadpool of the next channel, in rotation among the
+    /// single threaded channel shards, or the network threadpool if none.
+    /// A channel and its timers, subscribers and protocols run on its pool.
+    virtual threadpool& channel_pool();
+
+    /// Return the payload buffer pool shared by all channels.
+    virtual buffer_pool::ptr buffers();
+
+    /// Return the channel allocation cache shared by all channel creators.
+    virtual channel_cache::ptr allocations();
+
+    /// Return the name resolution cache shared by all connectors.
+    virtual dns_cache::ptr names();
+
+    /// Return the statistics exporter, which records network events.
+    virtual statistics_exporter::ptr exporter();
+
+    /// Return the timer wheel shared by all channels and protocols.
+    virtual timer_wheel::ptr timers();
+
     // Subscriptions.
     // ------------------------------------------------------------------------
 
@@ -148,6 +214,21 @@ public:
     /// Subscribe to service stop event.
     virtual void subscribe_stop(result_handler handler);
 
+    /// Subscribe to inventory announcements, for batched relay to peers.
+    /// Returns the key of the subscription, or zero if stopped, in which
+    /// case the handler is invoked with service_stopped.
+    virtual uint64_t subscribe_announcement(inventory_handler handler);
+
+    /// Release the announcement handler of the key without invocation.
+    virtual void unsubscribe_announcement(uint64_t key);
+
+    // Inventory relay.
+    // ------------------------------------------------------------------------
+
+    /// Announce an inventory to all connections running inventory relay.
+    /// Announcements are batched into one inventory message per channel.
+    virtual void announce(const message::inventory_vector& inventory);
+
     // Manual connections.
     // ----------------------------------------------------------------------------
 
@@ -162,6 +243,15 @@ public:
     virtual void connect(const std::string& hostname, uint16_t port,
         channel_handler handler);
 
+    // Simulated connections.
+    // ------------------------------------------------------------------------
+
+    /// Accept an inbound connection on a transport other than a socket,
+    /// such as a pipe_transport, as if accepted by the inbound listener.
+    /// Invoke after run, the inbound session need not listen on a port, see
+    /// inbound_transport_only. The transport is stopped upon rejection.
+    virtual code accept(transport::ptr transport);
+
     // Hosts collection.
     // ------------------------------------------------------------------------
 
@@ -180,9 +270,20 @@ public:
     /// Get a list of stored hosts
     virtual code fetch_addresses(address::list& out_addresses) const;
 
+    /// Get the address message payload shared by responses to get_address,
+    /// serialized at the version and resampled once per address_cache_minutes.
+    /// Null if there are no addresses to send.
+    virtual proxy::const_payload_ptr address_payload(uint32_t version);
+
     /// Remove an address.
     virtual code remove(const address& address);
 
+    /// Record a successful connection to an address.
+    virtual code good_address(const address& address);
+
+    /// Record a failed connection attempt to an address.
+    virtual code failed_address(const address& address);
+
     // Pending connect collection.
     // ------------------------------------------------------------------------
 
@@ -210,6 +311,9 @@ public:
     /// Get the number of connections.
     virtual size_t connection_count() const;
 
+    /// Get the traffic, latency and queue depth of each connection.
+    virtual channel_statistics::list statistics() const;
+
     /// Store a connection.
     virtual code store(channel::ptr channel);
 
@@ -234,18 +338,115 @@ protected:
     virtual session_inbound::ptr attach_inbound_session();
     virtual session_outbound::ptr attach_outbound_session();
 
+    /// Override to provide the fee rate of a broadcast transaction, in
+    /// satoshis per kilobyte, for the fee filters of peers (bip133).
+    /// The default of max_uint64 is unknown, and is not filtered.
+    virtual uint64_t fee_rate(const message::transaction& tx) const;
+
 private:
-    typedef bc::pending<channel> pending_channels;
     typedef bc::pending<connector> pending_connectors;
+    typedef std::map<uint64_t, inventory_handler> announcement_handlers;
+    typedef std::shared_ptr<const hash_list> inventory_ptr;
 
     void handle_manual_started(const code& ec, result_handler handler);
     void handle_inbound_started(const code& ec, result_handler handler);
     void handle_hosts_loaded(const code& ec, result_handler handler);
     void handle_send(const code& ec, channel::ptr channel,
-        channel_handler handle_channel, result_handler handle_complete);
+        inventory_ptr inventory, channel_handler handle_channel,
+        result_handler handle_complete);
+
+    // The inventory of the message, recorded as known to each channel upon
+    // send. Messages without inventory are always sent.
+    template <typename Message>
+    static hash_list inventory_of(const Message&)
+    {
+        return{};
+    }
+
+    static hash_list inventory_of(const message::inventory& message);
+    static hash_list inventory_of(const message::transaction& message);
+    static hash_list inventory_of(const message::block& message);
+    static bool known(channel::ptr channel, inventory_ptr inventory);
+
+    // Determine if the relay filters of the channel admit the message.
+    template <typename Message>
+    bool relayable(channel::ptr, const Message&) const
+    {
+        return true;
+    }
+
+    bool relayable(channel::ptr channel,
+        const message::transaction& message) const;
+    channel_registry::channels ranked_channels() const;
+    channel_registry::channels ranked_channels(size_t count,
+        channel_ranking ranking) const;
+
+    // Send message to the channels, serializing once for each version.
+    template <typename Message>
+    void send(const Message& message,
+        const channel_registry::channels& channels,
+        channel_handler handle_channel, result_handler handle_complete)
+    {
+        // Invoke the completion handler after send complete on all channels.
+        const auto join_handler = synchronize(handle_complete,
+            channels.size(), "p2p_join", synchronizer_terminate::on_count);
+
+        // Channels may have different protocol versions, so serialize once
+        // for each distinct version and share the payload within the group.
+        std::map<uint32_t, proxy::const_payload_ptr> payloads;
+
+        // The inventory is shared by the completions of all channels.
+        auto hashes = inventory_of(message);
+        const auto inventory = hashes.empty() ? inventory_ptr{} :
+            std::make_shared<const hash_list>(std::move(hashes));
+
+        for (const auto channel: channels)
+        {
+            // Skip channels that cannot keep up, reporting back-pressure.
+            if (channel->saturated())
+            {
+                handle_send(error::peer_throttling, channel, {},
+                    handle_channel, join_handler);
+                continue;
+            }
+
+            // Skip channels whose relay filters do not admit the message.
+            if (!relayable(channel, message))
+            {
+                join_handler(error::success);
+                continue;
+            }
+
+            // Skip channels that already know the inventory of the message.
+            // The inventory is remembered once sent, so that a failed send
+            // does not suppress a later one.
+            if (known(channel, inventory))
+            {
+                join_handler(error::success);
+                continue;
+            }
+
+            const auto version = channel->negotiated_version();
+            auto& payload = payloads[version];
+
+            if (!payload)
+                payload = std::make_shared<const data_chunk>(
+                    message::serialize(version, message,
+                        settings_.identifier));
+
+            channel->send(Message::command, payload,
+                std::bind(&p2p::handle_send, this, std::placeholders::_1,
+                    channel, inventory, handle_channel, join_handler));
+        }
+    }
 
     void handle_started(const code& ec, result_handler handler);
     void handle_running(const code& ec, result_handler handler);
+    void do_announce(const announcement_handlers& handlers,
+        const message::inventory_vector& inventory);
+
+    void start_hosts_timer();
+    void handle_hosts_timer(const code& ec);
 
     // These are thread safe.
     const settings& settings_;
@@ -253,13 +454,35 @@ private:
     bc::atomic<config::checkpoint> top_block_;
     bc::atomic<config::checkpoint> top_header_;
     bc::atomic<session_manual::ptr> manual_;
+    bc::atomic<session_inbound::ptr> inbound_;
+    bc::atomic<session_outbound::ptr> outbound_;
+    bc::atomic<deadline::ptr> hosts_timer_;
     threadpool threadpool_;
+    const std::vector<std::unique_ptr<threadpool>> shards_;
+    std::atomic<size_t> next_shard_;
+    buffer_pool::ptr buffers_;
+    channel_cache::ptr allocations_;
+    blacklist blacklist_;
+    dns_cache::ptr names_;
+    statistics_exporter::ptr exporter_;
+    timer_wheel::ptr timers_;
     hosts hosts_;
     pending_connectors pending_connect_;
-    pending_channels pending_handshake_;
-    pending_channels pending_close_;
+    channel_registry pending_handshake_;
+    channel_registry pending_close_;
     stop_subscriber::ptr stop_subscriber_;
     channel_subscriber::ptr channel_subscriber_;
+
+    // These are protected by announcement_mutex_.
+    uint64_t announcement_key_;
+    announcement_handlers announcements_;
+    mutable shared_mutex announcement_mutex_;
+
+    // These are protected by address_mutex_.
+    address_const_ptr address_cache_;
+    std::chrono::steady_clock::time_point address_expiration_;
+    std::map<uint32_t, proxy::const_payload_ptr> address_payloads_;
+    upgrade_mutex address_mutex_;
 };
 
 } // namespace network
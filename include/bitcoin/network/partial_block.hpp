@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_PARTIAL_BLOCK_HPP
+#define LIBBITCOIN_NETWORK_PARTIAL_BLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is not thread safe.
+/// A block under reconstruction from a compact block (bip152). Slots of the
+/// block are filled from prefilled transactions, then from the memory pool
+/// by short id, and then from a block transactions response for the rest.
+/// Short ids are the low six bytes of the siphash-2-4 of the transaction
+/// hash (witness hash for compact version 2), keyed by the sha256 of the
+/// block header and the compact block nonce.
+class BCT_API partial_block
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<partial_block> ptr;
+
+    /// Visit a pooled transaction, return false to end the enumeration.
+    typedef std::function<bool(transaction_const_ptr)> transaction_visitor;
+
+    /// Enumerate the memory pool of the consumer with the visitor.
+    typedef std::function<void(transaction_visitor)> transaction_pool;
+
+    /// Create the compact form of a block, the coinbase is prefilled.
+    static message::compact_block compact(const message::block& block,
+        uint64_t nonce, bool witness);
+
+    /// Construct an instance, check valid before use.
+    partial_block(const message::compact_block& block, bool witness);
+
+    /// The compact block is well formed, with distinct short ids.
+    bool valid() const;
+
+    /// The hash of the block.
+    hash_digest hash() const;
+
+    /// Fill slots from the memory pool, returns the number filled.
+    /// A short id matched by more than one transaction is left missing.
+    size_t populate(transaction_pool pool);
+
+    /// The number of slots not yet filled.
+    size_t missing() const;
+
+    /// The request for the transactions of the slots not yet filled.
+    message::get_block_transactions request() const;
+
+    /// Fill the unfilled slots from a response to the request.
+    /// Returns error::bad_stream if the response does not match.
+    code fill(const message::block_transactions& response);
+
+    /// The reconstructed block, or null if slots are missing or the merkle
+    /// root does not match (a short id collision). In either case the block
+    /// must be obtained in full.
+    block_const_ptr block() const;
+
+private:
+    typedef std::unordered_map<uint64_t, size_t> slot_map;
+
+    uint64_t short_id(const hash_digest& hash) const;
+
+    const chain::header header_;
+    const bool witness_;
+    uint64_t key0_;
+    uint64_t key1_;
+    bool valid_;
+    size_t filled_count_;
+    slot_map slots_;
+    chain::transaction::list transactions_;
+    std::vector<bool> filled_;
+    std::vector<bool> prefilled_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
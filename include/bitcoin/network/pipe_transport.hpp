@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_PIPE_TRANSPORT_HPP
+#define LIBBITCOIN_NETWORK_PIPE_TRANSPORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// One end of a connected pair of in-memory transports, for the simulation
+/// of peers within the process. Written bytes are copied to the other end,
+/// and completions are posted to the pool as those of a socket would be.
+/// The pipe is unbounded, so a write completes without waiting on a read.
+/// Upon stop of one end, reads of the other fail with eof once its
+/// remaining bytes are consumed, and writes to it fail with broken_pipe.
+class BCT_API pipe_transport
+  : public transport, public std::enable_shared_from_this<pipe_transport>
+{
+public:
+    typedef std::shared_ptr<pipe_transport> ptr;
+    typedef std::pair<ptr, ptr> pair;
+
+    /// Create a connected pair, each end reporting the authority of the
+    /// other, so that first reports second and second reports first.
+    static pair make_pair(threadpool& pool, const config::authority& first,
+        const config::authority& second);
+
+    /// Construct an unconnected end, use make_pair.
+    pipe_transport(threadpool& pool, const config::authority& peer);
+
+    config::authority authority() const override;
+    void read(const boost::asio::mutable_buffer& buffer,
+        io_handler handler) override;
+    void read_some(const boost::asio::mutable_buffer& buffer,
+        io_handler handler) override;
+    void write(const const_buffers& buffers, io_handler handler) override;
+    void stop() override;
+
+private:
+    bool deliver(const const_buffers& buffers);
+    void disconnect();
+    void start_read(const boost::asio::mutable_buffer& buffer,
+        io_handler handler, bool partial);
+    void complete_read();
+    void post(io_handler handler, const boost_code& ec, size_t size);
+
+    // These are thread safe.
+    threadpool& pool_;
+    const config::authority peer_authority_;
+
+    // These are protected by mutex_.
+    bool stopped_;
+    bool disconnected_;
+    std::weak_ptr<pipe_transport> peer_;
+    std::deque<uint8_t> received_;
+    boost::asio::mutable_buffer reading_;
+    bool partial_;
+    io_handler reader_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
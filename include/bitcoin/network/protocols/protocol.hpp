@@ -26,6 +26,7 @@
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/proxy.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -79,6 +80,15 @@ protected:
         channel_->send(packet, BOUND_PROTOCOL(handler, args));
     }
 
+    /// Send a payload serialized at the negotiated version and handle the
+    /// result, where the command is the static command of the message type.
+    template <class Protocol, typename Handler, typename... Args>
+    void send_payload(const std::string& command,
+        proxy::const_payload_ptr payload, Handler&& handler, Args&&... args)
+    {
+        channel_->send(command, payload, BOUND_PROTOCOL(handler, args));
+    }
+
     /// Subscribe to all channel messages, blocking until subscribed.
     template <class Protocol, class Message, typename Handler, typename... Args>
     void subscribe(Handler&& handler, Args&&... args)
@@ -86,6 +96,14 @@ protected:
         channel_->template subscribe<Message>(BOUND_PROTOCOL(handler, args));
     }
 
+    /// Subscribe to channel messages for invocation on the reading thread.
+    template <class Protocol, class Message, typename Handler, typename... Args>
+    void subscribe_inline(Handler&& handler, Args&&... args)
+    {
+        channel_->template subscribe<Message>(BOUND_PROTOCOL(handler, args),
+            delivery::invoke);
+    }
+
     /// Subscribe to the channel stop, blocking until subscribed.
     template <class Protocol, typename Handler, typename... Args>
     void subscribe_stop(Handler&& handler, Args&&... args)
@@ -108,6 +126,15 @@ protected:
     /// Set the peer version message.
     virtual void set_peer_version(version_const_ptr value);
 
+    /// Record a ping round trip time for the channel.
+    virtual void record_round_trip(const asio::duration& value);
+
+    /// Determine if the inventory is probably known to the peer.
+    virtual bool known_inventory(const hash_digest& hash) const;
+
+    /// Record the inventory as known to the peer, false if already known.
+    virtual bool remember_inventory(const hash_digest& hash);
+
     /// Get the negotiated protocol version.
     virtual uint32_t negotiated_version() const;
 
@@ -147,6 +174,11 @@ private:
 #define SUBSCRIBE3(message, method, p1, p2, p3) \
     subscribe<CLASS, message>(&CLASS::method, p1, p2, p3)
 
+#define SUBSCRIBE_INLINE2(message, method, p1, p2) \
+    subscribe_inline<CLASS, message>(&CLASS::method, p1, p2)
+#define SUBSCRIBE_INLINE3(message, method, p1, p2, p3) \
+    subscribe_inline<CLASS, message>(&CLASS::method, p1, p2, p3)
+
 #define SUBSCRIBE_STOP1(method, p1) \
     subscribe_stop<CLASS>(&CLASS::method, p1)
 
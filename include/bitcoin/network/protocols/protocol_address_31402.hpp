@@ -19,6 +19,8 @@
 #ifndef LIBBITCOIN_NETWORK_PROTOCOL_ADDRESS_31402_HPP
 #define LIBBITCOIN_NETWORK_PROTOCOL_ADDRESS_31402_HPP
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
@@ -61,8 +63,19 @@ protected:
     virtual bool handle_receive_get_address(const code& ec,
         get_address_const_ptr message);
 
+    /// Consume tokens for up to count addresses, returning the number taken.
+    virtual size_t admit(size_t count);
+
     p2p& network_;
     const message::address self_;
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    // These are protected by mutex.
+    double tokens_;
+    clock::time_point refilled_;
+    shared_mutex mutex_;
 };
 
 } // namespace network
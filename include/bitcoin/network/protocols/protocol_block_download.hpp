@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_PROTOCOL_BLOCK_DOWNLOAD_HPP
+#define LIBBITCOIN_NETWORK_PROTOCOL_BLOCK_DOWNLOAD_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/block_download.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/protocols/protocol_timer.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/**
+ * Block download protocol.
+ * Keeps a window of blocks of the shared block download requested from the
+ * peer, requesting more as each arrives. The window is sized to the number
+ * of blocks the peer delivers in a stall period, averaged over periods, so
+ * that faster peers carry more of the download. The channel is stopped if
+ * no requested block is received within the stall period, and its requests
+ * are released to other channels. The channel is also stopped if a block it
+ * supplied is rejected upon delivery, which may follow its receipt.
+ */
+class BCT_API protocol_block_download
+  : public protocol_timer, track<protocol_block_download>
+{
+public:
+    typedef std::shared_ptr<protocol_block_download> ptr;
+
+    /**
+     * Construct a block download protocol instance.
+     * @param[in]  network   The network interface.
+     * @param[in]  channel   The channel on which to start the protocol.
+     * @param[in]  download  The block download state shared among channels.
+     */
+    protocol_block_download(p2p& network, channel::ptr channel,
+        block_download::ptr download);
+
+    /**
+     * Start the protocol.
+     * @param[in]  handler   Invoked with success upon completion of download.
+     */
+    virtual void start(event_handler handler);
+
+protected:
+    // Expose polymorphic start method from base.
+    using protocol_timer::start;
+
+    virtual void request_blocks(event_handler complete);
+    virtual void handle_event(const code& ec, event_handler complete);
+    virtual bool handle_receive_block(const code& ec,
+        block_const_ptr message, event_handler complete);
+    virtual void handle_rejected(const code& ec);
+
+private:
+    static const size_t minimum_window;
+
+    bool remove(const hash_digest& hash);
+    void update_window(size_t received);
+    void release();
+
+    p2p& network_;
+    block_download::ptr download_;
+    const bool witness_;
+    const size_t maximum_window_;
+
+    // These are thread safe.
+    std::atomic<size_t> window_;
+    std::atomic<size_t> received_;
+    std::atomic<size_t> rate_;
+
+    // This is protected by mutex_.
+    block_download::items outstanding_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_PROTOCOL_COMPACT_BLOCK_HPP
+#define LIBBITCOIN_NETWORK_PROTOCOL_COMPACT_BLOCK_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/partial_block.hpp>
+#include <bitcoin/network/protocols/protocol_events.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/**
+ * Compact block protocol, requires bip152 (70014).
+ * Announces compact block support with send_compact, in high bandwidth
+ * mode if requested, and reconstructs the compact blocks of the peer from
+ * the memory pool of the consumer. Only the transactions missing from the
+ * pool are requested from the peer. If a block cannot be reconstructed it
+ * is requested in full, and is then received by block subscribers.
+ * Compact blocks are not served to the peer by this protocol.
+ */
+class BCT_API protocol_compact_block
+  : public protocol_events, track<protocol_compact_block>
+{
+public:
+    typedef std::shared_ptr<protocol_compact_block> ptr;
+    typedef std::function<void(block_const_ptr)> block_handler;
+
+    /**
+     * Construct a compact block protocol instance.
+     * @param[in]  network         The network interface.
+     * @param[in]  channel         The channel on which to start the protocol.
+     * @param[in]  high_bandwidth  Ask the peer to push compact blocks.
+     * @param[in]  pool            Enumerates the pool of the consumer.
+     * @param[in]  handler         Invoked with each reconstructed block.
+     */
+    protocol_compact_block(p2p& network, channel::ptr channel,
+        bool high_bandwidth, partial_block::transaction_pool pool,
+        block_handler handler);
+
+    /**
+     * Start the protocol.
+     */
+    virtual void start();
+
+protected:
+    virtual void handle_stop(const code& ec);
+
+    virtual bool handle_receive_send_compact(const code& ec,
+        send_compact_const_ptr message);
+    virtual bool handle_receive_compact_block(const code& ec,
+        compact_block_const_ptr message);
+    virtual bool handle_receive_block_transactions(const code& ec,
+        block_transactions_const_ptr message);
+
+private:
+    partial_block::ptr exchange_pending(partial_block::ptr block);
+    void complete(partial_block::ptr block);
+    void request_block(const hash_digest& hash);
+
+    const bool witness_;
+    const bool high_bandwidth_;
+    const uint64_t compact_version_;
+    const partial_block::transaction_pool pool_;
+    const block_handler handler_;
+
+    // This is thread safe.
+    std::atomic<bool> compatible_;
+
+    // This is protected by mutex_.
+    partial_block::ptr pending_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
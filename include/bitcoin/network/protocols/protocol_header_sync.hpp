@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_PROTOCOL_HEADER_SYNC_HPP
+#define LIBBITCOIN_NETWORK_PROTOCOL_HEADER_SYNC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/header_sync.hpp>
+#include <bitcoin/network/protocols/protocol_timer.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/**
+ * Header synchronization protocol, requires headers (31800).
+ * Downloads the ranges of the shared header sync, one at a time, sending
+ * the next request of a range before storing the preceding response. The
+ * channel is stopped if a response is not received within the stall period
+ * or fails to link, and its range is released to another channel.
+ */
+class BCT_API protocol_header_sync
+  : public protocol_timer, track<protocol_header_sync>
+{
+public:
+    typedef std::shared_ptr<protocol_header_sync> ptr;
+
+    /**
+     * Construct a header sync protocol instance.
+     * @param[in]  network   The network interface.
+     * @param[in]  channel   The channel on which to start the protocol.
+     * @param[in]  sync      The header sync state shared among channels.
+     */
+    protocol_header_sync(p2p& network, channel::ptr channel,
+        header_sync::ptr sync);
+
+    /**
+     * Start the protocol.
+     * @param[in]  handler   Invoked with success upon completion of sync.
+     */
+    virtual void start(event_handler handler);
+
+protected:
+    // Expose polymorphic start method from base.
+    using protocol_timer::start;
+
+    virtual void next_range(event_handler complete);
+    virtual void handle_event(const code& ec, event_handler complete);
+    virtual bool handle_receive_headers(const code& ec,
+        headers_const_ptr message, event_handler complete);
+
+private:
+    static const size_t unassigned;
+
+    void release();
+
+    p2p& network_;
+    header_sync::ptr sync_;
+    std::atomic<size_t> range_;
+    std::atomic<bool> received_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_PROTOCOL_INVENTORY_RELAY_HPP
+#define LIBBITCOIN_NETWORK_PROTOCOL_INVENTORY_RELAY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/protocols/protocol_timer.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/**
+ * Inventory relay protocol.
+ * Collects the inventory announcements of the network (see p2p::announce)
+ * and sends them to the peer in one inventory message per relay interval,
+ * or sooner if the batch size is reached. Announcements of inventory known
+ * to the peer (see proxy::known_inventory) are skipped, and inventory is
+ * recorded as known to the peer only once its send succeeds.
+ * Transactions are not announced to a peer that disabled relay (bip37).
+ * The announcement subscription is released upon channel stop.
+ * Attach this to a channel immediately following handshake completion.
+ */
+class BCT_API protocol_inventory_relay
+  : public protocol_timer, track<protocol_inventory_relay>
+{
+public:
+    typedef std::shared_ptr<protocol_inventory_relay> ptr;
+
+    /**
+     * Construct an inventory relay protocol instance.
+     * @param[in]  network   The network interface.
+     * @param[in]  channel   The channel on which to start the protocol.
+     */
+    protocol_inventory_relay(p2p& network, channel::ptr channel);
+
+    /**
+     * Start the protocol.
+     */
+    virtual void start();
+
+protected:
+    // Expose polymorphic start method from base.
+    using protocol_timer::start;
+
+    virtual void handle_event(const code& ec);
+    virtual bool handle_announcement(const code& ec,
+        const message::inventory_vector& inventory);
+
+private:
+    void flush();
+    void unsubscribe();
+    void handle_relayed(const code& ec, const hash_list& hashes);
+
+    p2p& network_;
+    const size_t batch_;
+    const bool relay_transactions_;
+    std::atomic<uint64_t> announcement_;
+
+    // These are protected by mutex_.
+    message::inventory_vector::list pending_;
+    std::set<hash_digest> queued_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
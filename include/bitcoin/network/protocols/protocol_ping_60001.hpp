@@ -20,6 +20,7 @@
 #define LIBBITCOIN_NETWORK_PROTOCOL_PING_60001_HPP
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
@@ -60,7 +61,12 @@ protected:
         uint64_t nonce);
 
 private:
+    typedef std::chrono::steady_clock clock;
+
     std::atomic<bool> pending_;
+
+    // This is protected by the pending_ sequence.
+    clock::time_point sent_;
 };
 
 } // namespace network
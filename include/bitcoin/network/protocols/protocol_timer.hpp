@@ -19,11 +19,13 @@
 #ifndef LIBBITCOIN_NETWORK_PROTOCOL_TIMER_HPP
 #define LIBBITCOIN_NETWORK_PROTOCOL_TIMER_HPP
 
+#include <atomic>
 #include <string>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/protocols/protocol_events.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -68,7 +70,9 @@ private:
     void handle_notify(const code& ec, event_handler handler);
 
     const bool perpetual_;
-    deadline::ptr timer_;
+    timer_wheel::ptr timers_;
+    asio::duration timeout_;
+    std::atomic<timer_wheel::key> timer_;
 };
 
 } // namespace network
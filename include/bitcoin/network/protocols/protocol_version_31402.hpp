@@ -19,6 +19,7 @@
 #ifndef LIBBITCOIN_NETWORK_PROTOCOL_VERSION_31402_HPP
 #define LIBBITCOIN_NETWORK_PROTOCOL_VERSION_31402_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -60,8 +61,40 @@ public:
         uint32_t own_version, uint64_t own_services, uint64_t invalid_services,
         uint32_t minimum_version, uint64_t minimum_services);
 
+    /**
+     * Construct a version protocol instance from a version template.
+     * @param[in]  network           The network interface.
+     * @param[in]  channel           The channel for the protocol.
+     * @param[in]  own_version       This node's maximum version.
+     * @param[in]  own_services      This node's advertised services.
+     * @param[in]  invalid_services  The disallowed peers services.
+     * @param[in]  minimum_version   This required minimum version.
+     * @param[in]  minimum_services  This required minimum services.
+     * @param[in]  prototype         The template of this node's version.
+     */
+    protocol_version_31402(p2p& network, channel::ptr channel,
+        uint32_t own_version, uint64_t own_services, uint64_t invalid_services,
+        uint32_t minimum_version, uint64_t minimum_services,
+        version_const_ptr prototype);
+
+    /**
+     * Create the template of this node's version message, which is patched
+     * with the timestamp, receiver, nonce and height of each channel.
+     * @param[in]  settings          The network settings.
+     * @param[in]  own_version       This node's maximum version.
+     * @param[in]  own_services      This node's advertised services.
+     * @param[in]  relay             The peer should relay transactions.
+     */
+    static version_const_ptr make_template(const settings& settings,
+        uint32_t own_version, uint64_t own_services, bool relay);
+
     /**
      * Start the protocol.
+     * When the handshake is pipelined the handler is invoked upon receipt of
+     * a sufficient version, once verack is sent, so that post-handshake
+     * messages follow verack without awaiting the peer's verack. The verack
+     * is then awaited for the remainder of the handshake period, and the
+     * channel is stopped if it is not received.
      * @param[in]  handler  Invoked upon stop or receipt of version and verack.
      */
     virtual void start(event_handler handler);
@@ -83,6 +116,14 @@ protected:
     const uint64_t invalid_services_;
     const uint32_t minimum_version_;
     const uint64_t minimum_services_;
+    const version_const_ptr prototype_;
+
+private:
+    void handle_pipelined_event(const code& ec, event_handler handler);
+
+    std::atomic<bool> received_version_;
+    std::atomic<bool> received_verack_;
+    std::atomic<bool> completed_;
 };
 
 } // namespace network
@@ -61,6 +61,23 @@ public:
         uint32_t own_version, uint64_t own_services, uint64_t invalid_services,
         uint32_t minimum_version, uint64_t minimum_services, bool relay);
 
+    /**
+     * Construct a version protocol instance from a version template.
+     * @param[in]  network           The network interface.
+     * @param[in]  channel           The channel for the protocol.
+     * @param[in]  own_version       This node's maximum version.
+     * @param[in]  own_services      This node's advertised services.
+     * @param[in]  invalid_services  The disallowed peers services.
+     * @param[in]  minimum_version   This required minimum version.
+     * @param[in]  minimum_services  This required minimum services.
+     * @param[in]  relay             The peer should relay transactions.
+     * @param[in]  prototype         The template of this node's version.
+     */
+    protocol_version_70002(p2p& network, channel::ptr channel,
+        uint32_t own_version, uint64_t own_services, uint64_t invalid_services,
+        uint32_t minimum_version, uint64_t minimum_services, bool relay,
+        version_const_ptr prototype);
+
     /**
      * Start the protocol.
      * @param[in]  handler  Invoked upon stop or receipt of version and verack.
@@ -68,7 +85,6 @@ public:
     void start(event_handler handler) override;
 
 protected:
-    message::version version_factory() const override;
     bool sufficient_peer(version_const_ptr message) override;
 
     virtual bool handle_receive_reject(const code& ec,
@@ -22,47 +22,67 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
+#include <bitcoin/network/channel_metrics.hpp>
+#include <bitcoin/network/checksum.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/message_subscriber.hpp>
+#include <bitcoin/network/relay_filter.hpp>
+#include <bitcoin/network/rolling_bloom.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/small_handler.hpp>
+#include <bitcoin/network/stream_decoder.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
 
-/// Manages all socket communication, thread safe.
+/// Manages all communication over a transport, thread safe.
 class BCT_API proxy
   : public enable_shared_from_base<proxy>, noncopyable
 {
 public:
     typedef std::shared_ptr<proxy> ptr;
     typedef std::function<void(const code&)> result_handler;
+    typedef small_handler<void(const code&)> send_handler;
+    typedef std::shared_ptr<const data_chunk> const_payload_ptr;
     typedef subscriber<code> stop_subscriber;
 
     /// Construct an instance.
-    proxy(threadpool& pool, socket::ptr socket, const settings& settings);
+    proxy(threadpool& pool, transport::ptr transport,
+        const settings& settings, buffer_pool::ptr buffers);
 
     /// Validate proxy stopped.
     ~proxy();
 
     /// Send a message on the socket.
+    /// The handler is held without allocation for common binding sizes.
     template <class Message>
-    void send(const Message& message, result_handler handler)
+    void send(const Message& message, send_handler handler)
     {
-        auto data = message::serialize(version_, message, protocol_magic_);
-        const auto payload = std::make_shared<data_chunk>(std::move(data));
-        const auto command = std::make_shared<std::string>(message.command);
-
-        // Sequential dispatch is required because write may occur in multiple
-        // asynchronous steps invoked on different threads, causing deadlocks.
-        dispatch_.lock(&proxy::do_send,
-            shared_from_this(), command, payload, handler);
+        // The data buffer is moved into the shared control block allocation.
+        auto payload = std::make_shared<const data_chunk>(
+            message::serialize(version_, message, protocol_magic_));
+
+        send(Message::command, std::move(payload), std::move(handler));
     }
 
+    /// Send a message serialized at the negotiated version on the socket.
+    /// The payload is not modified and may be shared by multiple channels.
+    /// Queued messages are coalesced into a single write, in order.
+    /// Above the high-water mark low priority messages are dropped with
+    /// peer_throttling, and above twice the mark the channel is stopped.
+    /// The command is copied, which fits the short string buffer.
+    virtual void send(const std::string& command, const_payload_ptr payload,
+        send_handler handler);
+
     /// Subscribe to messages of the specified type on the socket.
     template <class Message>
     void subscribe(message_handler<Message>&& handler)
@@ -71,9 +91,51 @@ public:
             std::forward<message_handler<Message>>(handler));
     }
 
+    /// Subscribe to messages of the specified type on the socket, with the
+    /// specified delivery. Invoked handlers run on the reading thread.
+    template <class Message>
+    void subscribe(message_handler<Message>&& handler, delivery mode)
+    {
+        message_subscriber_.subscribe<Message>(
+            std::forward<message_handler<Message>>(handler), mode);
+    }
+
+    /// Subscribe to raw payloads of decoded messages on the socket.
+    /// The handler shares ownership of the read buffer, avoiding a copy.
+    virtual void subscribe_payload(payload_handler&& handler);
+
+    /// Subscribe to the transactions of blocks on the socket as they arrive.
+    /// Parts precede validation of the payload, see message_subscriber.
+    virtual void subscribe_block_stream(block_stream_handler&& handler);
+
+    /// Subscribe to the headers of headers messages as they arrive.
+    virtual void subscribe_headers_stream(headers_stream_handler&& handler);
+
     /// Subscribe to the stop event.
     virtual void subscribe_stop(result_handler handler);
 
+    /// Determine if the inventory is probably known to the peer, as it was
+    /// announced or sent by or to the peer. Inventory, transaction and block
+    /// messages received from the peer are recorded automatically.
+    virtual bool known_inventory(const hash_digest& hash) const;
+
+    /// Record the inventory as known to the peer, false if already known.
+    virtual bool remember_inventory(const hash_digest& hash);
+
+    /// Determine if the fee and bloom filters of the peer admit the
+    /// transaction, see relay_filter. Filter messages are applied as they
+    /// are received. A fee rate of max_uint64 is unknown (not filtered).
+    virtual bool admits(const chain::transaction& tx, uint64_t fee_rate);
+
+    /// The send queue is at or above its high-water mark.
+    virtual bool saturated() const;
+
+    /// Get the traffic, latency and send queue depth of this socket.
+    virtual channel_statistics statistics() const;
+
+    /// Get the threadpool on which this socket and its handlers run.
+    virtual threadpool& thread_pool();
+
     /// Get the authority of the far end of this socket.
     virtual const config::authority& authority() const;
 
@@ -84,6 +146,9 @@ public:
     /// Save the negotiated protocol version.
     virtual void set_negotiated_version(uint32_t value);
 
+    /// Validate the checksum of each received payload, set before start.
+    virtual void set_validate_checksum(bool value);
+
     /// Read messages from this socket.
     virtual void start(result_handler handler);
 
@@ -93,45 +158,129 @@ public:
 protected:
     virtual bool stopped() const;
     virtual void signal_activity() = 0;
+    virtual void signal_useful() = 0;
     virtual void handle_stopping() = 0;
 
 private:
     typedef byte_source<data_chunk> payload_source;
     typedef boost::iostreams::stream<payload_source> payload_stream;
-    typedef std::shared_ptr<std::string> command_ptr;
-    typedef std::shared_ptr<data_chunk> payload_ptr;
+
+    struct outbound
+    {
+        message::message_type type;
+        std::string command;
+        const_payload_ptr payload;
+        send_handler handler;
+    };
+
+    typedef std::deque<outbound> outbound_queue;
+    typedef std::vector<outbound> outbounds;
+    typedef std::shared_ptr<outbounds> outbounds_ptr;
+
+    template <class Message>
+    using receive_handler = bool (proxy::*)(const code&,
+        std::shared_ptr<const Message>);
+
+    // Decode a message handled by the proxy, then notify its subscribers.
+    template <class Message>
+    code decode(message::message_type type, const data_chunk& payload,
+        bool& consumed, receive_handler<Message> handler)
+    {
+        auto source = make_safe_deserializer(payload.begin(), payload.end());
+        const auto message = std::make_shared<Message>();
+
+        if (!message->from_data(version_, source))
+            return error::bad_stream;
+
+        // Trailing bytes stop the channel without notification.
+        consumed = source.is_exhausted();
+
+        if (!consumed)
+            return error::success;
+
+        (this->*handler)(error::success, message);
+        message_subscriber_.notify<Message>(type, message);
+        return error::success;
+    }
 
     void stop(const boost_code& ec);
+    code decode(const message::heading& head, const data_chunk& payload,
+        bool& consumed);
 
     void read_heading();
-    void handle_read_heading(const boost_code& ec, size_t payload_size);
+    void handle_read_some(const boost_code& ec, size_t size);
+    bool handle_heading(const message::heading& head);
 
-    void read_payload(const message::heading& head);
+    bool read_payload(const message::heading& head);
     void handle_read_payload(const boost_code& ec, size_t,
         const message::heading& head);
+    void read_payload_some(const message::heading& head);
+    void handle_read_payload_some(const boost_code& ec, size_t size,
+        const message::heading& head);
+    bool handle_payload(const message::heading& head, bool hashed);
+
+    bool handle_receive_inventory(const code& ec,
+        inventory_const_ptr message);
+    bool handle_receive_transaction(const code& ec,
+        transaction_const_ptr message);
+    bool handle_receive_block(const code& ec, block_const_ptr message);
+    bool handle_receive_fee_filter(const code& ec,
+        fee_filter_const_ptr message);
+    bool handle_receive_filter_load(const code& ec,
+        filter_load_const_ptr message);
+    bool handle_receive_filter_add(const code& ec,
+        filter_add_const_ptr message);
+    bool handle_receive_filter_clear(const code& ec,
+        filter_clear_const_ptr message);
 
-    void do_send(command_ptr command, payload_ptr payload,
-        result_handler handler);
-    void handle_send(const boost_code& ec, size_t bytes, command_ptr command,
-        payload_ptr payload, result_handler handler);
+    void do_send();
+    void handle_send(const boost_code& ec, size_t bytes,
+        outbounds_ptr batch);
+    void clear_send(const code& ec);
+    bool saturated(size_t factor) const;
 
+    threadpool& pool_;
     const config::authority authority_;
+    const std::string authority_text_;
 
     // These are protected by read header/payload ordering.
     data_chunk heading_buffer_;
-    data_chunk payload_buffer_;
-    socket::ptr socket_;
+    payload_ptr read_buffer_;
+    size_t read_begin_;
+    size_t read_end_;
+    size_t payload_read_;
+    payload_hasher payload_hasher_;
+    stream_decoder stream_decoder_;
+    payload_ptr payload_buffer_;
+    transport::ptr transport_;
+    buffer_pool::ptr buffers_;
 
     // These are thread safe.
     std::atomic<bool> stopped_;
     const uint32_t protocol_magic_;
     const size_t maximum_payload_;
-    const bool validate_checksum_;
+    const size_t send_batch_bytes_;
+    const size_t send_high_water_bytes_;
+    const size_t send_high_water_messages_;
+    std::atomic<bool> validate_checksum_;
     const bool verbose_;
     std::atomic<uint32_t> version_;
     message_subscriber message_subscriber_;
     stop_subscriber::ptr stop_subscriber_;
     dispatcher dispatch_;
+    channel_metrics metrics_;
+    rolling_bloom known_inventory_;
+    relay_filter relay_filter_;
+
+    // These are protected by read and write ordering respectively.
+    channel_metrics::clock::time_point read_started_;
+    channel_metrics::clock::time_point write_started_;
+
+    // These are protected by send_mutex_.
+    bool sending_;
+    size_t send_bytes_;
+    outbound_queue send_queue_;
+    mutable shared_mutex send_mutex_;
 };
 
 } // namespace network
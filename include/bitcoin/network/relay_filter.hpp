@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_RELAY_FILTER_HPP
+#define LIBBITCOIN_NETWORK_RELAY_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// The transaction relay filters announced by a peer, the minimum fee rate
+/// of fee_filter (bip133) and the bloom filter of filter_load, filter_add
+/// and filter_clear (bip37). A transaction is relayed to the peer only if
+/// it is admitted by both. With no filter loaded all transactions match.
+class BCT_API relay_filter
+  : noncopyable
+{
+public:
+    /// The filter_load flags that add matched outputs to the filter.
+    enum update : uint8_t
+    {
+        update_none = 0,
+        update_all = 1,
+        update_pay_key_only = 2
+    };
+
+    /// Construct an instance with no filters.
+    relay_filter();
+
+    /// The minimum fee rate in satoshis per kilobyte, zero if unset.
+    uint64_t minimum_fee_rate() const;
+
+    /// Set the minimum fee rate from a fee_filter message.
+    void set_minimum_fee_rate(uint64_t satoshi_per_kilobyte);
+
+    /// Load a bloom filter, returns error::bad_stream if oversized.
+    code load(const message::filter_load& message);
+
+    /// Add an element to the loaded bloom filter.
+    /// Returns error::bad_stream if oversized or if no filter is loaded.
+    code add(const message::filter_add& message);
+
+    /// Remove the bloom filter, so that all transactions match.
+    void clear();
+
+    /// A bloom filter is loaded.
+    bool loaded() const;
+
+    /// Determine if the transaction is admitted by the fee and bloom
+    /// filters. A fee rate of max_uint64 is unknown and is not filtered.
+    /// A bloom match may update the filter, according to its flags.
+    bool admits(const chain::transaction& tx, uint64_t fee_rate);
+
+private:
+    bool contains(const data_chunk& data) const;
+    void insert(const data_chunk& data);
+    bool matches(const chain::transaction& tx);
+
+    // These are protected by mutex_.
+    uint64_t minimum_fee_rate_;
+    bool loaded_;
+    data_chunk filter_;
+    uint32_t hash_functions_;
+    uint32_t tweak_;
+    uint8_t flags_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
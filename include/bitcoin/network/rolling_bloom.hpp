@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_ROLLING_BLOOM_HPP
+#define LIBBITCOIN_NETWORK_ROLLING_BLOOM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A set of hashes in bounded memory, which may report a hash not inserted
+/// (false positive) but never omits one of the most recent capacity hashes.
+/// Hashes are inserted into the newest of three bloom filters, each sized
+/// for half of the capacity. When the newest is full the oldest is cleared
+/// and becomes the newest. Bit positions are salted per instance, so that
+/// a peer cannot precompute hashes that collide in the filters of others.
+/// The filters are not allocated until the first insertion.
+class BCT_API rolling_bloom
+  : noncopyable
+{
+public:
+    /// Construct an instance, a capacity of zero contains nothing.
+    rolling_bloom(size_t capacity, double false_positive_rate);
+
+    /// The number of most recent hashes that are always contained.
+    size_t capacity() const;
+
+    /// Determine if the hash is probably contained.
+    bool contains(const hash_digest& hash) const;
+
+    /// Insert the hash, returns false if it was probably contained.
+    bool insert(const hash_digest& hash);
+
+    /// Remove all hashes.
+    void clear();
+
+private:
+    typedef std::vector<uint64_t> filter;
+
+    void positions(const hash_digest& hash,
+        std::vector<size_t>& out_positions) const;
+    bool contained(const std::vector<size_t>& positions) const;
+
+    const size_t capacity_;
+    const size_t entries_;
+    const size_t bits_;
+    const size_t hashes_;
+    const uint64_t salt_;
+
+    // These are protected by mutex_.
+    size_t count_;
+    size_t newest_;
+    std::vector<filter> filters_;
+    mutable shared_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -21,14 +21,18 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/acceptor.hpp>
+#include <bitcoin/network/backoff.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/connector.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
 
@@ -113,12 +117,19 @@ protected:
         dispatch_.delayed(delay, handler);
     }
 
-    /// Delay timing for a tight failure loop, based on configured timeout.
-    inline asio::duration cycle_delay(const code& ec)
+    /// Delay timing for a failure loop, backing off upon repeated failure.
+    inline asio::duration cycle_delay(const code& ec, backoff& curve)
     {
-        return (ec == error::channel_timeout || ec == error::service_stopped ||
-            ec == error::success) ? asio::seconds(0) :
-            settings_.connect_timeout();
+        if (ec == error::service_stopped)
+            return asio::seconds(0);
+
+        if (!ec)
+        {
+            curve.reset();
+            return asio::seconds(0);
+        }
+
+        return curve.next();
     }
 
     /// Properties.
@@ -127,10 +138,33 @@ protected:
     virtual size_t address_count() const;
     virtual size_t connection_count() const;
     virtual code fetch_address(address& out_address) const;
+    virtual code failed_address(const authority& authority);
     virtual bool blacklisted(const authority& authority) const;
+    virtual void store(const address::list& addresses,
+        result_handler handler);
+    virtual void resolve(const std::string& hostname, uint16_t port,
+        dns_cache::resolve_handler handler);
     virtual bool stopped() const;
     virtual bool stopped(const code& ec) const;
 
+    /// The session name under which its channels are counted in statistics.
+    virtual std::string name() const;
+
+    /// The template of the version message sent on the session's channels.
+    virtual version_const_ptr version_template() const;
+
+    /// Payload checksums are validated on the session's channels.
+    virtual bool validate_checksum() const;
+
+    /// Statistics.
+    // ------------------------------------------------------------------------
+
+    /// Record the outcome and duration of an outbound connection attempt.
+    virtual void record_connect(const code& ec, connector::ptr connector);
+
+    /// Record an inbound connection accepted by the acceptor.
+    virtual void record_accept();
+
     /// Socket creators.
     // ------------------------------------------------------------------------
 
@@ -200,6 +234,7 @@ private:
     const bool notify_on_connect_;
     p2p& network_;
     mutable dispatcher dispatch_;
+    const version_const_ptr version_template_;
 };
 
 #undef SESSION_ARGS
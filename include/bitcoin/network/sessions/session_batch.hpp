@@ -19,6 +19,10 @@
 #ifndef LIBBITCOIN_NETWORK_SESSION_BATCH_HPP
 #define LIBBITCOIN_NETWORK_SESSION_BATCH_HPP
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/connector.hpp>
@@ -41,15 +45,37 @@ protected:
     session_batch(p2p& network, bool notify_on_connect);
 
     /// Create a channel from the configured number of concurrent attempts.
+    /// The first success cancels the remaining attempts of the batch.
     virtual void connect(channel_handler handler);
 
 private:
+    /// The shared state of a batch of concurrent connection attempts.
+    struct race
+    {
+        typedef std::shared_ptr<race> ptr;
+
+        race(size_t size, channel_handler handler);
+
+        // This is not modified once the attempts are started.
+        std::vector<connector::ptr> connectors;
+
+        // These are thread safe.
+        const size_t size;
+        const channel_handler handler;
+        std::atomic<bool> won;
+        std::atomic<size_t> remaining;
+        std::atomic<size_t> canceled;
+        std::atomic<size_t> discarded;
+    };
+
     // Connect sequence
-    void new_connect(channel_handler handler);
+    void new_connect(connector::ptr connector, race::ptr batch);
     void start_connect(const code& ec, const authority& host,
-        channel_handler handler);
+        connector::ptr connector, race::ptr batch);
     void handle_connect(const code& ec, channel::ptr channel,
-        connector::ptr connector, channel_handler handler);
+        const authority& host, connector::ptr connector, race::ptr batch);
+    void handle_finish(const code& ec, channel::ptr channel,
+        race::ptr batch);
 
     const size_t batch_size_;
 };
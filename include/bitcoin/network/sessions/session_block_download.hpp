@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SESSION_BLOCK_DOWNLOAD_HPP
+#define LIBBITCOIN_NETWORK_SESSION_BLOCK_DOWNLOAD_HPP
+
+#include <memory>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/block_download.hpp>
+#include <bitcoin/network/sessions/session_sync.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/// Block download session, thread safe.
+/// Maintains the configured number of outbound connections, each running the
+/// block download protocol on the shared download state, until the download
+/// completes. Start this from an override of p2p::run, after header sync.
+class BCT_API session_block_download
+  : public session_sync, track<session_block_download>
+{
+public:
+    typedef std::shared_ptr<session_block_download> ptr;
+
+    /// Construct an instance.
+    session_block_download(p2p& network, block_download::ptr download);
+
+    /// Start the session, invokes handler upon completion of download or stop.
+    void start(result_handler handler) override;
+
+protected:
+    /// Overridden to count channels of this session in statistics.
+    std::string name() const override;
+
+    /// Overridden to attach the block download protocol.
+    void attach_sync_protocol(channel::ptr channel,
+        result_handler complete) override;
+
+private:
+    void handle_complete(const code& ec, result_handler handler);
+
+    // This is thread safe.
+    block_download::ptr download_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
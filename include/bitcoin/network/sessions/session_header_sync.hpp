@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SESSION_HEADER_SYNC_HPP
+#define LIBBITCOIN_NETWORK_SESSION_HEADER_SYNC_HPP
+
+#include <memory>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/header_sync.hpp>
+#include <bitcoin/network/sessions/session_sync.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/// Header synchronization session, thread safe.
+/// Maintains the configured number of outbound connections, each running
+/// the header sync protocol on the shared sync state, until sync completes.
+/// Start this from an override of p2p::run, before the long running sessions.
+class BCT_API session_header_sync
+  : public session_sync, track<session_header_sync>
+{
+public:
+    typedef std::shared_ptr<session_header_sync> ptr;
+
+    /// Construct an instance.
+    session_header_sync(p2p& network, header_sync::ptr sync);
+
+    /// Start the session, invokes handler upon completion of sync or stop.
+    void start(result_handler handler) override;
+
+protected:
+    /// Overridden to count channels of this session in statistics.
+    std::string name() const override;
+
+    /// Overridden to attach the header sync protocol.
+    void attach_sync_protocol(channel::ptr channel,
+        result_handler complete) override;
+
+private:
+    void handle_complete(const code& ec, result_handler handler);
+
+    // This is thread safe.
+    header_sync::ptr sync_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -19,8 +19,13 @@
 #ifndef LIBBITCOIN_NETWORK_SESSION_INBOUND_HPP
 #define LIBBITCOIN_NETWORK_SESSION_INBOUND_HPP
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/acceptor.hpp>
@@ -28,6 +33,7 @@
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/sessions/session.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/subnet.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -45,9 +51,24 @@ public:
     session_inbound(p2p& network, bool notify_on_connect);
 
     /// Start the session.
+    /// The session listens on the configured inbound port, unless configured
+    /// for inbound_transport_only, in which case it accepts only the channels
+    /// that are passed to accept. A zero port otherwise disables the session.
     void start(result_handler handler) override;
 
+    /// Accept a channel connected other than by the listener, such as one
+    /// on an in-process transport, subject to admission by the session.
+    /// The channel is not started if it is not admitted, so its transport
+    /// remains open and must be stopped by the caller.
+    virtual code accept(channel::ptr channel);
+
 protected:
+    /// Overridden to count channels of this session in statistics.
+    std::string name() const override;
+
+    /// Overridden to also validate checksums if enabled for this session.
+    bool validate_checksum() const override;
+
     /// Overridden to implement pending test for inbound channels.
     void handshake_complete(channel::ptr channel,
         result_handler handle_started) override;
@@ -56,18 +77,38 @@ protected:
     virtual void attach_protocols(channel::ptr channel);
 
 private:
+    typedef std::chrono::steady_clock clock;
+    typedef std::map<subnet, size_t> subnet_map;
+
+    code admit(const authority& authority);
+    bool throttled();
+    bool reserve_subnet(const authority& authority);
+    void release_subnet(const authority& authority);
+    bool evict();
     void start_accept(const code& ec);
 
     void handle_stop(const code& ec);
     void handle_started(const code& ec, result_handler handler);
     void handle_accept(const code& ec, channel::ptr channel);
+    void register_accepted(channel::ptr channel);
+    void start_accepted(channel::ptr channel);
 
     void handle_channel_start(const code& ec, channel::ptr channel);
-    void handle_channel_stop(const code& ec);
+    void handle_channel_stop(const code& ec, channel::ptr channel);
 
     // These are thread safe.
     acceptor::ptr acceptor_;
     const size_t connection_limit_;
+    backoff backoff_;
+
+    // These are protected by mutex.
+    std::vector<channel::ptr> channels_;
+    std::vector<channel::ptr> evicted_;
+    std::deque<channel::ptr> deferred_;
+    subnet_map subnets_;
+    double tokens_;
+    clock::time_point refilled_;
+    mutable shared_mutex mutex_;
 };
 
 } // namespace network
@@ -57,6 +57,12 @@ public:
         channel_handler handler);
 
 protected:
+    /// Overridden to count channels of this session in statistics.
+    std::string name() const override;
+
+    /// Overridden to also validate checksums if enabled for this session.
+    bool validate_checksum() const override;
+
     /// Override to attach specialized protocols upon channel start.
     virtual void attach_protocols(channel::ptr channel);
 
@@ -73,6 +79,9 @@ private:
         uint16_t port, channel::ptr channel, channel_handler handler);
     void handle_channel_stop(const code& ec, const std::string& hostname,
         uint16_t port);
+
+    // This is thread safe.
+    backoff backoff_;
 };
 
 } // namespace network
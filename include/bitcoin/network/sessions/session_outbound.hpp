@@ -21,7 +21,10 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/anchors.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/sessions/session_batch.hpp>
@@ -43,9 +46,20 @@ public:
     session_outbound(p2p& network, bool notify_on_connect);
 
     /// Start the session.
+    /// Anchors saved by the previous stop are reconnected first, each in
+    /// place of one batch connection, falling back to a batch upon failure.
     void start(result_handler handler) override;
 
+    /// Save the connected channels as anchors for the next start.
+    virtual bool save_anchors() const;
+
 protected:
+    /// Overridden to count channels of this session in statistics.
+    std::string name() const override;
+
+    /// Overridden to also validate checksums if enabled for this session.
+    bool validate_checksum() const override;
+
     /// Overridden to implement pending outbound channels.
     void start_channel(channel::ptr channel,
         result_handler handle_started) override;
@@ -57,7 +71,17 @@ protected:
     /// Override to attach specialized protocols upon channel start.
     virtual void attach_protocols(channel::ptr channel);
 
+    /// Overridden to prefer addresses outside of connected network groups.
+    code fetch_address(address& out_address) const override;
+
 private:
+    anchors::list load_anchors() const;
+    void connect_anchor(const anchors::anchor& anchor);
+    void handle_anchor_connect(const code& ec, channel::ptr channel,
+        const config::authority& host, connector::ptr connector);
+
+    bool reserve_slot();
+    void release_slot();
     void new_connection(const code&);
 
     void handle_started(const code& ec, result_handler handler);
@@ -68,6 +92,18 @@ private:
 
     void handle_channel_stop(const code& ec, channel::ptr channel);
     void handle_channel_start(const code& ec, channel::ptr channel);
+
+    void start_rotation();
+    void handle_rotation(const code& ec);
+
+    // This is thread safe.
+    backoff backoff_;
+
+    // These are protected by mutex.
+    std::vector<channel::ptr> channels_;
+    size_t connecting_;
+    size_t waiting_;
+    mutable upgrade_mutex mutex_;
 };
 
 } // namespace network
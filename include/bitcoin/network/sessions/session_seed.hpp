@@ -19,13 +19,16 @@
 #ifndef LIBBITCOIN_NETWORK_SESSION_SEED_HPP
 #define LIBBITCOIN_NETWORK_SESSION_SEED_HPP
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/connector.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
 #include <bitcoin/network/sessions/session.hpp>
 #include <bitcoin/network/settings.hpp>
 
@@ -48,6 +51,12 @@ public:
     void start(result_handler handler) override;
 
 protected:
+    /// Overridden to count channels of this session in statistics.
+    std::string name() const override;
+
+    /// Overridden to advertise neither services nor relay to seeds.
+    version_const_ptr version_template() const override;
+
     /// Overridden to set service and version mins upon session start.
     void attach_handshake_protocols(channel::ptr channel,
         result_handler handle_started) override;
@@ -57,17 +66,44 @@ protected:
         result_handler handler);
 
 private:
+    /// The shared state of the concurrent contact of all seeds.
+    struct seeding
+    {
+        typedef std::shared_ptr<seeding> ptr;
+
+        seeding(size_t target, size_t size, result_handler handler);
+
+        // This is not modified once the seeds are contacted.
+        std::vector<connector::ptr> connectors;
+
+        // These are protected by mutex.
+        std::vector<channel::ptr> channels;
+        shared_mutex mutex;
+
+        // These are thread safe.
+        const size_t target;
+        const result_handler handler;
+        std::atomic<bool> complete;
+        std::atomic<size_t> remaining;
+    };
+
     void start_seeding(size_t start_size, result_handler handler);
-    void start_seed(const config::endpoint& seed, result_handler handler);
+    void start_seed(const config::endpoint& seed, connector::ptr connector,
+        seeding::ptr state);
+    void start_dns_seed(const config::endpoint& seed, seeding::ptr state);
+    void handle_dns_seed(const code& ec, const dns_cache::endpoints& resolved,
+        const config::endpoint& seed, seeding::ptr state);
     void handle_started(const code& ec, result_handler handler);
     void handle_connect(const code& ec, channel::ptr channel,
         const config::endpoint& seed, connector::ptr connector,
-        result_handler handler);
-    void handle_complete(size_t start_size, result_handler handler);
+        seeding::ptr state);
+    void handle_complete(const code& ec, seeding::ptr state);
 
     void handle_channel_start(const code& ec, channel::ptr channel,
-        result_handler handler);
+        seeding::ptr state);
     void handle_channel_stop(const code& ec);
+
+    const version_const_ptr seed_template_;
 };
 
 } // namespace network
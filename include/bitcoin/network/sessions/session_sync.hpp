@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SESSION_SYNC_HPP
+#define LIBBITCOIN_NETWORK_SESSION_SYNC_HPP
+
+#include <atomic>
+#include <memory>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/backoff.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/sessions/session_outbound.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/// Intermediate base class for synchronization sessions, thread safe.
+/// Maintains the configured number of outbound connections, reconnecting
+/// with backoff, each running the protocol attached by the derived session,
+/// until the first completion of that protocol or stop of the session.
+class BCT_API session_sync
+  : public session_outbound
+{
+public:
+    typedef std::shared_ptr<session_sync> ptr;
+
+    /// Start the session, invokes handler upon completion of sync or stop.
+    void start(result_handler handler) override;
+
+protected:
+    /// Construct an instance.
+    session_sync(p2p& network);
+
+    /// Attach the ping and reject protocols and then the sync protocol.
+    virtual void attach_protocols(channel::ptr channel,
+        result_handler handler);
+
+    /// Attach and start the sync protocol, invoking complete upon its end.
+    virtual void attach_sync_protocol(channel::ptr channel,
+        result_handler complete) = 0;
+
+    // Expose polymorphic attach_protocols method from base.
+    using session_outbound::attach_protocols;
+
+private:
+    void new_connection(const code&, result_handler handler);
+
+    void handle_started(const code& ec, result_handler handler);
+    void handle_connect(const code& ec, channel::ptr channel,
+        result_handler handler);
+
+    void handle_channel_start(const code& ec, channel::ptr channel,
+        result_handler handler);
+    void handle_channel_stop(const code& ec, result_handler handler);
+    void handle_complete(const code& ec, result_handler handler);
+
+    // These are thread safe.
+    std::atomic<bool> complete_;
+    backoff backoff_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
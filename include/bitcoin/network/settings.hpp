@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/subnet.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -36,30 +37,69 @@ public:
 
     /// Properties.
     uint32_t threads;
+    uint32_t channel_shards;
     uint32_t protocol_maximum;
     uint32_t protocol_minimum;
     uint64_t services;
     uint64_t invalid_services;
     bool relay_transactions;
     bool validate_checksum;
+    bool validate_inbound_checksum;
+    bool validate_outbound_checksum;
+    bool validate_manual_checksum;
     uint32_t identifier;
     uint16_t inbound_port;
     uint32_t inbound_connections;
+    uint32_t inbound_accepts;
+    uint32_t inbound_subnet_limit;
+    uint32_t inbound_accept_rate;
+    uint32_t inbound_eviction_idle_seconds;
+    uint32_t inbound_backlog;
+    bool inbound_transport_only;
     uint32_t outbound_connections;
+    uint32_t outbound_rotation_minutes;
+    uint32_t outbound_connect_limit;
     uint32_t manual_attempt_limit;
     uint32_t connect_batch_size;
     uint32_t connect_timeout_seconds;
+    uint32_t connect_attempt_delay_milliseconds;
     uint32_t channel_handshake_seconds;
+    bool channel_handshake_pipelining;
     uint32_t channel_germination_seconds;
     uint32_t channel_heartbeat_minutes;
     uint32_t channel_inactivity_minutes;
     uint32_t channel_expiration_minutes;
+    uint32_t header_sync_stall_seconds;
+    uint32_t block_download_stall_seconds;
+    uint32_t block_download_window;
+    uint32_t inventory_relay_milliseconds;
+    uint32_t inventory_relay_batch;
+    uint32_t known_inventory_capacity;
     uint32_t host_pool_capacity;
+    uint32_t host_pool_shards;
+    uint32_t hosts_checkpoint_minutes;
+    uint32_t address_cache_minutes;
+    uint32_t address_accepts_per_minute;
+    uint32_t dns_cache_minutes;
+    uint32_t dns_negative_cache_seconds;
+    uint32_t buffer_pool_megabytes;
+    uint32_t channel_cache_size;
+    uint32_t read_buffer_bytes;
+    uint32_t send_batch_bytes;
+    uint32_t send_high_water_bytes;
+    uint32_t send_high_water_messages;
+    bool socket_no_delay;
+    bool socket_keep_alive;
+    uint32_t socket_send_buffer_bytes;
+    uint32_t socket_receive_buffer_bytes;
     boost::filesystem::path hosts_file;
+    boost::filesystem::path anchors_file;
     config::authority self;
     config::authority::list blacklists;
+    subnet::list blacklist_subnets;
     config::endpoint::list peers;
     config::endpoint::list seeds;
+    config::endpoint::list dns_seeds;
 
     // [log]
     boost::filesystem::path debug_file;
@@ -70,16 +110,32 @@ public:
     size_t maximum_archive_size;
     size_t maximum_archive_files;
     config::authority statistics_server;
+    uint32_t statistics_interval_seconds;
     bool verbose;
 
     /// Helpers.
     size_t minimum_connections() const;
+    size_t buffer_pool_capacity() const;
+    int listen_backlog() const;
+    int socket_send_buffer() const;
+    int socket_receive_buffer() const;
     asio::duration connect_timeout() const;
+    asio::duration connect_attempt_delay() const;
     asio::duration channel_handshake() const;
     asio::duration channel_heartbeat() const;
     asio::duration channel_inactivity() const;
     asio::duration channel_expiration() const;
     asio::duration channel_germination() const;
+    asio::duration header_sync_stall() const;
+    asio::duration block_download_stall() const;
+    asio::duration inventory_relay() const;
+    asio::duration hosts_checkpoint() const;
+    asio::duration address_cache() const;
+    asio::duration outbound_rotation() const;
+    asio::duration inbound_eviction_idle() const;
+    asio::duration dns_ttl() const;
+    asio::duration dns_negative_ttl() const;
+    asio::duration statistics_interval() const;
 };
 
 } // namespace network
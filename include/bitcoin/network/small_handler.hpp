@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SMALL_HANDLER_HPP
+#define LIBBITCOIN_NETWORK_SMALL_HANDLER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace libbitcoin {
+namespace network {
+
+/// The inline capacity of a small handler, which holds a member function
+/// bound to a shared pointer and several arguments without allocation.
+static const size_t small_handler_capacity = 128;
+
+template <typename Signature, size_t Capacity = small_handler_capacity>
+class small_handler;
+
+/// A move-only function wrapper that stores the target inline, not thread
+/// safe. Targets that exceed the capacity, or that may throw on move, are
+/// held on the heap as with std::function.
+template <size_t Capacity, typename Result, typename... Args>
+class small_handler<Result(Args...), Capacity>
+{
+public:
+    small_handler() noexcept
+      : invoke_(nullptr), manage_(nullptr)
+    {
+    }
+
+    small_handler(std::nullptr_t) noexcept
+      : small_handler()
+    {
+    }
+
+    template <typename Function, typename Target =
+        typename std::decay<Function>::type, typename = typename
+        std::enable_if<!std::is_same<Target, small_handler>::value>::type>
+    small_handler(Function&& function)
+      : invoke_(&invoke<Target>), manage_(&manage<Target>)
+    {
+        construct<Target>(std::forward<Function>(function), local<Target>());
+    }
+
+    small_handler(small_handler&& other) noexcept
+      : small_handler()
+    {
+        take(other);
+    }
+
+    small_handler& operator=(small_handler&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            take(other);
+        }
+
+        return *this;
+    }
+
+    small_handler(const small_handler&) = delete;
+    small_handler& operator=(const small_handler&) = delete;
+
+    ~small_handler()
+    {
+        reset();
+    }
+
+    /// The handler has a target.
+    explicit operator bool() const noexcept
+    {
+        return invoke_ != nullptr;
+    }
+
+    /// Invoke the target, throws std::bad_function_call if there is none.
+    Result operator()(Args... args) const
+    {
+        if (invoke_ == nullptr)
+            throw std::bad_function_call();
+
+        return invoke_(&storage_, std::forward<Args>(args)...);
+    }
+
+private:
+    typedef typename std::aligned_storage<Capacity,
+        alignof(std::max_align_t)>::type storage;
+
+    enum class operation
+    {
+        move,
+        destroy
+    };
+
+    typedef Result(*invoker)(void*, Args&&...);
+    typedef void(*manager)(operation, void*, void*);
+
+    // The target is stored inline when it fits and is moved without throwing.
+    template <typename Function>
+    using local = std::integral_constant<bool,
+        sizeof(Function) <= sizeof(storage) &&
+        alignof(storage) % alignof(Function) == 0 &&
+        std::is_nothrow_move_constructible<Function>::value>;
+
+    template <typename Function>
+    static Function* target(void* data, std::true_type)
+    {
+        return static_cast<Function*>(data);
+    }
+
+    template <typename Function>
+    static Function* target(void* data, std::false_type)
+    {
+        return *static_cast<Function**>(data);
+    }
+
+    template <typename Function>
+    static Result invoke(void* data, Args&&... args)
+    {
+        auto& function = *target<Function>(data, local<Function>());
+        return function(std::forward<Args>(args)...);
+    }
+
+    template <typename Function>
+    static void manage(operation action, void* from, void* to)
+    {
+        manage<Function>(action, from, to, local<Function>());
+    }
+
+    template <typename Function>
+    static void manage(operation action, void* from, void* to,
+        std::true_type)
+    {
+        const auto function = static_cast<Function*>(from);
+
+        if (action == operation::move)
+            new (to) Function(std::move(*function));
+
+        function->~Function();
+    }
+
+    template <typename Function>
+    static void manage(operation action, void* from, void* to,
+        std::false_type)
+    {
+        const auto function = *static_cast<Function**>(from);
+
+        if (action == operation::move)
+            new (to) Function*(function);
+        else
+            delete function;
+    }
+
+    template <typename Function, typename Argument>
+    void construct(Argument&& function, std::true_type)
+    {
+        new (&storage_) Function(std::forward<Argument>(function));
+    }
+
+    template <typename Function, typename Argument>
+    void construct(Argument&& function, std::false_type)
+    {
+        new (&storage_) Function*(new Function(
+            std::forward<Argument>(function)));
+    }
+
+    void take(small_handler& other) noexcept
+    {
+        if (other.manage_ == nullptr)
+            return;
+
+        other.manage_(operation::move, &other.storage_, &storage_);
+        invoke_ = other.invoke_;
+        manage_ = other.manage_;
+        other.invoke_ = nullptr;
+        other.manage_ = nullptr;
+    }
+
+    void reset() noexcept
+    {
+        if (manage_ == nullptr)
+            return;
+
+        manage_(operation::destroy, &storage_, nullptr);
+        invoke_ = nullptr;
+        manage_ = nullptr;
+    }
+
+    mutable storage storage_;
+    invoker invoke_;
+    manager manage_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
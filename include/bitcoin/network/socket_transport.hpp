@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SOCKET_TRANSPORT_HPP
+#define LIBBITCOIN_NETWORK_SOCKET_TRANSPORT_HPP
+
+#include <memory>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The transport of a connected tcp socket, thread safe.
+class BCT_API socket_transport
+  : public transport
+{
+public:
+    typedef std::shared_ptr<socket_transport> ptr;
+
+    /// Apply the configured options to a connected socket. Options are
+    /// advisory, a failure is reflected only in the effective options.
+    static void configure(socket& connection, const settings& settings);
+
+    /// Apply the configured buffer sizes to a socket before it connects, as
+    /// the receive buffer determines the window scale of the connection.
+    static void configure(asio::socket& connecting, const settings& settings);
+
+    /// Apply the configured buffer sizes to a listening socket, from which
+    /// accepted sockets inherit them before the connection is established.
+    static void configure(asio::acceptor& listener, const settings& settings);
+
+    /// Construct an instance, reading the effective options of the socket.
+    socket_transport(socket::ptr socket);
+
+    config::authority authority() const override;
+    transport_options options() const override;
+    void read(const boost::asio::mutable_buffer& buffer,
+        io_handler handler) override;
+    void read_some(const boost::asio::mutable_buffer& buffer,
+        io_handler handler) override;
+    void write(const const_buffers& buffers, io_handler handler) override;
+    void stop() override;
+
+private:
+    // These are thread safe.
+    socket::ptr socket_;
+    const transport_options options_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_STATISTICS_EXPORTER_HPP
+#define LIBBITCOIN_NETWORK_STATISTICS_EXPORTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/settings.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+class p2p;
+
+/// This class is thread safe.
+/// Aggregates network events and periodically pushes them, with the gauges
+/// of the network, to the statistics server as StatsD lines over UDP.
+/// Events are recorded with relaxed atomics and datagrams are sent
+/// asynchronously from the timer, so neither blocks the caller. A push is
+/// skipped if the previous one remains in progress.
+class BCT_API statistics_exporter
+  : public enable_shared_from_base<statistics_exporter>, noncopyable
+{
+public:
+    typedef std::shared_ptr<statistics_exporter> ptr;
+
+    /// Construct an instance.
+    statistics_exporter(p2p& network);
+
+    /// Start periodic export, unless the server or interval is unspecified.
+    virtual void start();
+
+    /// Stop periodic export.
+    virtual void stop();
+
+    /// Record the outcome and duration of an outbound connection attempt.
+    virtual void connected(const code& ec, const asio::duration& elapsed);
+
+    /// Record the outcome of a channel handshake.
+    virtual void handshaken(const code& ec);
+
+    /// Record an inbound connection accepted by the acceptor.
+    virtual void accepted();
+
+    /// Record a channel registered or removed by the named session.
+    virtual void registered(const std::string& session);
+    virtual void removed(const std::string& session);
+
+private:
+    typedef boost::asio::ip::udp udp;
+    typedef std::shared_ptr<udp::socket> socket_ptr;
+    typedef std::vector<std::string> datagrams;
+    typedef std::shared_ptr<datagrams> datagrams_ptr;
+    typedef std::map<std::string, int64_t> session_counts;
+
+    static size_t bucket(const asio::duration& elapsed);
+
+    void start_timer();
+    void handle_timer(const code& ec);
+
+    datagrams collect();
+    void send(datagrams_ptr batch, size_t index);
+    void handle_send(const boost_code& ec, datagrams_ptr batch,
+        size_t index);
+
+    // These are thread safe.
+    p2p& network_;
+    threadpool& pool_;
+    const settings& settings_;
+    std::atomic<bool> stopped_;
+    std::atomic<bool> sending_;
+    std::atomic<uint64_t> connects_;
+    std::atomic<uint64_t> connect_failures_;
+    std::atomic<uint64_t> handshakes_;
+    std::atomic<uint64_t> handshake_failures_;
+    std::atomic<uint64_t> accepts_;
+    std::vector<std::atomic<uint64_t>> latencies_;
+
+    // These are protected by mutex_.
+    socket_ptr socket_;
+    deadline::ptr timer_;
+    session_counts sessions_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
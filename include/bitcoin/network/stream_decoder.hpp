@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_STREAM_DECODER_HPP
+#define LIBBITCOIN_NETWORK_STREAM_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/message_subscriber.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Incremental decoder of block and headers payloads, not thread safe.
+/// The payload is parsed as its bytes arrive, and each of its transactions
+/// or headers is notified to stream subscribers once, in order. An incomplete
+/// part is parsed again from its start only once the bytes available to it
+/// have doubled or the payload is complete, so that the parse of a part that
+/// arrives in many reads remains linear in its size. A part that fails to
+/// parse once the payload is complete ends notification, as the decode of
+/// the whole payload then fails.
+class BCT_API stream_decoder
+  : noncopyable
+{
+public:
+    /// Construct an instance, notifying the subscriber.
+    stream_decoder(const message_subscriber& subscriber);
+
+    /// Begin a payload of the size, returns false if the type is not stream
+    /// subscribed.
+    bool start(message::message_type type, uint32_t version, size_t size);
+
+    /// A payload is being decoded.
+    bool streaming() const;
+
+    /// Decode the parts in the first size bytes of the payload.
+    void parse(const uint8_t* payload, size_t size);
+
+private:
+    enum class stage
+    {
+        header,
+        count,
+        parts,
+        done
+    };
+
+    bool parse_next(reader& source);
+
+    const message_subscriber& subscriber_;
+    message::message_type type_;
+    uint32_t version_;
+    stage stage_;
+    size_t size_;
+    size_t offset_;
+    size_t pending_;
+    size_t count_;
+    size_t index_;
+    streamed_header_ptr header_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_SUBNET_HPP
+#define LIBBITCOIN_NETWORK_SUBNET_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// Serialization helper for an address range in CIDR notation, such as
+/// 10.0.0.0/8 or 2001:db8::/32. An address without prefix length is a single
+/// host. IPv4 ranges are held as IPv4-mapped IPv6 ranges.
+class BCT_API subnet
+{
+public:
+    typedef std::vector<subnet> list;
+
+    /// The network group of the host of the authority, its /16 range for
+    /// IPv4 or its /32 range for IPv6, for diversity of connections.
+    static subnet group(const config::authority& authority);
+
+    /// The unspecified host.
+    subnet();
+
+    /// Parse a CIDR range, throws invalid_option_value if invalid.
+    subnet(const std::string& value);
+
+    /// The host of the authority, ignoring its port.
+    subnet(const config::authority& authority);
+
+    /// The range of the IPv6 prefix length, which is truncated to 128.
+    subnet(const asio::ipv6& ip, uint8_t prefix);
+
+    /// The network address, with host bits cleared.
+    const asio::ipv6& ip() const;
+
+    /// The prefix length within the IPv6 address space.
+    uint8_t prefix() const;
+
+    /// The range in CIDR notation, using IPv4 notation for mapped ranges.
+    std::string to_string() const;
+
+    bool operator==(const subnet& other) const;
+    bool operator!=(const subnet& other) const;
+    bool operator<(const subnet& other) const;
+
+    friend std::istream& operator>>(std::istream& input, subnet& argument);
+    friend std::ostream& operator<<(std::ostream& output,
+        const subnet& argument);
+
+private:
+    asio::ipv6 ip_;
+    uint8_t prefix_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
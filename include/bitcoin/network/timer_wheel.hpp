@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_TIMER_WHEEL_HPP
+#define LIBBITCOIN_NETWORK_TIMER_WHEEL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// This class is thread safe.
+/// A hashed timer wheel shared by all channels, driven by a single deadline.
+/// Each timer is placed in the slot at which it expires, with the number of
+/// full revolutions remaining, so scheduling and canceling are constant time
+/// regardless of the number of timers or the length of their delays. Delays
+/// are rounded up to the resolution. Handlers are posted to the threadpool of
+/// their owner with success upon expiration or with service_stopped upon stop,
+/// and never upon cancel, so that the tick is not held by their execution.
+class BCT_API timer_wheel
+  : public enable_shared_from_base<timer_wheel>, noncopyable
+{
+public:
+    typedef std::shared_ptr<timer_wheel> ptr;
+    typedef std::function<void(const code&)> result_handler;
+
+    /// Identifies a scheduled timer, zero is never a valid key.
+    typedef uint64_t key;
+
+    /// Construct an instance.
+    timer_wheel(threadpool& pool, const asio::duration& resolution,
+        size_t slots);
+
+    /// Start the tick, timers may be scheduled before or after start.
+    virtual void start();
+
+    /// Stop the tick and post all scheduled timers with service_stopped.
+    /// Timers scheduled after stop are posted with service_stopped.
+    virtual void stop();
+
+    /// Schedule the handler for posting to the pool of the wheel after delay.
+    virtual key schedule(const asio::duration& delay, result_handler handler);
+
+    /// Schedule the handler for posting to the pool after the delay.
+    virtual key schedule(threadpool& pool, const asio::duration& delay,
+        result_handler handler);
+
+    /// Release the handler of the timer without invocation.
+    /// Returns false if the timer has already fired or been canceled.
+    virtual bool cancel(key timer);
+
+    /// The number of scheduled timers.
+    virtual size_t size() const;
+
+    /// Advance the wheel by one slot, invoking the timers that expire.
+    /// This is invoked by the tick and is exposed for testing.
+    virtual void advance();
+
+private:
+    struct entry
+    {
+        size_t rounds;
+        threadpool* pool;
+        result_handler handler;
+    };
+
+    typedef std::unordered_map<key, entry> slot;
+    typedef std::unordered_map<key, size_t> locations;
+    typedef std::vector<entry> entries;
+
+    static void post(entries& fired, const code& ec);
+    static void post(threadpool& pool, result_handler handler, const code& ec);
+
+    void start_timer();
+    void handle_timer(const code& ec);
+
+    // These are thread safe.
+    threadpool& pool_;
+    const asio::duration resolution_;
+    std::atomic<bool> stopped_;
+
+    // These are protected by mutex_.
+    bool started_;
+    key next_;
+    size_t cursor_;
+    std::vector<slot> slots_;
+    locations locations_;
+    deadline::ptr timer_;
+    mutable upgrade_mutex mutex_;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
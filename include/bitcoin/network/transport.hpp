@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBBITCOIN_NETWORK_TRANSPORT_HPP
+#define LIBBITCOIN_NETWORK_TRANSPORT_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/define.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+/// The effective options of a transport, zero or false where not applicable.
+struct BCT_API transport_options
+{
+    bool no_delay;
+    bool keep_alive;
+    size_t send_buffer_bytes;
+    size_t receive_buffer_bytes;
+};
+
+/// The byte stream under a proxy, thread safe.
+/// A proxy has at most one read and one write outstanding at a time. Each
+/// completes upon transfer of its bytes or with an error, and is invoked on
+/// a thread of the pool, as is an asio socket operation.
+class BCT_API transport
+  : noncopyable
+{
+public:
+    typedef std::shared_ptr<transport> ptr;
+    typedef std::function<void(const boost_code&, size_t)> io_handler;
+    typedef std::vector<boost::asio::const_buffer> const_buffers;
+
+    virtual ~transport() {}
+
+    /// The authority of the far end of the transport.
+    virtual config::authority authority() const = 0;
+
+    /// The effective options of the transport, none by default.
+    virtual transport_options options() const
+    {
+        return { false, false, 0, 0 };
+    }
+
+    /// Read exactly the size of the buffer.
+    virtual void read(const boost::asio::mutable_buffer& buffer,
+        io_handler handler) = 0;
+
+    /// Read at least one byte, up to the size of the buffer.
+    virtual void read_some(const boost::asio::mutable_buffer& buffer,
+        io_handler handler) = 0;
+
+    /// Write all of the buffers, in order.
+    virtual void write(const const_buffers& buffers, io_handler handler) = 0;
+
+    /// Cancel outstanding operations and close the transport.
+    virtual void stop() = 0;
+};
+
+} // namespace network
+} // namespace libbitcoin
+
+#endif
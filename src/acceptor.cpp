@@ -23,9 +23,12 @@
 #include <iostream>
 #include <memory>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/channel_cache.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/socket_transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -36,10 +39,27 @@ using namespace std::placeholders;
 
 static const auto reuse_address = asio::acceptor::reuse_address(true);
 
-acceptor::acceptor(threadpool& pool, const settings& settings)
+acceptor::acceptor(threadpool& pool, const settings& settings,
+    buffer_pool::ptr buffers, channel_cache::ptr allocations,
+    timer_wheel::ptr timers)
+  : acceptor(pool, settings, buffers, allocations, timers,
+    [&pool]() -> threadpool&
+    {
+        return pool;
+    })
+{
+}
+
+acceptor::acceptor(threadpool& pool, const settings& settings,
+    buffer_pool::ptr buffers, channel_cache::ptr allocations,
+    timer_wheel::ptr timers, pool_selector select)
   : stopped_(true),
     pool_(pool),
     settings_(settings),
+    buffers_(buffers),
+    allocations_(allocations),
+    timers_(timers),
+    select_(select),
     dispatch_(pool, NAME),
     acceptor_(pool_.service()),
     CONSTRUCT_TRACK(acceptor)
@@ -105,11 +125,15 @@ code acceptor::listen(uint16_t )
     if (!error)
         acceptor_.set_option(reuse_address, error);
 
+    // Accepted sockets inherit the buffer sizes of the listener.
+    if (!error)
+        socket_transport::configure(acceptor_, settings_);
+
     if (!error)
         acceptor_.bind(endpoint, error);
 
     if (!error)
-        acceptor_.listen(asio::max_connections, error);
+        acceptor_.listen(settings_.listen_backlog(), error);
 
     stopped_ = false;
 
@@ -119,7 +143,18 @@ code acceptor::listen(uint16_t )
     return error::boost_to_error_code(error);
 }
 
+// Admit all connections.
+static code admit_all(const config::authority&)
+{
+    return error::success;
+}
+
 void acceptor::accept(accept_handler handler)
+{
+    accept(admit_all, handler);
+}
+
+void acceptor::accept(admission_handler admit, accept_handler handler)
 {
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
@@ -133,7 +168,9 @@ void acceptor::accept(accept_handler handler)
         return;
     }
 
-    const auto socket = std::make_shared<bc::socket>(pool_);
+    // The socket is created on the pool of the channel that it becomes.
+    auto& pool = select_();
+    const auto socket = std::make_shared<bc::socket>(pool);
 
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -144,7 +181,7 @@ void acceptor::accept(accept_handler handler)
     // to the thread of the socket, then this is unnecessary.
     acceptor_.async_accept(socket->get(),
         std::bind(&acceptor::handle_accept,
-            shared_from_this(), _1, socket, handler));
+            shared_from_this(), _1, socket, std::ref(pool), admit, handler));
 
     mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
@@ -152,7 +189,7 @@ void acceptor::accept(accept_handler handler)
 
 // private:
 void acceptor::handle_accept(const boost_code& ec, socket::ptr socket,
-    accept_handler handler)
+    threadpool& pool, admission_handler admit, accept_handler handler)
 {
     if (ec)
     {
@@ -160,8 +197,25 @@ void acceptor::handle_accept(const boost_code& ec, socket::ptr socket,
         return;
     }
 
+    // The peer may have disconnected, in which case there is no endpoint.
+    boost_code error;
+    const auto endpoint = socket->get().remote_endpoint(error);
+    const auto admitted = error ? error::boost_to_error_code(error) :
+        admit(config::authority(endpoint));
+
+    // Close a rejected socket before incurring the cost of a channel.
+    if (admitted)
+    {
+        socket->stop();
+        handler(admitted, nullptr);
+        return;
+    }
+
+    socket_transport::configure(*socket, settings_);
+
     // Ensure that channel is not passed as an r-value.
-    const auto created = std::make_shared<channel>(pool_, socket, settings_);
+    const auto created = allocations_->create(pool, socket, settings_,
+        buffers_, timers_);
     handler(error::success, created);
 }
 
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/anchors.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace std::chrono;
+
+anchors::anchors(const boost::filesystem::path& file_path)
+  : file_path_(file_path)
+{
+}
+
+anchors::list anchors::load() const
+{
+    list out;
+
+    if (file_path_.empty())
+        return out;
+
+    {
+        bc::ifstream file(file_path_.string(), std::ios::in);
+
+        if (!file.good())
+            return out;
+
+        std::string line;
+
+        while (std::getline(file, line))
+        {
+            std::string host;
+            uint32_t version;
+            int64_t round_trip;
+            std::istringstream fields(line);
+
+            if (!(fields >> host >> version >> round_trip))
+                continue;
+
+            // An invalid authority throws, and is skipped as a corrupt line.
+            try
+            {
+                out.push_back({ config::authority(host), version,
+                    microseconds(round_trip) });
+            }
+            catch (const std::exception&)
+            {
+            }
+        }
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(file_path_, ec);
+    return out;
+}
+
+// Write to a temporary file and rename, so that failure preserves the file.
+bool anchors::save(const list& values) const
+{
+    if (file_path_.empty())
+        return true;
+
+    boost::system::error_code ec;
+
+    if (values.empty())
+    {
+        boost::filesystem::remove(file_path_, ec);
+        return !ec;
+    }
+
+    auto temporary = file_path_;
+    temporary += ".tmp";
+
+    {
+        bc::ofstream file(temporary.string(), std::ios::out | std::ios::trunc);
+
+        if (file.bad())
+            return false;
+
+        for (const auto& value: values)
+            file << value.authority << " " << value.version << " "
+                << duration_cast<microseconds>(value.round_trip).count()
+                << std::endl;
+
+        file.flush();
+
+        if (!file.good())
+            return false;
+    }
+
+    boost::filesystem::rename(temporary, file_path_, ec);
+    return !ec;
+}
+
+} // namespace network
+} // namespace libbitcoin
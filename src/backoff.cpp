@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/backoff.hpp>
+
+#include <algorithm>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+backoff::backoff(const asio::duration& initial,
+    const asio::duration& maximum)
+  : initial_(std::min(initial, maximum)),
+    maximum_(maximum),
+    current_(initial_)
+{
+}
+
+asio::duration backoff::next()
+{
+    asio::duration base;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    base = current_;
+    current_ = std::min(current_ + current_, maximum_);
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return base == asio::duration::zero() ? base :
+        pseudo_random::duration(base);
+}
+
+void backoff::reset()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    current_ = initial_;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace network
+} // namespace libbitcoin
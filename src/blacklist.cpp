@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/blacklist.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/subnet.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+static inline uint8_t bit_at(const asio::ipv6::bytes_type& bytes,
+    size_t index)
+{
+    return (bytes[index / 8] >> (7 - index % 8)) & 1;
+}
+
+blacklist::blacklist(const subnet::list& subnets)
+  : nodes_(build(subnets))
+{
+}
+
+bool blacklist::contains(const config::authority& authority) const
+{
+    return contains(authority.ip());
+}
+
+bool blacklist::contains(const asio::ipv6& ip) const
+{
+    const auto bytes = ip.to_bytes();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    auto current = &nodes_.front();
+
+    for (size_t index = 0; !current->terminal; ++index)
+    {
+        if (index == bytes.size() * 8)
+            return false;
+
+        const auto child = current->children[bit_at(bytes, index)];
+
+        if (child == 0)
+            return false;
+
+        current = &nodes_[child];
+    }
+
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void blacklist::load(const subnet::list& subnets)
+{
+    // Build outside of the lock, so that lookups are not held up.
+    auto replacement = build(subnets);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+    nodes_.swap(replacement);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+blacklist::nodes blacklist::build(const subnet::list& subnets)
+{
+    nodes trie{ node{ { 0, 0 }, false } };
+
+    for (const auto& range: subnets)
+    {
+        const auto bytes = range.ip().to_bytes();
+        size_t current = 0;
+
+        // A range within a blocked range is redundant.
+        for (size_t index = 0; index < range.prefix() &&
+            !trie[current].terminal; ++index)
+        {
+            const auto bit = bit_at(bytes, index);
+
+            if (trie[current].children[bit] == 0)
+            {
+                trie[current].children[bit] =
+                    static_cast<uint32_t>(trie.size());
+                trie.push_back(node{ { 0, 0 }, false });
+            }
+
+            current = trie[current].children[bit];
+        }
+
+        // Descendants are now unreachable by lookup, though retained.
+        trie[current].terminal = true;
+    }
+
+    return trie;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/block_download.hpp>
+
+#include <cstddef>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+block_download::block_download(size_t first_height, size_t buffer,
+    block_handler handler)
+  : buffer_(buffer),
+    handler_(handler),
+    next_height_(first_height)
+{
+}
+
+void block_download::enqueue(const hash_digest& hash, size_t height)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (height >= next_height_)
+        queued_.emplace(height, hash);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void block_download::claim(size_t count, items& out_items)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto limit = ceiling_add(next_height_, buffer_);
+    auto it = queued_.begin();
+
+    while (it != queued_.end() && out_items.size() < count &&
+        it->first < limit)
+    {
+        claimed_.emplace(it->second, it->first);
+        out_items.emplace_back(it->first, it->second);
+        it = queued_.erase(it);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void block_download::release(const items& claimed)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (const auto& item: claimed)
+        if (claimed_.erase(item.second) != 0)
+            queued_.emplace(item.first, item.second);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+code block_download::accept(block_const_ptr block, result_handler rejected)
+{
+    const auto hash = block->header().hash();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    const auto it = claimed_.find(hash);
+
+    if (it == claimed_.end())
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return error::not_found;
+    }
+
+    received_.emplace(it->second, supplied{ block, rejected });
+    claimed_.erase(it);
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    deliver();
+    return error::success;
+}
+
+bool block_download::complete() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return queued_.empty() && claimed_.empty() && received_.empty();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t block_download::next_height() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return next_height_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// The handler is invoked under the delivery lock only, so that delivery is in
+// order without blocking claims and accepts of other channels. The height is
+// advanced only once its block is accepted by the handler, a rejected block
+// is queued again for another channel and its supplier notified.
+void block_download::deliver()
+{
+    code ec;
+    result_handler rejected;
+
+    {
+        unique_lock delivery(delivery_mutex_);
+
+        while (true)
+        {
+            size_t height;
+            block_const_ptr block;
+
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            mutex_.lock();
+
+            const auto it = received_.find(next_height_);
+
+            if (it == received_.end())
+            {
+                mutex_.unlock();
+                //-------------------------------------------------------------
+                return;
+            }
+
+            height = it->first;
+            block = it->second.first;
+            rejected = it->second.second;
+            mutex_.unlock();
+            ///////////////////////////////////////////////////////////////////
+
+            ec = handler_(height, block);
+
+            // Critical Section
+            ///////////////////////////////////////////////////////////////////
+            mutex_.lock();
+
+            received_.erase(height);
+
+            if (ec)
+                queued_.emplace(height, block->header().hash());
+            else
+                ++next_height_;
+
+            mutex_.unlock();
+            ///////////////////////////////////////////////////////////////////
+
+            if (ec)
+                break;
+        }
+    }
+
+    // The supplier is notified outside of the delivery lock, as stopping its
+    // channel releases its other claims.
+    if (rejected)
+        rejected(ec);
+}
+
+} // namespace network
+} // namespace libbitcoin
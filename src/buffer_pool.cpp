@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/buffer_pool.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/message_subscriber.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+// The smallest size class is 1k, which covers nearly all control messages.
+static const size_t minimum_class_bits = 10;
+static const size_t minimum_class_size = size_t(1) << minimum_class_bits;
+
+buffer_pool::buffer_pool(size_t capacity)
+  : capacity_(capacity),
+    hits_(0),
+    misses_(0),
+    retained_(0)
+{
+}
+
+// private
+// Obtain the number of bits in the power of two class that covers size.
+size_t buffer_pool::size_class(size_t size)
+{
+    auto bits = minimum_class_bits;
+
+    while ((size_t(1) << bits) < size)
+        ++bits;
+
+    return bits;
+}
+
+size_t buffer_pool::retained() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return retained_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t buffer_pool::hits() const
+{
+    return hits_;
+}
+
+size_t buffer_pool::misses() const
+{
+    return misses_;
+}
+
+payload_ptr buffer_pool::get(size_t size)
+{
+    // Retention is disabled, so allocate the buffer with its control block.
+    if (capacity_ == 0)
+    {
+        ++misses_;
+        return std::make_shared<data_chunk>(size);
+    }
+
+    const auto bits = size_class(size);
+    const auto index = bits - minimum_class_bits;
+    buffer chunk;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(mutex_);
+
+        if (index < classes_.size() && !classes_[index].empty())
+        {
+            chunk = std::move(classes_[index].back());
+            classes_[index].pop_back();
+            retained_ -= chunk->capacity();
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (chunk)
+    {
+        ++hits_;
+    }
+    else
+    {
+        ++misses_;
+        chunk.reset(new data_chunk);
+        chunk->reserve(size_t(1) << bits);
+    }
+
+    // This does not cause a reallocation.
+    chunk->resize(size);
+
+    // The buffer is returned to the pool upon release of the last reference.
+    // The pool may be destroyed before the buffer, in which case it is freed.
+    const std::weak_ptr<buffer_pool> pool = shared_from_this();
+    const auto release = [pool](data_chunk* released)
+    {
+        const auto self = pool.lock();
+
+        if (self)
+            self->put(released);
+        else
+            delete released;
+    };
+
+    return payload_ptr(chunk.release(), release);
+}
+
+// private
+void buffer_pool::put(data_chunk* chunk)
+{
+    // This is deleted upon return unless transferred to the pool.
+    buffer owned(chunk);
+    const auto size = owned->capacity();
+
+    // A buffer may have been emptied or regrown by a payload subscriber.
+    if (size < minimum_class_size || (size & (size - 1)) != 0)
+        return;
+
+    const auto index = size_class(size) - minimum_class_bits;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (ceiling_add(retained_, size) > capacity_)
+        return;
+
+    if (index >= classes_.size())
+        classes_.resize(index + 1);
+
+    retained_ += size;
+    classes_[index].push_back(std::move(owned));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -18,15 +18,21 @@
  */
 #include <bitcoin/network/channel.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/socket_transport.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -34,19 +40,45 @@ namespace network {
 using namespace bc::message;
 using namespace std::placeholders;
 
-// Factory for deadline timer pointer construction.
-static deadline::ptr alarm(threadpool& pool, const asio::duration& duration)
+using namespace std::chrono;
+
+// Each sample moves the smoothed round trip by this fraction of the error.
+static const int64_t round_trip_smoothing = 8;
+
+static int64_t to_microseconds(const asio::duration& value)
+{
+    return duration_cast<microseconds>(value).count();
+}
+
+// The steady time, by which inactivity is measured.
+static int64_t now()
 {
-    return std::make_shared<deadline>(pool, pseudo_random::duration(duration));
+    return to_microseconds(steady_clock::now().time_since_epoch());
 }
 
 channel::channel(threadpool& pool, socket::ptr socket,
-    const settings& settings)
-  : proxy(pool, socket, settings),
+    const settings& settings, buffer_pool::ptr buffers,
+    timer_wheel::ptr timers)
+  : channel(pool, std::make_shared<socket_transport>(socket), settings,
+        buffers, timers)
+{
+}
+
+channel::channel(threadpool& pool, transport::ptr transport,
+    const settings& settings, buffer_pool::ptr buffers,
+    timer_wheel::ptr timers)
+  : proxy(pool, transport, settings, buffers),
     notify_(false),
     nonce_(0),
-    expiration_(alarm(pool, settings.channel_expiration())),
-    inactivity_(alarm(pool, settings.channel_inactivity())),
+    round_trip_(0),
+    minimum_round_trip_(0),
+    last_activity_(now()),
+    last_useful_(last_activity_.load()),
+    expiration_timer_(0),
+    inactivity_timer_(0),
+    expiration_(pseudo_random::duration(settings.channel_expiration())),
+    inactivity_(pseudo_random::duration(settings.channel_inactivity())),
+    timers_(timers),
     CONSTRUCT_TRACK(channel)
 {
 }
@@ -65,8 +97,9 @@ void channel::start(result_handler handler)
 // Don't start the timers until the socket is enabled.
 void channel::do_start(const code& , result_handler handler)
 {
+    signal_activity();
     start_expiration();
-    start_inactivity();
+    start_inactivity(inactivity_);
     handler(error::success);
 }
 
@@ -93,6 +126,51 @@ void channel::set_nonce(uint64_t value)
     nonce_.store(value);
 }
 
+// The smoothing is that of the tcp round trip estimator (rfc6298).
+// Samples are recorded by the ping protocol, one at a time.
+void channel::record_round_trip(const asio::duration& value)
+{
+    const auto sample = std::max(to_microseconds(value), int64_t(1));
+    const auto smoothed = round_trip_.load();
+    const auto minimum = minimum_round_trip_.load();
+
+    round_trip_ = smoothed == 0 ? sample :
+        smoothed + (sample - smoothed) / round_trip_smoothing;
+
+    if (minimum == 0 || sample < minimum)
+        minimum_round_trip_ = sample;
+}
+
+asio::duration channel::round_trip() const
+{
+    return microseconds(round_trip_.load());
+}
+
+asio::duration channel::minimum_round_trip() const
+{
+    return microseconds(minimum_round_trip_.load());
+}
+
+asio::duration channel::latency_score() const
+{
+    const auto smoothed = round_trip_.load();
+    return smoothed == 0 ? asio::duration::max() : microseconds(smoothed);
+}
+
+asio::duration channel::useful_idle() const
+{
+    return microseconds(now() - last_useful_.load(std::memory_order_relaxed));
+}
+
+channel_statistics channel::statistics() const
+{
+    auto out = proxy::statistics();
+    out.nonce = nonce_;
+    out.round_trip = microseconds(round_trip_.load());
+    out.minimum_round_trip = microseconds(minimum_round_trip_.load());
+    return out;
+}
+
 version_const_ptr channel::peer_version() const
 {
     const auto version = peer_version_.load();
@@ -111,13 +189,20 @@ void channel::set_peer_version(version_const_ptr value)
 // It is possible that this may be called multiple times.
 void channel::handle_stopping()
 {
-    expiration_->stop();
-    inactivity_->stop();
+    timers_->cancel(expiration_timer_.exchange(0));
+    timers_->cancel(inactivity_timer_.exchange(0));
 }
 
+// This is invoked for every message received, so it only records the time.
 void channel::signal_activity()
 {
-    start_inactivity();
+    last_activity_.store(now(), std::memory_order_relaxed);
+}
+
+// This is invoked for each received message that relays data.
+void channel::signal_useful()
+{
+    last_useful_.store(now(), std::memory_order_relaxed);
 }
 
 bool channel::stopped(const code& ec) const
@@ -134,9 +219,9 @@ void channel::start_expiration()
     if (proxy::stopped())
         return;
 
-    expiration_->start(
-        std::bind(&channel::handle_expiration,
-            shared_from_base<channel>(), _1));
+    set_timer(expiration_timer_, timers_->schedule(thread_pool(),
+        expiration_, std::bind(&channel::handle_expiration,
+            shared_from_base<channel>(), _1)));
 }
 
 void channel::handle_expiration(const code& ec)
@@ -150,14 +235,14 @@ void channel::handle_expiration(const code& ec)
     stop(error::channel_timeout);
 }
 
-void channel::start_inactivity()
+void channel::start_inactivity(const asio::duration& delay)
 {
     if (proxy::stopped())
         return;
 
-    inactivity_->start(
-        std::bind(&channel::handle_inactivity,
-            shared_from_base<channel>(), _1));
+    set_timer(inactivity_timer_, timers_->schedule(thread_pool(),
+        delay, std::bind(&channel::handle_inactivity,
+            shared_from_base<channel>(), _1)));
 }
 
 void channel::handle_inactivity(const code& ec)
@@ -165,11 +250,32 @@ void channel::handle_inactivity(const code& ec)
     if (stopped(ec))
         return;
 
+    const auto last = last_activity_.load(std::memory_order_relaxed);
+    const auto idle = microseconds(now() - last);
+
+    // There was activity since the timer was set, so wait out the remainder.
+    if (idle < inactivity_)
+    {
+        start_inactivity(inactivity_ - idle);
+        return;
+    }
+
     LOG_DEBUG(LOG_NETWORK)
         << "Channel inactivity timeout [" << authority() << "]";
 
     stop(error::channel_timeout);
 }
 
+// A timer set concurrently with stopping is canceled here, as the stop
+// handler may have already run and would otherwise leave it scheduled.
+void channel::set_timer(std::atomic<timer_wheel::key>& timer,
+    timer_wheel::key value)
+{
+    timer.store(value);
+
+    if (proxy::stopped())
+        timers_->cancel(timer.exchange(0));
+}
+
 } // namespace network
 } // namespace libbitcoin
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/channel_cache.hpp>
+
+#include <cstddef>
+#include <new>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+channel_cache::channel_cache(size_t limit)
+  : limit_(limit),
+    hits_(0),
+    misses_(0),
+    block_size_(0)
+{
+}
+
+// Blocks in use are freed by their allocators once the cache is gone.
+channel_cache::~channel_cache()
+{
+    for (const auto block: blocks_)
+        ::operator delete(block);
+}
+
+size_t channel_cache::retained() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return blocks_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+size_t channel_cache::hits() const
+{
+    return hits_;
+}
+
+size_t channel_cache::misses() const
+{
+    return misses_;
+}
+
+// private
+void* channel_cache::get(size_t size)
+{
+    void* block = nullptr;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (size == block_size_ && !blocks_.empty())
+    {
+        block = blocks_.back();
+        blocks_.pop_back();
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (block != nullptr)
+    {
+        ++hits_;
+        return block;
+    }
+
+    ++misses_;
+    return ::operator new(size);
+}
+
+// private
+// All channels share one block size, which is taken from the first return.
+void channel_cache::put(void* block, size_t size)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (block_size_ == 0)
+        block_size_ = size;
+
+    if (size == block_size_ && blocks_.size() < limit_)
+    {
+        blocks_.push_back(block);
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    ::operator delete(block);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/channel_metrics.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace message;
+using namespace std::chrono;
+
+typedef std::unordered_map<std::string, message_type> command_map;
+
+// The message types by command, for attributing sent payloads.
+static const command_map& command_types()
+{
+    static const command_map types
+    {
+        { address::command, message_type::address },
+        { alert::command, message_type::alert },
+        { block::command, message_type::block },
+        { block_transactions::command, message_type::block_transactions },
+        { compact_block::command, message_type::compact_block },
+        { fee_filter::command, message_type::fee_filter },
+        { filter_add::command, message_type::filter_add },
+        { filter_clear::command, message_type::filter_clear },
+        { filter_load::command, message_type::filter_load },
+        { get_address::command, message_type::get_address },
+        { get_blocks::command, message_type::get_blocks },
+        { get_block_transactions::command,
+            message_type::get_block_transactions },
+        { get_data::command, message_type::get_data },
+        { get_headers::command, message_type::get_headers },
+        { headers::command, message_type::headers },
+        { inventory::command, message_type::inventory },
+        { memory_pool::command, message_type::memory_pool },
+        { merkle_block::command, message_type::merkle_block },
+        { not_found::command, message_type::not_found },
+        { ping::command, message_type::ping },
+        { pong::command, message_type::pong },
+        { reject::command, message_type::reject },
+        { send_compact::command, message_type::send_compact },
+        { send_headers::command, message_type::send_headers },
+        { transaction::command, message_type::transaction },
+        { verack::command, message_type::verack },
+        { version::command, message_type::version }
+    };
+
+    return types;
+}
+
+// The counters span each known type and unknown.
+static size_t type_count()
+{
+    auto size = static_cast<size_t>(message_type::unknown) + 1;
+
+    for (const auto& entry: command_types())
+        size = std::max(size, static_cast<size_t>(entry.second) + 1);
+
+    return size;
+}
+
+static uint64_t to_microseconds(channel_metrics::clock::duration elapsed)
+{
+    const auto count = duration_cast<microseconds>(elapsed).count();
+    return count < 0 ? 0 : static_cast<uint64_t>(count);
+}
+
+channel_metrics::channel_metrics()
+  : types_(type_count()),
+    received_(new counter[types_]),
+    sent_(new counter[types_]),
+    last_received_(clock::now().time_since_epoch().count())
+{
+    for (size_t type = 0; type < types_; ++type)
+    {
+        received_[type].messages = 0;
+        received_[type].bytes = 0;
+        sent_[type].messages = 0;
+        sent_[type].bytes = 0;
+    }
+
+    reads_.count = 0;
+    reads_.total = 0;
+    reads_.maximum = 0;
+    writes_.count = 0;
+    writes_.total = 0;
+    writes_.maximum = 0;
+}
+
+message_type channel_metrics::to_type(const std::string& command)
+{
+    const auto& types = command_types();
+    const auto it = types.find(command);
+    return it == types.end() ? message_type::unknown : it->second;
+}
+
+std::string channel_metrics::to_command(message_type type)
+{
+    for (const auto& entry: command_types())
+        if (entry.second == type)
+            return entry.first;
+
+    return "unknown";
+}
+
+void channel_metrics::received(message_type type, size_t bytes,
+    clock::duration elapsed)
+{
+    record(received_[index(type)], bytes);
+    record(reads_, elapsed);
+    last_received_ = clock::now().time_since_epoch().count();
+}
+
+void channel_metrics::sent(message_type type, size_t bytes)
+{
+    record(sent_[index(type)], bytes);
+}
+
+void channel_metrics::written(clock::duration elapsed)
+{
+    record(writes_, elapsed);
+}
+
+void channel_metrics::copy(channel_statistics& out) const
+{
+    const auto last = clock::time_point(clock::duration(last_received_));
+
+    out.received = copy(received_.get(), types_);
+    out.sent = copy(sent_.get(), types_);
+    out.reads = copy(reads_);
+    out.writes = copy(writes_);
+    out.idle = duration_cast<milliseconds>(clock::now() - last);
+}
+
+// private
+// Unrecognized types are counted as unknown.
+size_t channel_metrics::index(message_type type) const
+{
+    const auto value = static_cast<size_t>(type);
+    return value < types_ ? value : static_cast<size_t>(message_type::unknown);
+}
+
+// private
+void channel_metrics::record(counter& traffic, size_t bytes)
+{
+    traffic.messages.fetch_add(1, std::memory_order_relaxed);
+    traffic.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// private
+void channel_metrics::record(timing& latency, clock::duration elapsed)
+{
+    const auto value = to_microseconds(elapsed);
+    latency.count.fetch_add(1, std::memory_order_relaxed);
+    latency.total.fetch_add(value, std::memory_order_relaxed);
+
+    auto maximum = latency.maximum.load(std::memory_order_relaxed);
+
+    // A failed exchange reloads the maximum, which may now exceed the value.
+    while (value > maximum && !latency.maximum.compare_exchange_weak(maximum,
+        value, std::memory_order_relaxed))
+    {
+    }
+}
+
+// private
+message_traffic::list channel_metrics::copy(const counter* traffic,
+    size_t size)
+{
+    message_traffic::list out;
+    out.reserve(size);
+
+    for (size_t type = 0; type < size; ++type)
+        out.push_back(
+        {
+            traffic[type].messages.load(std::memory_order_relaxed),
+            traffic[type].bytes.load(std::memory_order_relaxed)
+        });
+
+    return out;
+}
+
+// private
+operation_latency channel_metrics::copy(const timing& latency)
+{
+    return
+    {
+        latency.count.load(std::memory_order_relaxed),
+        microseconds(latency.total.load(std::memory_order_relaxed)),
+        microseconds(latency.maximum.load(std::memory_order_relaxed))
+    };
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,207 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/channel_registry.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <boost/functional/hash.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+// Remove the channel from a multimap range.
+template <typename Map, typename Key>
+static void erase(Map& map, const Key& key, channel::ptr channel)
+{
+    const auto range = map.equal_range(key);
+
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == channel)
+        {
+            map.erase(it);
+            return;
+        }
+    }
+}
+
+size_t channel_registry::key_hash::operator()(const key& value) const
+{
+    return boost::hash_range(value.begin(), value.end());
+}
+
+// private
+channel_registry::key channel_registry::make_key(
+    const config::authority& authority)
+{
+    key value;
+    const auto ip = authority.ip().to_bytes();
+    const auto port = authority.port();
+    std::copy(ip.begin(), ip.end(), value.begin());
+    value[ip.size()] = static_cast<uint8_t>(port >> 8);
+    value[ip.size() + 1] = static_cast<uint8_t>(port);
+    return value;
+}
+
+channel_registry::channel_registry(size_t initial_capacity)
+  : stopped_(false),
+    snapshot_(std::make_shared<const channels>())
+{
+    channels_.reserve(initial_capacity);
+    authorities_.reserve(initial_capacity);
+    nonces_.reserve(initial_capacity);
+}
+
+size_t channel_registry::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return channels_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool channel_registry::exists(const config::authority& authority) const
+{
+    const auto value = make_key(authority);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return authorities_.find(value) != authorities_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool channel_registry::exists(uint64_t version_nonce) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return nonces_.find(version_nonce) != nonces_.end();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+channel_registry::snapshot_ptr channel_registry::snapshot() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    if (snapshot_)
+    {
+        const auto current = snapshot_;
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        return current;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    // Rebuild the snapshot upon first read after a change.
+    const auto rebuilt = std::make_shared<channels>();
+    rebuilt->reserve(channels_.size());
+
+    for (const auto& entry: channels_)
+        rebuilt->push_back(entry.first);
+
+    snapshot_ = rebuilt;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return rebuilt;
+}
+
+code channel_registry::store(channel::ptr channel)
+{
+    return do_store(channel, false);
+}
+
+code channel_registry::store_unique(channel::ptr channel)
+{
+    return do_store(channel, true);
+}
+
+// private
+code channel_registry::do_store(channel::ptr channel, bool unique)
+{
+    const keys values{ make_key(channel->authority()), channel->nonce() };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    if (unique && authorities_.find(values.authority) != authorities_.end())
+        return error::address_in_use;
+
+    if (!channels_.emplace(channel, values).second)
+        return error::address_in_use;
+
+    authorities_.emplace(values.authority, channel);
+    nonces_.emplace(values.nonce, channel);
+    snapshot_.reset();
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void channel_registry::remove(channel::ptr channel)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto it = channels_.find(channel);
+
+    if (it == channels_.end())
+        return;
+
+    // The keys are retained so that removal does not depend on the channel.
+    erase(authorities_, it->second.authority, channel);
+    erase(nonces_, it->second.nonce, channel);
+    channels_.erase(it);
+    snapshot_.reset();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void channel_registry::stop(const code& ec)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    stopped_ = true;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Channels remove themselves upon stop, so stop outside of the lock.
+    for (const auto channel: *snapshot())
+        channel->stop(ec);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,355 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/checksum.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bitcoin/bitcoin.hpp>
+
+// The sha extensions are compiled by function attribute, so no build flag is
+// required, and are used only if the processor reports them at run time.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    #define SHA_NI
+    #define SHA_NI_TARGET __attribute__((target("sha,sse4.1")))
+    #include <cpuid.h>
+    #include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #define SHA_NI
+    #define SHA_NI_TARGET
+    #include <intrin.h>
+    #include <immintrin.h>
+#endif
+
+namespace libbitcoin {
+namespace network {
+
+static const size_t block_size = 64;
+static const size_t digest_size = 32;
+
+static const uint32_t initial[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t rounds[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static uint32_t rotate(uint32_t value, size_t bits)
+{
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static uint32_t load_big_endian(const uint8_t* in)
+{
+    return (static_cast<uint32_t>(in[0]) << 24) |
+        (static_cast<uint32_t>(in[1]) << 16) |
+        (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+static void store_big_endian(uint8_t* out, uint32_t value)
+{
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+// Compress the blocks into the state, one round at a time.
+static void portable_transform(uint32_t state[8], const uint8_t* data,
+    size_t blocks)
+{
+    uint32_t words[64];
+
+    for (; blocks != 0; --blocks, data += block_size)
+    {
+        for (size_t round = 0; round < 16; ++round)
+            words[round] = load_big_endian(data + 4 * round);
+
+        for (size_t round = 16; round < 64; ++round)
+        {
+            const auto early = words[round - 15];
+            const auto late = words[round - 2];
+            words[round] = words[round - 16] + words[round - 7] +
+                (rotate(early, 7) ^ rotate(early, 18) ^ (early >> 3)) +
+                (rotate(late, 17) ^ rotate(late, 19) ^ (late >> 10));
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (size_t round = 0; round < 64; ++round)
+        {
+            const auto first = h + words[round] + rounds[round] +
+                (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) +
+                ((e & f) ^ (~e & g));
+            const auto second =
+                (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) +
+                ((a & b) ^ (a & c) ^ (b & c));
+
+            h = g;
+            g = f;
+            f = e;
+            e = d + first;
+            d = c;
+            c = b;
+            b = a;
+            a = first + second;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#ifdef SHA_NI
+
+static bool sha_ni_supported()
+{
+    // Leaf 1 ecx: ssse3 (bit 9) and sse4.1 (bit 19), leaf 7 ebx: sha (bit 29).
+    static const uint32_t ssse3 = 1u << 9;
+    static const uint32_t sse41 = 1u << 19;
+    static const uint32_t sha = 1u << 29;
+
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+    const auto features = static_cast<uint32_t>(info[2]);
+    __cpuidex(info, 7, 0);
+    const auto extended = static_cast<uint32_t>(info[1]);
+#else
+    unsigned int eax, ebx, ecx, edx;
+
+    if (__get_cpuid_max(0, nullptr) < 7)
+        return false;
+
+    __cpuid(1, eax, ebx, ecx, edx);
+    const auto features = ecx;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    const auto extended = ebx;
+#endif
+
+    return (features & ssse3) != 0 && (features & sse41) != 0 &&
+        (extended & sha) != 0;
+}
+
+// Compress the blocks into the state, four rounds per step. The message
+// schedule is expanded in place, in a window of four vectors of four words.
+SHA_NI_TARGET static void accelerated_transform(uint32_t state[8],
+    const uint8_t* data, size_t blocks)
+{
+    const auto mask = _mm_set_epi64x(0x0c0d0e0f08090a0bull,
+        0x0405060700010203ull);
+
+    // Reorder the state words from abcd, efgh to abef, cdgh.
+    auto cdab = _mm_shuffle_epi32(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&state[0])), 0xb1);
+    auto cdgh = _mm_shuffle_epi32(_mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&state[4])), 0x1b);
+    auto abef = _mm_alignr_epi8(cdab, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, cdab, 0xf0);
+
+    for (; blocks != 0; --blocks, data += block_size)
+    {
+        const auto abef_save = abef;
+        const auto cdgh_save = cdgh;
+        __m128i words[4];
+
+        for (size_t step = 0; step < 16; ++step)
+        {
+            auto& current = words[step % 4];
+            auto& next = words[(step + 1) % 4];
+            auto& previous = words[(step + 3) % 4];
+
+            if (step < 4)
+                current = _mm_shuffle_epi8(_mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(data + 16 * step)),
+                    mask);
+
+            auto message = _mm_add_epi32(current, _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(&rounds[4 * step])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+
+            if (step >= 3 && step < 15)
+                next = _mm_sha256msg2_epu32(_mm_add_epi32(next,
+                    _mm_alignr_epi8(current, previous, 4)), current);
+
+            message = _mm_shuffle_epi32(message, 0x0e);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+
+            if (step >= 1 && step < 13)
+                previous = _mm_sha256msg1_epu32(previous, current);
+        }
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    }
+
+    // Restore the state words to abcd, efgh.
+    const auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    const auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]),
+        _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]),
+        _mm_alignr_epi8(dchg, feba, 8));
+}
+
+static const bool accelerated = sha_ni_supported();
+
+#else
+
+static const bool accelerated = false;
+
+#endif
+
+static void transform(uint32_t state[8], const uint8_t* data, size_t blocks)
+{
+#ifdef SHA_NI
+    if (accelerated)
+    {
+        accelerated_transform(state, data, blocks);
+        return;
+    }
+#endif
+
+    portable_transform(state, data, blocks);
+}
+
+payload_hasher::payload_hasher()
+{
+    reset();
+}
+
+void payload_hasher::reset()
+{
+    std::memcpy(state_, initial, sizeof(initial));
+    pending_size_ = 0;
+    size_ = 0;
+}
+
+// Whole blocks are hashed in place, only a partial block is copied.
+void payload_hasher::update(const uint8_t* data, size_t size)
+{
+    if (size == 0)
+        return;
+
+    size_ += size;
+
+    if (pending_size_ != 0)
+    {
+        const auto fill = std::min(block_size - pending_size_, size);
+        std::memcpy(pending_ + pending_size_, data, fill);
+        pending_size_ += fill;
+        data += fill;
+        size -= fill;
+
+        if (pending_size_ < block_size)
+            return;
+
+        transform(state_, pending_, 1);
+        pending_size_ = 0;
+    }
+
+    const auto blocks = size / block_size;
+    transform(state_, data, blocks);
+    pending_size_ = size % block_size;
+
+    if (pending_size_ != 0)
+        std::memcpy(pending_, data + blocks * block_size, pending_size_);
+}
+
+uint32_t payload_hasher::checksum()
+{
+    // The bit length is appended in the last eight bytes of the padding.
+    uint8_t tail[2 * block_size] = { 0 };
+    std::memcpy(tail, pending_, pending_size_);
+    tail[pending_size_] = 0x80;
+    const size_t padded = pending_size_ < block_size - 8 ? 1 : 2;
+    const auto end = tail + padded * block_size;
+    const auto bits = size_ * 8;
+    store_big_endian(end - 8, static_cast<uint32_t>(bits >> 32));
+    store_big_endian(end - 4, static_cast<uint32_t>(bits));
+    transform(state_, tail, padded);
+
+    // The second hash is of the digest, in one block of fixed padding.
+    uint8_t block[block_size] = { 0 };
+
+    for (size_t word = 0; word < 8; ++word)
+        store_big_endian(&block[4 * word], state_[word]);
+
+    block[digest_size] = 0x80;
+    store_big_endian(&block[block_size - 4], digest_size * 8);
+    std::memcpy(state_, initial, sizeof(initial));
+    transform(state_, block, 1);
+
+    // The checksum is the first four bytes of the second hash, little endian.
+    const auto first = state_[0];
+    reset();
+    return (first >> 24) | ((first >> 8) & 0x0000ff00) |
+        ((first << 8) & 0x00ff0000) | (first << 24);
+}
+
+uint32_t payload_checksum(const data_chunk& payload)
+{
+    if (!accelerated)
+        return bitcoin_checksum(payload);
+
+    payload_hasher hasher;
+    hasher.update(payload.data(), payload.size());
+    return hasher.checksum();
+}
+
+bool checksum_accelerated()
+{
+    return accelerated;
+}
+
+} // namespace network
+} // namespace libbitcoin
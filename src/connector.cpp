@@ -18,15 +18,22 @@
  */
 #include <bitcoin/network/connector.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/channel_cache.hpp>
+#include <bitcoin/network/dns_cache.hpp>
 #include <bitcoin/network/proxy.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/socket_transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -36,12 +43,18 @@ namespace network {
 using namespace bc::config;
 using namespace std::placeholders;
 
-connector::connector(threadpool& pool, const settings& settings)
+connector::connector(threadpool& pool, const settings& settings,
+    buffer_pool::ptr buffers, channel_cache::ptr allocations,
+    dns_cache::ptr names, timer_wheel::ptr timers)
   : stopped_(false),
     pool_(pool),
     settings_(settings),
+    buffers_(buffers),
+    allocations_(allocations),
+    names_(names),
+    timers_(timers),
     dispatch_(pool, NAME),
-    resolver_(pool.service()),
+    next_(0),
     CONSTRUCT_TRACK(connector)
 {
 }
@@ -62,12 +75,19 @@ void connector::stop(const code&)
         mutex_.unlock_upgrade_and_lock();
         //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-        // This will asynchronously invoke the handler of the pending resolve.
-        resolver_.cancel();
+        // The resolution is shared, so its handler is not awaited.
+        if (resolving_)
+        {
+            dispatch_.concurrent(resolving_, error::service_stopped, nullptr);
+            resolving_ = nullptr;
+        }
 
         if (timer_)
             timer_->stop();
 
+        // This will asynchronously invoke the handlers of pending connects.
+        release();
+
         stopped_ = true;
         //---------------------------------------------------------------------
         mutex_.unlock();
@@ -78,78 +98,200 @@ void connector::stop(const code&)
     ///////////////////////////////////////////////////////////////////////////
 }
 
+asio::duration connector::elapsed() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return std::chrono::steady_clock::now() - started_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 // private
 bool connector::stopped() const
 {
     return stopped_;
 }
 
+// private
+// Cancel all pending attempts and any further ones, call only under lock.
+void connector::release()
+{
+    if (attempt_timer_)
+        attempt_timer_->stop();
+
+    for (const auto socket: sockets_)
+        socket->stop();
+
+    sockets_.clear();
+    next_ = endpoints_.size();
+}
+
 void connector::connect(const endpoint& endpoint, connect_handler handler)
 {
     connect(endpoint.host(), endpoint.port(), handler);
 }
 
+// Connect mapped addresses over IPv4, as the host may not support IPv6.
+static asio::endpoint to_endpoint(const authority& authority)
+{
+    const auto ip = authority.ip();
+
+    if (ip.is_v4_mapped())
+        return{ asio::address(ip.to_v4()), authority.port() };
+
+    return{ asio::address(ip), authority.port() };
+}
+
+// The authority is a numeric address, so there is no need to resolve it.
 void connector::connect(const authority& authority, connect_handler handler)
 {
-    connect(authority.to_hostname(), authority.port(), handler);
+    connect(endpoints{ to_endpoint(authority) }, handler);
+}
+
+void connector::connect(const message::network_address& address,
+    connect_handler handler)
+{
+    connect(authority(address), handler);
 }
 
 void connector::connect(const std::string& hostname, uint16_t port,
     connect_handler handler)
 {
+    boost_code ec;
+    const auto ip = asio::address::from_string(hostname, ec);
+
+    // Skip resolution of a literal address.
+    if (!ec)
+    {
+        connect(endpoints{ asio::endpoint(ip, port) }, handler);
+        return;
+    }
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    mutex_.lock();
 
     if (stopped())
     {
-        mutex_.unlock_upgrade();
+        mutex_.unlock();
         //---------------------------------------------------------------------
         dispatch_.concurrent(handler, error::service_stopped, nullptr);
         return;
     }
 
-    query_ = std::make_shared<asio::query>(hostname, std::to_string(port));
+    // Allow stop to terminate the resolution wait.
+    resolving_ = synchronize(handler, 1, NAME,
+        synchronizer_terminate::on_error);
 
-    mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    const auto resolving = resolving_;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
 
-    // async_resolve will not invoke the handler within this function.
-    resolver_.async_resolve(*query_,
+    // resolve will not invoke the handler within this function.
+    names_->resolve(hostname, port,
         std::bind(&connector::handle_resolve,
-            shared_from_this(), _1, _2, handler));
+            shared_from_this(), _1, _2, resolving));
+}
+
+// private
+void connector::connect(const endpoints& endpoints, connect_handler handler)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (stopped())
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        dispatch_.concurrent(handler, error::service_stopped, nullptr);
+        return;
+    }
+
+    start(endpoints, handler);
 
     mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
-void connector::handle_resolve(const boost_code& ec, asio::iterator iterator,
-    connect_handler handler)
+// Order endpoints by alternating address families, starting with the family
+// of the first resolved endpoint, as prescribed by RFC 8305 section 4.
+static dns_cache::endpoints interleave(const dns_cache::endpoints& resolved)
 {
-    using namespace boost::asio;
+    dns_cache::endpoints first;
+    dns_cache::endpoints second;
+
+    if (resolved.empty())
+        return{};
+
+    const auto family = resolved.front().address().is_v6();
+
+    for (const auto& endpoint: resolved)
+    {
+        auto& list = endpoint.address().is_v6() == family ? first : second;
+        list.push_back(endpoint);
+    }
 
+    dns_cache::endpoints ordered;
+    ordered.reserve(first.size() + second.size());
+
+    for (size_t index = 0; index < std::max(first.size(), second.size());
+        ++index)
+    {
+        if (index < first.size())
+            ordered.push_back(first[index]);
+
+        if (index < second.size())
+            ordered.push_back(second[index]);
+    }
+
+    return ordered;
+}
+
+void connector::handle_resolve(const code& ec,
+    const dns_cache::endpoints& resolved, connect_handler handler)
+{
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_shared();
+    mutex_.lock();
 
+    // The handler has been invoked by stop.
     if (stopped())
     {
-        mutex_.unlock_shared();
+        mutex_.unlock();
         //---------------------------------------------------------------------
-        dispatch_.concurrent(handler, error::service_stopped, nullptr);
         return;
     }
 
-    if (ec)
+    resolving_ = nullptr;
+    const auto ordered = ec ? endpoints{} : interleave(resolved);
+
+    if (ordered.empty())
     {
-        mutex_.unlock_shared();
+        mutex_.unlock();
         //---------------------------------------------------------------------
         dispatch_.concurrent(handler, error::resolve_failed, nullptr);
         return;
     }
 
-    const auto socket = std::make_shared<bc::socket>(pool_);
+    start(ordered, handler);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Race connects to the endpoints, call only under lock.
+void connector::start(const endpoints& endpoints, connect_handler handler)
+{
+    endpoints_ = endpoints;
+    next_ = 0;
+    started_ = std::chrono::steady_clock::now();
     timer_ = std::make_shared<deadline>(pool_, settings_.connect_timeout());
+    attempt_timer_ = std::make_shared<deadline>(pool_,
+        settings_.connect_attempt_delay());
 
     // Manage the timer-connect race, returning upon first completion.
     const auto join_handler = synchronize(handler, 1, NAME,
@@ -158,37 +300,141 @@ void connector::handle_resolve(const boost_code& ec, asio::iterator iterator,
     // timer.async_wait will not invoke the handler within this function.
     timer_->start(
         std::bind(&connector::handle_timer,
-            shared_from_this(), _1, socket, join_handler));
+            shared_from_this(), _1, join_handler));
+
+    start_attempt(join_handler);
+}
+
+// private
+// Start a connect to the next endpoint, call only under lock.
+void connector::start_attempt(connect_handler handler)
+{
+    if (next_ >= endpoints_.size())
+        return;
+
+    boost_code ignore;
+    const auto& endpoint = endpoints_[next_++];
+    const auto socket = std::make_shared<bc::socket>(pool_);
+    sockets_.push_back(socket);
+
+    // The buffer sizes must be set before connect to apply to the window.
+    // The socket is opened here, otherwise async_connect opens it.
+    socket->get().open(endpoint.protocol(), ignore);
+    socket_transport::configure(socket->get(), settings_);
 
     // async_connect will not invoke the handler within this function.
     // The bound delegate ensures handler completion before loss of scope.
-    async_connect(socket->get(), iterator,
+    socket->get().async_connect(endpoint,
         std::bind(&connector::handle_connect,
-            shared_from_this(), _1, _2, socket, join_handler));
+            shared_from_this(), _1, socket, handler));
+
+    // Start the next attempt after a delay unless this one completes first.
+    if (next_ < endpoints_.size())
+        attempt_timer_->start(
+            std::bind(&connector::handle_attempt,
+                shared_from_this(), _1, handler));
+}
+
+// private:
+void connector::handle_attempt(const code& ec, connect_handler handler)
+{
+    // The delay was canceled by an attempt completion, timeout or stop.
+    if (ec)
+        return;
 
-    mutex_.unlock_shared();
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (!stopped())
+        start_attempt(handler);
+
+    mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
 }
 
 // private:
-void connector::handle_connect(const boost_code& ec, asio::iterator,
-    socket::ptr socket, connect_handler handler)
+void connector::handle_connect(const boost_code& ec, socket::ptr socket,
+    connect_handler handler)
 {
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    const auto it = std::find(sockets_.begin(), sockets_.end(), socket);
+
+    // The attempt was released by the winner, timeout or stop.
+    if (it == sockets_.end())
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        handler(error::operation_failed, nullptr);
+        return;
+    }
+
+    sockets_.erase(it);
+
+    if (ec)
+    {
+        // Start the next attempt without waiting out the delay.
+        if (next_ < endpoints_.size())
+        {
+            start_attempt(handler);
+            mutex_.unlock();
+            //-----------------------------------------------------------------
+            return;
+        }
+
+        // Wait on the remaining attempts.
+        if (!sockets_.empty())
+        {
+            mutex_.unlock();
+            //-----------------------------------------------------------------
+            return;
+        }
+    }
+    else
+    {
+        // The first established socket wins, cancel the rest.
+        release();
+    }
+
+    const auto timer = timer_;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
     if (ec)
     {
         handler(error::boost_to_error_code(ec), nullptr);
+        timer->stop();
         return;
     }
 
+    socket_transport::configure(*socket, settings_);
+
     // Ensure that channel is not passed as an r-value.
-    const auto created = std::make_shared<channel>(pool_, socket, settings_);
+    const auto created = allocations_->create(pool_, socket, settings_,
+        buffers_, timers_);
     handler(error::success, created);
+    timer->stop();
 }
 
 // private:
-void connector::handle_timer(const code& ec, socket::ptr ,
-    connect_handler handler)
+void connector::handle_timer(const code& ec, connect_handler handler)
 {
+    if (!ec)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        mutex_.lock();
+
+        // Cancel all pending attempts of the expired connect.
+        release();
+
+        mutex_.unlock();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
     handler(ec ? ec : error::channel_timeout, nullptr);
 }
 
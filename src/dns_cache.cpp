@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/dns_cache.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/settings.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "dns_cache"
+
+using namespace std::placeholders;
+
+static std::string to_key(const std::string& hostname, uint16_t port)
+{
+    return hostname + ":" + std::to_string(port);
+}
+
+dns_cache::dns_cache(threadpool& pool, const settings& settings)
+  : pool_(pool),
+    positive_(settings.dns_ttl()),
+    negative_(settings.dns_negative_ttl()),
+    dispatch_(pool, NAME)
+{
+}
+
+void dns_cache::resolve(const std::string& hostname, uint16_t port,
+    resolve_handler handler)
+{
+    const auto key = to_key(hostname, port);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_upgrade();
+
+    const auto it = entries_.find(key);
+
+    if (it != entries_.end() && fresh(it->second))
+    {
+        const auto ec = it->second.ec;
+        const auto resolved = it->second.resolved;
+        mutex_.unlock_upgrade();
+        //---------------------------------------------------------------------
+        dispatch_.concurrent(handler, ec, resolved);
+        return;
+    }
+
+    mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    auto& entry = entries_[key];
+
+    // Start a refresh unless one is already pending.
+    if (!entry.resolver)
+        refresh(hostname, port, entry);
+
+    // Serve a stale resolution while it is refreshed in the background.
+    if (!entry.ec && !entry.resolved.empty())
+    {
+        const auto resolved = entry.resolved;
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        dispatch_.concurrent(handler, error::success, resolved);
+        return;
+    }
+
+    entry.waiting.push_back(handler);
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void dns_cache::stop()
+{
+    entries canceled;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    canceled.swap(entries_);
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto& pair: canceled)
+    {
+        const auto& entry = pair.second;
+
+        if (entry.resolver)
+            entry.resolver->cancel();
+
+        for (const auto handler: entry.waiting)
+            handler(error::service_stopped, {});
+    }
+}
+
+// private
+bool dns_cache::fresh(const entry& entry) const
+{
+    return clock::now() < entry.expiration;
+}
+
+// private
+// Start name resolution for the entry, call only under exclusive lock.
+void dns_cache::refresh(const std::string& hostname, uint16_t port,
+    entry& entry)
+{
+    const auto key = to_key(hostname, port);
+    const asio::query query(hostname, std::to_string(port));
+    entry.resolver = std::make_shared<asio::resolver>(pool_.service());
+
+    // async_resolve will not invoke the handler within this function.
+    entry.resolver->async_resolve(query,
+        std::bind(&dns_cache::handle_resolve,
+            shared_from_this(), _1, _2, key, entry.resolver));
+}
+
+void dns_cache::handle_resolve(const boost_code& ec, asio::iterator iterator,
+    const std::string& key, resolver_ptr resolver)
+{
+    handlers waiting;
+    code result;
+    endpoints resolved;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    const auto it = entries_.find(key);
+
+    // The entry was dropped by stop, which has invoked its handlers.
+    if (it == entries_.end() || it->second.resolver != resolver)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    auto& entry = it->second;
+    entry.resolver.reset();
+    waiting.swap(entry.waiting);
+
+    if (ec)
+    {
+        // A stale resolution is retained, but a refresh is retried sooner.
+        if (entry.resolved.empty())
+            entry.ec = error::resolve_failed;
+
+        entry.expiration = clock::now() + negative_;
+    }
+    else
+    {
+        const asio::iterator end;
+        for (; iterator != end; ++iterator)
+            resolved.push_back(iterator->endpoint());
+
+        entry.ec = resolved.empty() ? error::resolve_failed : error::success;
+        entry.resolved = resolved;
+        entry.expiration = clock::now() + (entry.ec ? negative_ : positive_);
+    }
+
+    result = entry.ec;
+    resolved = entry.resolved;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto handler: waiting)
+        handler(result, resolved);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,201 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/header_sync.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::config;
+using namespace bc::message;
+
+header_sync::header_sync(const checkpoint& start,
+    const checkpoint::list& checkpoints, store_handler store)
+  : store_(store)
+{
+    auto sorted = checkpoints;
+    std::sort(sorted.begin(), sorted.end(),
+        [](const checkpoint& left, const checkpoint& right)
+        {
+            return left.height() < right.height();
+        });
+
+    auto last = start;
+
+    for (const auto& stop: sorted)
+    {
+        if (stop.height() <= last.height())
+            continue;
+
+        ranges_.push_back({ last, stop, false, false, false });
+        last = stop;
+    }
+
+    ranges_.push_back({ last, { null_hash, 0 }, true, false, false });
+}
+
+bool header_sync::assign(size_t& out_range)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (size_t index = 0; index < ranges_.size(); ++index)
+    {
+        auto& range = ranges_[index];
+
+        if (!range.assigned && !range.complete)
+        {
+            range.assigned = true;
+            out_range = index;
+            return true;
+        }
+    }
+
+    return false;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void header_sync::release(size_t range)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    BITCOIN_ASSERT(range < ranges_.size());
+    ranges_[range].assigned = false;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+get_headers header_sync::request(size_t range) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    BITCOIN_ASSERT(range < ranges_.size());
+    const auto& slot = ranges_[range];
+    const auto stop = slot.open ? null_hash : slot.stop.hash();
+    return get_headers({ slot.last.hash() }, stop);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+hash_digest header_sync::stop_hash(size_t range) const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    BITCOIN_ASSERT(range < ranges_.size());
+    const auto& slot = ranges_[range];
+    return slot.open ? null_hash : slot.stop.hash();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The range is assigned to the caller, so it is not modified meanwhile.
+code header_sync::accept(size_t range, const headers& response,
+    bool& complete)
+{
+    complete = false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+    BITCOIN_ASSERT(range < ranges_.size());
+    const auto slot = ranges_[range];
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto& elements = response.elements();
+    auto previous = slot.last.hash();
+    auto height = slot.last.height();
+
+    // A peer without the headers of a closed range cannot serve it.
+    if (elements.empty() && !slot.open)
+        return error::not_found;
+
+    for (const auto& header: elements)
+    {
+        if (header.previous_block_hash() != previous)
+            return error::bad_stream;
+
+        previous = header.hash();
+        ++height;
+
+        if (!slot.open && height >= slot.stop.height() &&
+            (height > slot.stop.height() || previous != slot.stop.hash()))
+            return error::checkpoints_failed;
+    }
+
+    if (!elements.empty())
+    {
+        const auto ec = store_(slot.last.height() + 1, elements);
+
+        if (ec)
+            return ec;
+    }
+
+    complete = slot.open ? elements.size() < max_get_headers :
+        height == slot.stop.height();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    auto& stored = ranges_[range];
+    stored.last = { previous, height };
+    stored.complete = complete;
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool header_sync::complete() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return std::all_of(ranges_.begin(), ranges_.end(),
+        [](const range& slot)
+        {
+            return slot.complete;
+        });
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The start of each range is linked to the start if all before it are full.
+checkpoint header_sync::top() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    for (const auto& slot: ranges_)
+        if (!slot.complete)
+            return slot.last;
+
+    return ranges_.back().last;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -20,8 +20,16 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <sstream>
 #include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/settings.hpp>
 
@@ -29,38 +37,387 @@ namespace libbitcoin {
 namespace network {
 
 using namespace bc::config;
+using namespace bc::message;
 
 #define NAME "hosts"
 
-// TODO: change to network_address bimap hash table with services and age.
+// Binary file header: magic, version, record count, records checksum and
+// (from version 2) the number of leading records that are tried addresses.
+static const uint32_t file_magic = 0x74736f68;
+static const uint32_t file_version = 2;
+static const size_t header_size = 5 * sizeof(uint32_t);
+static const size_t header_size_v1 = 4 * sizeof(uint32_t);
+
+// Records are wire network_address serializations including the timestamp.
+static const uint32_t record_version = version::level::minimum;
+static const size_t record_size = sizeof(uint32_t) + sizeof(uint64_t) +
+    sizeof(message::ip_address) + sizeof(uint16_t);
+
+// A quarter of each shard is reserved for addresses that have connected.
+static const size_t tried_divisor = 4;
+
+// Fetch selects a tried address three of four times when both exist.
+static const uint64_t tried_odds = 3;
+
+// A tried address is demoted to new after this many consecutive failures.
+static const size_t tried_failure_limit = 3;
+
+// A new address is removed after this many consecutive failures, so that a
+// brief loss of connectivity does not empty the new table.
+static const size_t new_failure_limit = 3;
+
+// Timestamps are in seconds, as on the wire.
+static const uint32_t hour = 60 * 60;
+
+// A timestamp that is absent or in the future beyond the limit is replaced
+// with an age of five days, as it cannot be credited.
+static const uint32_t future_limit = 10 * 60;
+static const uint32_t unknown_age = 5 * 24 * hour;
+
+// Each failed connection to an address ages it by this period.
+static const uint32_t failure_age = 2 * hour;
+
+// A stored address is refreshed by a report newer by at least this period.
+static const uint32_t refresh_interval = hour;
+
+// Eviction and fetch compare this many random entries by timestamp.
+static const size_t eviction_samples = 4;
+static const size_t fetch_samples = 2;
+
+static uint32_t now()
+{
+    return static_cast<uint32_t>(zulu_time());
+}
+
 hosts::hosts(const settings& settings)
   : capacity_(static_cast<size_t>(settings.host_pool_capacity)),
-    buffer_(std::max(capacity_, static_cast<size_t>(1u))),
+    shards_(make_shards(capacity_, settings.host_pool_shards)),
     stopped_(true),
-    file_path_(settings.hosts_file),
-    disabled_(capacity_ == 0)
+    disabled_(capacity_ == 0),
+    verbose_(settings.verbose),
+    file_path_(settings.hosts_file)
+{
+}
+
+// Table.
+// ----------------------------------------------------------------------------
+
+hosts::table::table(size_t capacity)
+  : buffer_(std::max(capacity, static_cast<size_t>(1u))),
+    base_(0)
+{
+}
+
+size_t hosts::table::size() const
+{
+    return buffer_.size();
+}
+
+bool hosts::table::full() const
+{
+    return buffer_.full();
+}
+
+// The oldest entry is the first candidate, so it is evicted on ties.
+const hosts::address& hosts::table::stalest() const
+{
+    auto victim = buffer_.begin();
+
+    for (size_t sample = 1; sample < eviction_samples; ++sample)
+    {
+        const auto random = pseudo_random::next(0, buffer_.size() - 1);
+        const auto candidate = buffer_.begin() + static_cast<size_t>(random);
+
+        if (candidate->timestamp() < victim->timestamp())
+            victim = candidate;
+    }
+
+    return *victim;
+}
+
+const hosts::address& hosts::table::freshest() const
+{
+    const auto last = buffer_.size() - 1;
+    auto chosen = buffer_.begin() +
+        static_cast<size_t>(pseudo_random::next(0, last));
+
+    for (size_t sample = 1; sample < fetch_samples; ++sample)
+    {
+        const auto random = pseudo_random::next(0, last);
+        const auto candidate = buffer_.begin() + static_cast<size_t>(random);
+
+        if (candidate->timestamp() > chosen->timestamp())
+            chosen = candidate;
+    }
+
+    return *chosen;
+}
+
+bool hosts::table::exists(const address& host) const
+{
+    return index_.find(make_key(host)) != index_.end();
+}
+
+hosts::address* hosts::table::find(const address& host)
+{
+    const auto it = index_.find(make_key(host));
+    return it == index_.end() ? nullptr : &buffer_[it->second - base_];
+}
+
+const hosts::address* hosts::table::find(const address& host) const
+{
+    const auto it = index_.find(make_key(host));
+    return it == index_.end() ? nullptr : &buffer_[it->second - base_];
+}
+
+const hosts::address& hosts::table::operator[](size_t index) const
+{
+    return buffer_[index];
+}
+
+bool hosts::table::insert(const address& host)
+{
+    const auto value = make_key(host);
+
+    if (index_.find(value) != index_.end())
+        return false;
+
+    if (buffer_.full())
+    {
+        const auto& victim = stalest();
+
+        if (&victim == &buffer_.front())
+        {
+            index_.erase(make_key(buffer_.front()));
+            buffer_.pop_front();
+            ++base_;
+        }
+        else
+        {
+            erase(address(victim));
+        }
+    }
+
+    index_[value] = base_ + buffer_.size();
+    buffer_.push_back(host);
+    return true;
+}
+
+// The newest address is moved into the erased position, avoiding a shift.
+bool hosts::table::erase(const address& host)
+{
+    const auto it = index_.find(make_key(host));
+
+    if (it == index_.end())
+        return false;
+
+    const auto sequence = it->second;
+    const auto position = buffer_.begin() + (sequence - base_);
+    const auto last = buffer_.end() - 1;
+    index_.erase(it);
+
+    if (position != last)
+    {
+        *position = *last;
+        index_[make_key(*position)] = sequence;
+    }
+
+    buffer_.pop_back();
+    return true;
+}
+
+void hosts::table::clear()
+{
+    buffer_.clear();
+    index_.clear();
+    base_ = 0;
+}
+
+// Shards.
+// ----------------------------------------------------------------------------
+
+hosts::shard::shard(size_t capacity)
+  : fresh(capacity - capacity / tried_divisor),
+    tried(capacity / tried_divisor)
+{
+}
+
+size_t hosts::shard::size() const
+{
+    return tried.size() + fresh.size();
+}
+
+bool hosts::shard::exists(const address& host) const
+{
+    return tried.exists(host) || fresh.exists(host);
+}
+
+bool hosts::shard::outdated(const address& host) const
+{
+    auto stored = tried.find(host);
+
+    if (stored == nullptr)
+        stored = fresh.find(host);
+
+    return stored != nullptr &&
+        host.timestamp() >= stored->timestamp() + refresh_interval;
+}
+
+void hosts::shard::refresh(const address& host)
 {
+    auto stored = tried.find(host);
+
+    if (stored == nullptr)
+        stored = fresh.find(host);
+
+    if (stored != nullptr && host.timestamp() > stored->timestamp())
+        stored->set_timestamp(host.timestamp());
+}
+
+// Tried addresses are indexed ahead of new addresses.
+const hosts::address& hosts::shard::operator[](size_t index) const
+{
+    const auto count = tried.size();
+    return index < count ? tried[index] : fresh[index - count];
+}
+
+// A full tried table demotes its stalest address in favor of the promotion.
+void hosts::shard::promote(const address& host)
+{
+    fresh.erase(host);
+    failures.erase(make_key(host));
+
+    if (tried.full())
+        demote(address(tried.stalest()));
+
+    tried.insert(host);
+}
+
+// The stored entry is retained, preserving its services and timestamp.
+void hosts::shard::demote(const address& host)
+{
+    const auto stored = tried.find(host);
+    const auto entry = stored == nullptr ? host : *stored;
+    tried.erase(host);
+    failures.erase(make_key(host));
+    fresh.insert(entry);
+}
+
+void hosts::shard::clear()
+{
+    fresh.clear();
+    tried.clear();
+    failures.clear();
+}
+
+// private
+size_t hosts::key_hash::operator()(const key& value) const
+{
+    return boost::hash_range(value.begin(), value.end());
+}
+
+// private
+hosts::key hosts::make_key(const address& host)
+{
+    key value;
+    const auto& ip = host.ip();
+    const auto port = host.port();
+    std::copy(ip.begin(), ip.end(), value.begin());
+    value[ip.size()] = static_cast<uint8_t>(port >> 8);
+    value[ip.size() + 1] = static_cast<uint8_t>(port);
+    return value;
 }
 
 // private
-hosts::iterator hosts::find(const address& host)
+// Peer timestamps are credited unless absent or implausibly in the future.
+hosts::address hosts::sanitize(const address& host)
 {
-    const auto found = [&host](const address& entry)
+    const auto current = now();
+    const auto timestamp = host.timestamp();
+
+    if (timestamp != 0 && timestamp <= current + future_limit)
+        return host;
+
+    auto out = host;
+    out.set_timestamp(current - std::min(current, unknown_age));
+    return out;
+}
+
+// private
+// The capacity is distributed over no more shards than there are addresses.
+hosts::shards hosts::make_shards(size_t capacity, size_t count)
+{
+    const auto number = std::max(std::min(count, capacity), size_t(1));
+    shards out;
+    out.reserve(number);
+
+    for (size_t index = 0; index < number; ++index)
+    {
+        const auto share = capacity / number + (index < capacity % number);
+        out.emplace_back(new shard(share));
+    }
+
+    return out;
+}
+
+// private
+hosts::shard& hosts::partition(const address& host) const
+{
+    const auto hash = key_hash()(make_key(host));
+    return *shards_[hash % shards_.size()];
+}
+
+// private
+// Select a shard in proportion to its size, so that an address in a sparse
+// shard is no more likely to be fetched than one in a full shard.
+size_t hosts::select_shard() const
+{
+    const auto total = count();
+
+    if (total == 0)
+        return 0;
+
+    auto pick = static_cast<size_t>(pseudo_random::next(0, total - 1));
+
+    for (size_t index = 0; index < shards_.size(); ++index)
     {
-        return entry.port() == host.port() && entry.ip() == host.ip();
-    };
+        const auto& shard = *shards_[index];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard.mutex);
+
+        const auto size = shard.size();
+
+        if (pick < size)
+            return index;
 
-    return std::find_if(buffer_.begin(), buffer_.end(), found);
+        pick -= size;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    // The shards were reduced concurrently, so the first is as good as any.
+    return 0;
 }
 
+// Properties.
+// ----------------------------------------------------------------------------
+
 size_t hosts::count() const
 {
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    size_t total = 0;
 
-    return buffer_.size();
-    ///////////////////////////////////////////////////////////////////////////
+    for (const auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard->mutex);
+
+        total += shard->size();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return total;
 }
 
 code hosts::fetch(address& out) const
@@ -68,22 +425,39 @@ code hosts::fetch(address& out) const
     if (disabled_)
         return error::not_found;
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    shared_lock lock(mutex_);
+    // Start at a weighted shard and select from the first that is not empty.
+    const auto number = shards_.size();
+    const auto start = select_shard();
 
-    if (stopped_)
-        return error::service_stopped;
+    for (size_t offset = 0; offset < number; ++offset)
+    {
+        const auto& shard = *shards_[(start + offset) % number];
 
-    if (buffer_.empty())
-        return error::not_found;
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard.mutex);
 
-    // Randomly select an address from the buffer.
-    const auto random = pseudo_random::next(0, buffer_.size() - 1);
-    const auto index = static_cast<size_t>(random);
-    out = buffer_[index];
-    return error::success;
-    ///////////////////////////////////////////////////////////////////////////
+        if (stopped_)
+            return error::service_stopped;
+
+        const auto& fresh = shard.fresh;
+        const auto& tried = shard.tried;
+
+        if (fresh.size() == 0 && tried.size() == 0)
+            continue;
+
+        // Prefer reachable peers, but continue to explore new addresses.
+        const auto use_tried = tried.size() != 0 && (fresh.size() == 0 ||
+            pseudo_random::next(0, tried_odds) != 0);
+
+        // Randomly select an address from the table, favoring recent ones.
+        const auto& chosen = use_tried ? tried : fresh;
+        out = chosen.freshest();
+        return error::success;
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    return stopped_ ? error::service_stopped : error::not_found;
 }
 
 code hosts::fetch(address::list& out) const
@@ -91,36 +465,63 @@ code hosts::fetch(address::list& out) const
     if (disabled_)
         return error::not_found;
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
+    if (stopped_)
+        return error::service_stopped;
+
+    const auto total = count();
+
+    if (total == 0)
+        return error::not_found;
+
+    const auto out_count = std::min(max_address, std::min(total, capacity_) /
+        static_cast<size_t>(pseudo_random::next(5, 10)));
+
+    if (out_count == 0)
+        return error::success;
+
+    out.reserve(out_count);
+    std::vector<size_t> indexes;
+
+    // Sample each shard in proportion to its size.
+    for (const auto& shard: shards_)
     {
-        shared_lock lock(mutex_);
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shared_lock lock(shard->mutex);
 
         if (stopped_)
             return error::service_stopped;
 
-        if (buffer_.empty())
-            return error::not_found;
-
-        const auto out_count = std::min(max_address, std::min(buffer_.size(),
-            capacity_) / static_cast<size_t>(pseudo_random::next(5, 10)));
+        const auto size = shard->size();
+        const auto share = std::min(size, (out_count * size + total - 1) /
+            total);
 
-        if (out_count == 0)
-            return error::success;
+        if (share == 0)
+            continue;
 
-        const auto limit = buffer_.size() - 1;
-        auto index = static_cast<size_t>(pseudo_random::next(0, limit));
+        indexes.resize(size);
+        std::iota(indexes.begin(), indexes.end(), size_t(0));
 
-        out.reserve(out_count);
-        for (size_t count = 0; count < out_count; ++count)
-            out.push_back(buffer_[index++ % limit]);
+        // A partial Fisher-Yates shuffle draws a distinct uniform sample.
+        for (size_t taken = 0; taken < share && out.size() < out_count;
+            ++taken)
+        {
+            const auto last = size - taken - 1;
+            const auto pick = taken +
+                static_cast<size_t>(pseudo_random::next(0, last));
+            std::swap(indexes[taken], indexes[pick]);
+            out.push_back((*shard)[indexes[taken]]);
+        }
+        ///////////////////////////////////////////////////////////////////////
     }
-    ///////////////////////////////////////////////////////////////////////////
 
     pseudo_random::shuffle(out);
     return error::success;
 }
 
+// Start/Stop.
+// ----------------------------------------------------------------------------
+
 // load
 code hosts::start()
 {
@@ -140,29 +541,50 @@ code hosts::start()
 
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-    stopped_ = false;
-    bc::ifstream file(file_path_.string());
+    bc::ifstream file(file_path_.string(), std::ios::in | std::ios::binary);
     const auto file_error = file.bad();
 
     if (!file_error)
     {
-        std::string line;
+        // The file is read in one pass and parsed from memory.
+        const data_chunk data((std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
 
-        while (std::getline(file, line))
-        {
-            // TODO: create full space-delimited network_address serialization.
-            // Use to/from string format as opposed to wire serialization.
-            config::authority host(line);
-
-            if (host.port() != 0)
-                buffer_.push_back(host.to_network_address());
-        }
+        // The text format is accepted on load in order to support migration.
+        if (!from_data(data))
+            from_text(data);
     }
 
+    // Stores are rejected until loaded.
+    stopped_ = false;
+
     mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
 
     if (file_error)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failed to load hosts file.";
+        return error::file_system;
+    }
+
+    return error::success;
+}
+
+// checkpoint
+code hosts::save()
+{
+    if (disabled_)
+        return error::success;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    if (!write(snapshot(false)))
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Failed to save hosts file.";
@@ -170,9 +592,10 @@ code hosts::start()
     }
 
     return error::success;
+    ///////////////////////////////////////////////////////////////////////////
 }
 
-// load
+// save
 code hosts::stop()
 {
     if (disabled_)
@@ -191,76 +614,227 @@ code hosts::stop()
 
     mutex_.unlock_upgrade_and_lock();
     //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    // Stores are rejected once stopped, so cleared shards remain empty.
     stopped_ = true;
-    bc::ofstream file(file_path_.string());
-    const auto file_error = file.bad();
-
-    if (!file_error)
-    {
-        for (const auto& entry: buffer_)
-        {
-            // TODO: create full space-delimited network_address serialization.
-            // Use to/from string format as opposed to wire serialization.
-            file << config::authority(entry) << std::endl;
-        }
-
-        buffer_.clear();
-    }
+    const auto saved = write(snapshot(true));
 
     mutex_.unlock();
     ///////////////////////////////////////////////////////////////////////////
 
-    if (file_error)
+    if (!saved)
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Failed to load hosts file.";
+            << "Failed to save hosts file.";
         return error::file_system;
     }
 
     return error::success;
 }
 
+// Serialization.
+// ----------------------------------------------------------------------------
+
+// private
+// Stores are rejected until loaded, but the shard is locked against count.
+void hosts::load(const address& host, bool tried)
+{
+    if (host.port() == 0)
+        return;
+
+    auto& shard = partition(host);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(shard.mutex);
+
+    if (shard.exists(host))
+        return;
+
+    if (tried)
+        shard.promote(host);
+    else
+        shard.fresh.insert(host);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Write to a temporary file and rename, so that failure preserves the file.
+bool hosts::write(const data_chunk& data) const
+{
+    auto temporary = file_path_;
+    temporary += ".tmp";
+
+    {
+        bc::ofstream file(temporary.string(),
+            std::ios::out | std::ios::trunc | std::ios::binary);
+
+        if (file.bad())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        file.flush();
+
+        if (!file.good())
+            return false;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(temporary, file_path_, ec);
+    return !ec;
+}
+
+// private
+// The file header is followed by fixed size network_address records, with
+// tried addresses first. Each shard is locked in turn, so the snapshot is
+// consistent per shard.
+data_chunk hosts::snapshot(bool clear)
+{
+    data_chunk tried;
+    data_chunk fresh;
+    data_sink tried_stream(tried);
+    data_sink fresh_stream(fresh);
+    ostream_writer tried_sink(tried_stream);
+    ostream_writer fresh_sink(fresh_stream);
+    uint32_t tried_count = 0;
+    uint32_t count = 0;
+
+    for (const auto& shard: shards_)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(shard->mutex);
+
+        for (size_t index = 0; index < shard->tried.size(); ++index)
+            shard->tried[index].to_data(record_version, tried_sink, true);
+
+        for (size_t index = 0; index < shard->fresh.size(); ++index)
+            shard->fresh[index].to_data(record_version, fresh_sink, true);
+
+        tried_count += static_cast<uint32_t>(shard->tried.size());
+        count += static_cast<uint32_t>(shard->size());
+
+        if (clear)
+            shard->clear();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    tried_stream.flush();
+    fresh_stream.flush();
+    extend_data(tried, fresh);
+
+    data_chunk data;
+    data.reserve(header_size + tried.size());
+    data_sink ostream(data);
+    ostream_writer sink(ostream);
+    sink.write_4_bytes_little_endian(file_magic);
+    sink.write_4_bytes_little_endian(file_version);
+    sink.write_4_bytes_little_endian(count);
+    sink.write_4_bytes_little_endian(bitcoin_checksum(tried));
+    sink.write_4_bytes_little_endian(tried_count);
+    sink.write_bytes(tried);
+    ostream.flush();
+    return data;
+}
+
+// private
+// Returns false if the data is not in the binary format.
+// Version 1 files do not distinguish tried addresses, so all are new.
+bool hosts::from_data(const data_chunk& data)
+{
+    if (data.size() < header_size_v1)
+        return false;
+
+    auto source = make_safe_deserializer(data.begin(), data.end());
+
+    if (source.read_4_bytes_little_endian() != file_magic)
+        return false;
+
+    const auto version = source.read_4_bytes_little_endian();
+    const auto count = source.read_4_bytes_little_endian();
+    const auto checksum = source.read_4_bytes_little_endian();
+    const auto tried = version < 2 ? 0 : source.read_4_bytes_little_endian();
+    const auto header = version < 2 ? header_size_v1 : header_size;
+    const auto records = data.size() - std::min(header, data.size());
+    const auto begin = data.data() + data.size() - records;
+    const data_slice payload(begin, begin + records);
+
+    if (!source || version == 0 || version > file_version || tried > count ||
+        records % record_size != 0 || records / record_size != count ||
+        bitcoin_checksum(payload) != checksum)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Discarding invalid hosts file.";
+        return true;
+    }
+
+    address entry;
+
+    for (size_t record = 0; record < count; ++record)
+    {
+        if (entry.from_data(record_version, source, true))
+            load(entry, record < tried);
+    }
+
+    return true;
+}
+
+// private
+// The text format is a line-oriented set of config::authority serializations.
+void hosts::from_text(const data_chunk& data)
+{
+    std::string line;
+    std::istringstream text(std::string(data.begin(), data.end()));
+
+    while (std::getline(text, line))
+        load(sanitize(config::authority(line).to_network_address()), false);
+}
+
+// Store/Remove.
+// ----------------------------------------------------------------------------
+
 code hosts::remove(const address& host)
 {
     if (disabled_)
         return error::not_found;
 
+    auto& shard = partition(host);
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    shard.mutex.lock_upgrade();
 
     if (stopped_)
     {
-        mutex_.unlock_upgrade();
+        shard.mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return error::service_stopped;
     }
 
-    auto it = find(host);
-
-    if (it != buffer_.end())
+    if (shard.exists(host))
     {
-        mutex_.unlock_upgrade_and_lock();
+        shard.mutex.unlock_upgrade_and_lock();
         //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-        buffer_.erase(it);
+        shard.fresh.erase(host);
+        shard.tried.erase(host);
+        shard.failures.erase(make_key(host));
 
-        mutex_.unlock();
+        shard.mutex.unlock();
         //---------------------------------------------------------------------
         return error::success;
     }
 
-    mutex_.unlock_upgrade();
+    shard.mutex.unlock_upgrade();
     ///////////////////////////////////////////////////////////////////////////
 
     return error::not_found;
 }
 
-code hosts::store(const address& host)
+code hosts::store(const address& peer_host)
 {
     if (disabled_)
         return error::success;
 
-    if (!host.is_valid())
+    if (!peer_host.is_valid())
     {
         // Do not treat invalid address as an error, just log it.
         LOG_DEBUG(LOG_NETWORK)
@@ -269,29 +843,43 @@ code hosts::store(const address& host)
         return error::success;
     }
 
+    const auto host = sanitize(peer_host);
+    auto& shard = partition(host);
+
     // Critical Section
     ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
+    shard.mutex.lock_upgrade();
 
     if (stopped_)
     {
-        mutex_.unlock_upgrade();
+        shard.mutex.unlock_upgrade();
         //---------------------------------------------------------------------
         return error::service_stopped;
     }
 
-    if (find(host) == buffer_.end())
+    if (!shard.exists(host))
+    {
+        shard.mutex.unlock_upgrade_and_lock();
+        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+        shard.fresh.insert(host);
+
+        shard.mutex.unlock();
+        //---------------------------------------------------------------------
+        return error::success;
+    }
+
+    if (shard.outdated(host))
     {
-        mutex_.unlock_upgrade_and_lock();
+        shard.mutex.unlock_upgrade_and_lock();
         //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
-        buffer_.push_back(host);
+        shard.refresh(host);
 
-        mutex_.unlock();
+        shard.mutex.unlock();
         //---------------------------------------------------------------------
         return error::success;
     }
 
-    mutex_.unlock_upgrade();
+    shard.mutex.unlock_upgrade();
     ///////////////////////////////////////////////////////////////////////////
 
     ////// We don't treat redundant address as an error, just log it.
@@ -309,33 +897,28 @@ void hosts::store(const address::list& hosts, result_handler handler)
         return;
     }
 
-    // Critical Section
-    ///////////////////////////////////////////////////////////////////////////
-    mutex_.lock_upgrade();
-
     if (stopped_)
     {
-        mutex_.unlock_upgrade();
-        //---------------------------------------------------------------------
         handler(error::service_stopped);
         return;
     }
 
     // Accept between 1 and all of this peer's addresses up to capacity.
-    const auto capacity = buffer_.capacity();
-    const auto usable = std::min(hosts.size(), capacity);
+    const auto usable = std::min(hosts.size(), capacity_);
     const auto random = static_cast<size_t>(pseudo_random::next(1, usable));
 
     // But always accept at least the amount we are short if available.
-    const auto gap = capacity - buffer_.size();
+    const auto gap = capacity_ - std::min(count(), capacity_);
     const auto accept = std::max(gap, random);
 
     // Convert minimum desired to step for iteration, no less than 1.
     const auto step = std::max(usable / accept, size_t(1));
-    size_t accepted = 0;
 
-    mutex_.unlock_upgrade_and_lock();
-    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+    // Validate, sample and deduplicate without a lock, grouped by shard.
+    std::vector<address::list> groups(shards_.size());
+    std::vector<address::list> updates(shards_.size());
+    std::unordered_set<key, key_hash> keys;
+    keys.reserve(usable / step + 1);
 
     for (size_t index = 0; index < usable; index = ceiling_add(index, step))
     {
@@ -349,23 +932,165 @@ void hosts::store(const address::list& hosts, result_handler handler)
             continue;
         }
 
-        // Do not allow duplicates in the host cache.
-        if (find(host) == buffer_.end())
+        const auto value = make_key(host);
+
+        if (keys.insert(value).second)
+            groups[key_hash()(value) % shards_.size()].push_back(
+                sanitize(host));
+    }
+
+    size_t accepted = 0;
+
+    // Filter existing addresses under the upgrade lock, which allows
+    // concurrent fetches, and hold the exclusive lock only to write.
+    for (size_t index = 0; index < groups.size(); ++index)
+    {
+        auto& group = groups[index];
+        auto& update = updates[index];
+
+        if (group.empty())
+            continue;
+
+        auto& shard = *shards_[index];
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        shard.mutex.lock_upgrade();
+
+        if (stopped_)
+        {
+            shard.mutex.unlock_upgrade();
+            //-----------------------------------------------------------------
+            handler(error::service_stopped);
+            return;
+        }
+
+        // Do not allow duplicates in the host cache, but note newer times.
+        group.erase(std::remove_if(group.begin(), group.end(),
+            [&shard, &update](const address& host)
+            {
+                if (!shard.exists(host))
+                    return false;
+
+                if (shard.outdated(host))
+                    update.push_back(host);
+
+                return true;
+            }), group.end());
+
+        if (group.empty() && update.empty())
         {
-            ++accepted;
-            buffer_.push_back(host);
+            shard.mutex.unlock_upgrade();
+            //-----------------------------------------------------------------
+            continue;
         }
-    }
 
-    mutex_.unlock();
-    ///////////////////////////////////////////////////////////////////////////
+        shard.mutex.unlock_upgrade_and_lock();
+        //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+        for (const auto& host: update)
+            shard.refresh(host);
+
+        for (const auto& host: group)
+            if (shard.fresh.insert(host))
+                ++accepted;
 
-    LOG_VERBOSE(LOG_NETWORK)
+        shard.mutex.unlock();
+        ///////////////////////////////////////////////////////////////////////
+    }
+
+    LOG_VERBOSE_IF(verbose_, LOG_NETWORK)
         << "Accepted (" << accepted << " of " << hosts.size()
         << ") host addresses from peer.";
 
     handler(error::success);
 }
 
+// Connection outcomes.
+// ----------------------------------------------------------------------------
+
+code hosts::good(const address& host)
+{
+    if (disabled_)
+        return error::not_found;
+
+    auto& shard = partition(host);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(shard.mutex);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    const auto connected = shard.tried.find(host);
+
+    if (connected != nullptr)
+    {
+        connected->set_timestamp(now());
+        shard.failures.erase(make_key(host));
+        return error::success;
+    }
+
+    const auto stored = shard.fresh.find(host);
+
+    // Addresses not from the pool, such as seeds or inbound, are ignored.
+    if (stored == nullptr)
+        return error::not_found;
+
+    // The stored entry is promoted, preserving its services.
+    auto entry = *stored;
+    entry.set_timestamp(now());
+    shard.promote(entry);
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+code hosts::failed(const address& host)
+{
+    if (disabled_)
+        return error::not_found;
+
+    auto& shard = partition(host);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(shard.mutex);
+
+    if (stopped_)
+        return error::service_stopped;
+
+    const auto fresh = shard.fresh.find(host);
+    const auto stored = fresh != nullptr ? fresh : shard.tried.find(host);
+
+    if (stored == nullptr)
+        return error::not_found;
+
+    // Each failure ages the address, for fetch and eviction.
+    const auto timestamp = stored->timestamp();
+    stored->set_timestamp(timestamp - std::min(timestamp, failure_age));
+
+    const auto failures = ++shard.failures[make_key(host)];
+
+    // A new address is given several chances before removal.
+    if (fresh != nullptr)
+    {
+        if (failures >= new_failure_limit)
+        {
+            shard.fresh.erase(host);
+            shard.failures.erase(make_key(host));
+        }
+
+        return error::success;
+    }
+
+    // A tried address is given several chances before demotion.
+    if (failures >= tried_failure_limit)
+        shard.demote(host);
+
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 } // namespace network
 } // namespace libbitcoin
@@ -18,198 +18,267 @@
  */
 #include <bitcoin/network/message_subscriber.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <istream>
 #include <memory>
 #include <string>
+#include <utility>
 #include <bitcoin/bitcoin.hpp>
 
-#define INITIALIZE_SUBSCRIBER(pool, value) \
-    value##_subscriber_(std::make_shared<value##_subscriber_type>( \
-        pool, #value "_sub"))
+namespace libbitcoin {
+namespace network {
 
-#define RELAY_CODE(code, value) \
-    value##_subscriber_->relay(code, {})
+using namespace message;
 
-// This allows us to block the peer while handling the message.
-#define CASE_HANDLE_MESSAGE(stream, version, value) \
-    case message_type::value: \
-        return handle<message::value>(stream, version, value##_subscriber_)
+// The table is indexed by message type, spanning each type subscribable here.
+static size_t table_size()
+{
+    static const message_type types[] =
+    {
+        message_type::address,
+        message_type::alert,
+        message_type::block,
+        message_type::block_transactions,
+        message_type::compact_block,
+        message_type::fee_filter,
+        message_type::filter_add,
+        message_type::filter_clear,
+        message_type::filter_load,
+        message_type::get_address,
+        message_type::get_blocks,
+        message_type::get_block_transactions,
+        message_type::get_data,
+        message_type::get_headers,
+        message_type::headers,
+        message_type::inventory,
+        message_type::memory_pool,
+        message_type::merkle_block,
+        message_type::not_found,
+        message_type::ping,
+        message_type::pong,
+        message_type::reject,
+        message_type::send_compact,
+        message_type::send_headers,
+        message_type::transaction,
+        message_type::verack,
+        message_type::version
+    };
 
-#define CASE_RELAY_MESSAGE(stream, version, value) \
-    case message_type::value: \
-        return relay<message::value>(stream, version, value##_subscriber_)
+    size_t size = 0;
 
-#define START_SUBSCRIBER(value) \
-    value##_subscriber_->start()
+    for (const auto type: types)
+        size = std::max(size, static_cast<size_t>(type) + 1);
 
-#define STOP_SUBSCRIBER(value) \
-    value##_subscriber_->stop()
+    return size;
+}
 
-namespace libbitcoin {
-namespace network {
+message_subscriber::message_subscriber(threadpool& pool)
+  : pool_(pool),
+    stopped_(true),
+    table_(table_size()),
+    payload_subscribed_(false),
+    payload_subscriber_(std::make_shared<payload_subscriber_type>(pool,
+        "payload_sub")),
+    block_stream_subscribed_(false),
+    headers_stream_subscribed_(false)
+{
+}
 
-using namespace message;
+// Raw payloads.
+// ----------------------------------------------------------------------------
 
-message_subscriber::message_subscriber(threadpool& pool)
-  : INITIALIZE_SUBSCRIBER(pool, address),
-    INITIALIZE_SUBSCRIBER(pool, alert),
-    INITIALIZE_SUBSCRIBER(pool, block),
-    INITIALIZE_SUBSCRIBER(pool, block_transactions),
-    INITIALIZE_SUBSCRIBER(pool, compact_block),
-    INITIALIZE_SUBSCRIBER(pool, fee_filter),
-    INITIALIZE_SUBSCRIBER(pool, filter_add),
-    INITIALIZE_SUBSCRIBER(pool, filter_clear),
-    INITIALIZE_SUBSCRIBER(pool, filter_load),
-    INITIALIZE_SUBSCRIBER(pool, get_address),
-    INITIALIZE_SUBSCRIBER(pool, get_blocks),
-    INITIALIZE_SUBSCRIBER(pool, get_block_transactions),
-    INITIALIZE_SUBSCRIBER(pool, get_data),
-    INITIALIZE_SUBSCRIBER(pool, get_headers),
-    INITIALIZE_SUBSCRIBER(pool, headers),
-    INITIALIZE_SUBSCRIBER(pool, inventory),
-    INITIALIZE_SUBSCRIBER(pool, memory_pool),
-    INITIALIZE_SUBSCRIBER(pool, merkle_block),
-    INITIALIZE_SUBSCRIBER(pool, not_found),
-    INITIALIZE_SUBSCRIBER(pool, ping),
-    INITIALIZE_SUBSCRIBER(pool, pong),
-    INITIALIZE_SUBSCRIBER(pool, reject),
-    INITIALIZE_SUBSCRIBER(pool, send_compact),
-    INITIALIZE_SUBSCRIBER(pool, send_headers),
-    INITIALIZE_SUBSCRIBER(pool, transaction),
-    INITIALIZE_SUBSCRIBER(pool, verack),
-    INITIALIZE_SUBSCRIBER(pool, version)
+void message_subscriber::subscribe_payload(payload_handler&& handler)
 {
+    payload_subscribed_ = true;
+    payload_subscriber_->subscribe(std::forward<payload_handler>(handler),
+        error::channel_stopped, message_type::unknown, {});
 }
 
-void message_subscriber::broadcast(const code& ec)
+bool message_subscriber::payload_subscribed() const
 {
-    RELAY_CODE(ec, address);
-    RELAY_CODE(ec, alert);
-    RELAY_CODE(ec, block);
-    RELAY_CODE(ec, block_transactions);
-    RELAY_CODE(ec, compact_block);
-    RELAY_CODE(ec, fee_filter);
-    RELAY_CODE(ec, filter_add);
-    RELAY_CODE(ec, filter_clear);
-    RELAY_CODE(ec, filter_load);
-    RELAY_CODE(ec, get_address);
-    RELAY_CODE(ec, get_blocks);
-    RELAY_CODE(ec, get_block_transactions);
-    RELAY_CODE(ec, get_data);
-    RELAY_CODE(ec, get_headers);
-    RELAY_CODE(ec, headers);
-    RELAY_CODE(ec, inventory);
-    RELAY_CODE(ec, memory_pool);
-    RELAY_CODE(ec, merkle_block);
-    RELAY_CODE(ec, not_found);
-    RELAY_CODE(ec, ping);
-    RELAY_CODE(ec, pong);
-    RELAY_CODE(ec, reject);
-    RELAY_CODE(ec, send_compact);
-    RELAY_CODE(ec, send_headers);
-    RELAY_CODE(ec, transaction);
-    RELAY_CODE(ec, verack);
-    RELAY_CODE(ec, version);
+    return payload_subscribed_;
 }
 
-code message_subscriber::load(message_type type, uint32_t version,
-    std::istream& stream) const
+void message_subscriber::relay(message_type type, payload_ptr payload)
+{
+    payload_subscriber_->relay(error::success, type, payload);
+}
+
+// Streamed parts.
+// ----------------------------------------------------------------------------
+
+void message_subscriber::subscribe_block_stream(
+    block_stream_handler&& handler)
+{
+    stream_subscriber(block_stream_subscriber_, "block_stream_sub")->subscribe(
+        std::forward<block_stream_handler>(handler), error::channel_stopped,
+        {}, 0, {});
+    block_stream_subscribed_ = true;
+}
+
+void message_subscriber::subscribe_headers_stream(
+    headers_stream_handler&& handler)
+{
+    stream_subscriber(headers_stream_subscriber_, "headers_stream_sub")
+        ->subscribe(std::forward<headers_stream_handler>(handler),
+            error::channel_stopped, 0, {});
+    headers_stream_subscribed_ = true;
+}
+
+bool message_subscriber::stream_subscribed(message_type type) const
 {
     switch (type)
     {
-        CASE_RELAY_MESSAGE(stream, version, address);
-        CASE_RELAY_MESSAGE(stream, version, alert);
-        CASE_HANDLE_MESSAGE(stream, version, block);
-        CASE_RELAY_MESSAGE(stream, version, block_transactions);
-        CASE_RELAY_MESSAGE(stream, version, compact_block);
-        CASE_RELAY_MESSAGE(stream, version, fee_filter);
-        CASE_RELAY_MESSAGE(stream, version, filter_add);
-        CASE_RELAY_MESSAGE(stream, version, filter_clear);
-        CASE_RELAY_MESSAGE(stream, version, filter_load);
-        CASE_RELAY_MESSAGE(stream, version, get_address);
-        CASE_RELAY_MESSAGE(stream, version, get_blocks);
-        CASE_RELAY_MESSAGE(stream, version, get_block_transactions);
-        CASE_RELAY_MESSAGE(stream, version, get_data);
-        CASE_RELAY_MESSAGE(stream, version, get_headers);
-        CASE_RELAY_MESSAGE(stream, version, headers);
-        CASE_RELAY_MESSAGE(stream, version, inventory);
-        CASE_RELAY_MESSAGE(stream, version, memory_pool);
-        CASE_RELAY_MESSAGE(stream, version, merkle_block);
-        CASE_RELAY_MESSAGE(stream, version, not_found);
-        CASE_HANDLE_MESSAGE(stream, version, ping);
-        CASE_HANDLE_MESSAGE(stream, version, pong);
-        CASE_RELAY_MESSAGE(stream, version, reject);
-        CASE_RELAY_MESSAGE(stream, version, send_compact);
-        CASE_RELAY_MESSAGE(stream, version, send_headers);
-        CASE_HANDLE_MESSAGE(stream, version, transaction);
-        CASE_HANDLE_MESSAGE(stream, version, verack);
-        CASE_HANDLE_MESSAGE(stream, version, version);
-        case message_type::unknown:
+        case message_type::block:
+            return block_stream_subscribed_;
+        case message_type::headers:
+            return headers_stream_subscribed_;
         default:
-            return error::not_found;
+            return false;
     }
 }
 
+void message_subscriber::notify_block_part(streamed_header_ptr header,
+    size_t index, streamed_transaction_ptr transaction) const
+{
+    const auto subscriber = find_stream(block_stream_subscriber_);
+
+    if (subscriber)
+        subscriber->invoke(error::success, header, index, transaction);
+}
+
+void message_subscriber::notify_headers_part(size_t index,
+    streamed_header_ptr header) const
+{
+    const auto subscriber = find_stream(headers_stream_subscriber_);
+
+    if (subscriber)
+        subscriber->invoke(error::success, index, header);
+}
+
+// Messages.
+// ----------------------------------------------------------------------------
+
+void message_subscriber::broadcast(const code& ec)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    for (const auto entry: table_)
+        if (entry)
+            entry->broadcast(ec);
+
+    const auto block_stream = block_stream_subscriber_;
+    const auto headers_stream = headers_stream_subscriber_;
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    payload_subscriber_->relay(ec, message_type::unknown, {});
+
+    if (block_stream)
+        block_stream->relay(ec, {}, 0, {});
+
+    if (headers_stream)
+        headers_stream->relay(ec, 0, {});
+}
+
+bool message_subscriber::subscribed(message_type type) const
+{
+    return find(type) != nullptr;
+}
+
+code message_subscriber::load(message_type type, uint32_t version,
+    std::istream& stream) const
+{
+    istream_reader source(stream);
+    return do_load(type, version, source);
+}
+
+code message_subscriber::load(message_type type, uint32_t version,
+    reader& source) const
+{
+    return do_load(type, version, source);
+}
+
+// private
+message_subscriber::entry::ptr message_subscriber::find(
+    message_type type) const
+{
+    const auto index = static_cast<size_t>(type);
+
+    if (type == message_type::unknown || index >= table_.size())
+        return nullptr;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return table_[index];
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+code message_subscriber::do_load(message_type type, uint32_t version,
+    reader& source) const
+{
+    const auto index = static_cast<size_t>(type);
+
+    if (type == message_type::unknown || index >= table_.size())
+        return error::not_found;
+
+    // A message of a type without subscription is not parsed.
+    // Handlers may subscribe when invoked, so this must not hold the lock.
+    const auto found = find(type);
+    return found ? found->load(version, source) : error::success;
+}
+
 void message_subscriber::start()
 {
-    START_SUBSCRIBER(address);
-    START_SUBSCRIBER(alert);
-    START_SUBSCRIBER(block);
-    START_SUBSCRIBER(block_transactions);
-    START_SUBSCRIBER(compact_block);
-    START_SUBSCRIBER(fee_filter);
-    START_SUBSCRIBER(filter_add);
-    START_SUBSCRIBER(filter_clear);
-    START_SUBSCRIBER(filter_load);
-    START_SUBSCRIBER(get_address);
-    START_SUBSCRIBER(get_blocks);
-    START_SUBSCRIBER(get_block_transactions);
-    START_SUBSCRIBER(get_data);
-    START_SUBSCRIBER(get_headers);
-    START_SUBSCRIBER(headers);
-    START_SUBSCRIBER(inventory);
-    START_SUBSCRIBER(memory_pool);
-    START_SUBSCRIBER(merkle_block);
-    START_SUBSCRIBER(not_found);
-    START_SUBSCRIBER(ping);
-    START_SUBSCRIBER(pong);
-    START_SUBSCRIBER(reject);
-    START_SUBSCRIBER(send_compact);
-    START_SUBSCRIBER(send_headers);
-    START_SUBSCRIBER(transaction);
-    START_SUBSCRIBER(verack);
-    START_SUBSCRIBER(version);
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    stopped_ = false;
+
+    for (const auto entry: table_)
+        if (entry)
+            entry->start();
+
+    if (block_stream_subscriber_)
+        block_stream_subscriber_->start();
+
+    if (headers_stream_subscriber_)
+        headers_stream_subscriber_->start();
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    payload_subscriber_->start();
 }
 
 void message_subscriber::stop()
 {
-    STOP_SUBSCRIBER(address);
-    STOP_SUBSCRIBER(alert);
-    STOP_SUBSCRIBER(block);
-    STOP_SUBSCRIBER(block_transactions);
-    STOP_SUBSCRIBER(compact_block);
-    STOP_SUBSCRIBER(fee_filter);
-    STOP_SUBSCRIBER(filter_add);
-    STOP_SUBSCRIBER(filter_clear);
-    STOP_SUBSCRIBER(filter_load);
-    STOP_SUBSCRIBER(get_address);
-    STOP_SUBSCRIBER(get_blocks);
-    STOP_SUBSCRIBER(get_block_transactions);
-    STOP_SUBSCRIBER(get_data);
-    STOP_SUBSCRIBER(get_headers);
-    STOP_SUBSCRIBER(headers);
-    STOP_SUBSCRIBER(inventory);
-    STOP_SUBSCRIBER(memory_pool);
-    STOP_SUBSCRIBER(merkle_block);
-    STOP_SUBSCRIBER(not_found);
-    STOP_SUBSCRIBER(ping);
-    STOP_SUBSCRIBER(pong);
-    STOP_SUBSCRIBER(reject);
-    STOP_SUBSCRIBER(send_compact);
-    STOP_SUBSCRIBER(send_headers);
-    STOP_SUBSCRIBER(transaction);
-    STOP_SUBSCRIBER(verack);
-    STOP_SUBSCRIBER(version);
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    stopped_ = true;
+
+    for (const auto entry: table_)
+        if (entry)
+            entry->stop();
+
+    if (block_stream_subscriber_)
+        block_stream_subscriber_->stop();
+
+    if (headers_stream_subscriber_)
+        headers_stream_subscriber_->stop();
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    payload_subscriber_->stop();
 }
 
 } // namespace network
@@ -19,6 +19,7 @@
 #include <bitcoin/network/p2p.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -27,8 +28,12 @@
 #include <utility>
 #include <vector>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/blacklist.hpp>
+#include <bitcoin/network/buffer_pool.hpp>
 #include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/channel_cache.hpp>
 #include <bitcoin/network/define.hpp>
+#include <bitcoin/network/dns_cache.hpp>
 #include <bitcoin/network/hosts.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
@@ -41,15 +46,38 @@
 #include <bitcoin/network/sessions/session_outbound.hpp>
 #include <bitcoin/network/sessions/session_seed.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/subnet.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
 
 #define NAME "p2p"
 
+// A timer fires up to a tick after its period, so the channel timers are
+// checked at a quarter of the relay period, but no less often than once per
+// second. One revolution of the wheel spans from a little over eight minutes
+// down to five seconds, and longer delays take rounds.
+static const auto maximum_timer_resolution = asio::seconds(1);
+static const auto minimum_timer_resolution = asio::milliseconds(10);
+static const size_t timer_slots = 512;
+
 using namespace bc::config;
 using namespace std::placeholders;
 
+inline asio::duration timer_resolution(const settings& settings)
+{
+    const asio::duration maximum = maximum_timer_resolution;
+    const asio::duration minimum = minimum_timer_resolution;
+
+    if (settings.inventory_relay_milliseconds == 0)
+        return maximum;
+
+    const auto quarter = settings.inventory_relay() / 4;
+    return std::max(minimum, std::min(maximum, quarter));
+}
+
 // This can be exceeded due to manual connection calls and race conditions.
 inline size_t nominal_connecting(const settings& settings)
 {
@@ -64,11 +92,79 @@ inline size_t nominal_connected(const settings& settings)
         settings.inbound_connections;
 }
 
+// The configured hosts and ranges, with the given ranges.
+static subnet::list blacklist_ranges(const settings& settings,
+    const subnet::list& subnets)
+{
+    auto ranges = subnets;
+    const auto& hosts = settings.blacklists;
+    const auto& configured = settings.blacklist_subnets;
+    ranges.reserve(ranges.size() + hosts.size() + configured.size());
+    ranges.insert(ranges.end(), hosts.begin(), hosts.end());
+    ranges.insert(ranges.end(), configured.begin(), configured.end());
+    return ranges;
+}
+
+// The protocol version range is validated once, not upon each handshake.
+static bool valid_protocol(const settings& settings)
+{
+    using namespace bc::message;
+
+    if (settings.protocol_minimum < version::level::minimum)
+    {
+        LOG_ERROR(LOG_NETWORK)
+            << "Invalid protocol version configuration, minimum below ("
+            << version::level::minimum << ").";
+        return false;
+    }
+
+    if (settings.protocol_maximum > version::level::maximum)
+    {
+        LOG_ERROR(LOG_NETWORK)
+            << "Invalid protocol version configuration, maximum above ("
+            << version::level::maximum << ").";
+        return false;
+    }
+
+    if (settings.protocol_minimum > settings.protocol_maximum)
+    {
+        LOG_ERROR(LOG_NETWORK)
+            << "Invalid protocol version configuration, "
+            << "minimum exceeds maximum.";
+        return false;
+    }
+
+    return true;
+}
+
+static std::vector<std::unique_ptr<threadpool>> make_shards(
+    const settings& settings)
+{
+    std::vector<std::unique_ptr<threadpool>> shards;
+    shards.reserve(settings.channel_shards);
+
+    for (size_t shard = 0; shard < settings.channel_shards; ++shard)
+        shards.emplace_back(new threadpool);
+
+    return shards;
+}
+
 p2p::p2p(const settings& settings)
   : settings_(settings),
     stopped_(true),
     top_block_({ null_hash, 0 }),
     top_header_({ null_hash, 0 }),
+    shards_(make_shards(settings_)),
+    next_shard_(0),
+    buffers_(std::make_shared<buffer_pool>(
+        settings_.buffer_pool_capacity())),
+    allocations_(std::make_shared<channel_cache>(
+        settings_.channel_cache_size)),
+    blacklist_(blacklist_ranges(settings_, {})),
+    names_(std::make_shared<dns_cache>(threadpool_, settings_)),
+    exporter_(std::make_shared<statistics_exporter>(*this)),
+    timers_(std::make_shared<timer_wheel>(threadpool_,
+        timer_resolution(settings_), timer_slots)),
     hosts_(settings_),
     pending_connect_(nominal_connecting(settings_)),
     pending_handshake_(nominal_connected(settings_)),
@@ -76,7 +172,8 @@ p2p::p2p(const settings& settings)
     stop_subscriber_(std::make_shared<stop_subscriber>(threadpool_,
         NAME "_stop_sub")),
     channel_subscriber_(std::make_shared<channel_subscriber>(threadpool_,
-        NAME "_sub"))
+        NAME "_sub")),
+    announcement_key_(0)
 {
 }
 
@@ -97,13 +194,28 @@ void p2p::start(result_handler handler)
         return;
     }
 
+    if (!valid_protocol(settings_))
+    {
+        handler(error::operation_failed);
+        return;
+    }
+
     threadpool_.join();
     threadpool_.spawn(thread_default(settings_.threads),
         thread_priority::normal);
 
+    // Each shard has one thread, so the work of its channels is serialized.
+    for (const auto& shard: shards_)
+    {
+        shard->join();
+        shard->spawn(1, thread_priority::normal);
+    }
+
     stopped_ = false;
     stop_subscriber_->start();
     channel_subscriber_->start();
+    exporter_->start();
+    timers_->start();
 
     // This instance is retained by stop handler and member reference.
     manual_.store(attach_manual_session());
@@ -149,6 +261,8 @@ void p2p::handle_hosts_loaded(const code& ec, result_handler handler)
         return;
     }
 
+    start_hosts_timer();
+
     // The instance is retained by the stop handler (until shutdown).
     const auto seed = attach_seed_session();
 
@@ -183,6 +297,48 @@ void p2p::handle_started(const code& ec, result_handler handler)
     handler(error::success);
 }
 
+// Hosts checkpoint timer.
+// ----------------------------------------------------------------------------
+
+void p2p::start_hosts_timer()
+{
+    if (settings_.hosts_checkpoint_minutes == 0)
+        return;
+
+    const auto timer = std::make_shared<deadline>(threadpool_,
+        settings_.hosts_checkpoint());
+
+    // The timer is retained by member reference until stop.
+    hosts_timer_.store(timer);
+    timer->start(
+        std::bind(&p2p::handle_hosts_timer,
+            this, _1));
+}
+
+void p2p::handle_hosts_timer(const code& ec)
+{
+    if (stopped() || ec)
+        return;
+
+    const auto result = hosts_.save();
+
+    if (result && result != error::service_stopped)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Error saving host addresses: " << result.message();
+    }
+
+    // Restart the timer for the next checkpoint.
+    const auto timer = hosts_timer_.load();
+
+    if (timer && !stopped())
+    {
+        timer->start(
+            std::bind(&p2p::handle_hosts_timer,
+                this, _1));
+    }
+}
+
 // Run sequence.
 // ----------------------------------------------------------------------------
 
@@ -194,6 +350,7 @@ void p2p::run(result_handler handler)
 
     // The instance is retained by the stop handler (until shutdown).
     const auto inbound = attach_inbound_session();
+    inbound_.store(inbound);
 
     // This is invoked on a new thread.
     inbound->start(
@@ -213,6 +370,7 @@ void p2p::handle_inbound_started(const code& ec, result_handler handler)
 
     // The instance is retained by the stop handler (until shutdown).
     const auto outbound = attach_outbound_session();
+    outbound_.store(outbound);
 
     // This is invoked on a new thread.
     outbound->start(
@@ -258,6 +416,12 @@ session_outbound::ptr p2p::attach_outbound_session()
     return attach<session_outbound>(true);
 }
 
+// The network does not hold the previous outputs of a transaction.
+uint64_t p2p::fee_rate(const message::transaction&) const
+{
+    return max_uint64;
+}
+
 // Shutdown.
 // ----------------------------------------------------------------------------
 // All shutdown actions must be queued by the end of the stop call.
@@ -269,12 +433,32 @@ session_outbound::ptr p2p::attach_outbound_session()
 // is thread safe and idempotent, allowing it to be unguarded.
 bool p2p::stop()
 {
+    // Save the connected outbound peers while their channels remain.
+    const auto outbound = outbound_.load();
+
+    if (outbound)
+        outbound->save_anchors();
+
     // This is the only stop operation that can fail.
     const auto result = (hosts_.stop() == error::success);
 
     // Signal all current work to stop and free manual session.
     stopped_ = true;
     manual_.store({});
+    inbound_.store({});
+    outbound_.store({});
+
+    // Stop the hosts checkpoint timer.
+    const auto timer = hosts_timer_.load();
+
+    if (timer)
+        timer->stop();
+
+    // Cancel pending name resolutions and clear the cache.
+    names_->stop();
+
+    // Stop pushing statistics.
+    exporter_->stop();
 
     // Prevent subscription after stop.
     stop_subscriber_->stop();
@@ -284,13 +468,33 @@ bool p2p::stop()
     channel_subscriber_->stop();
     channel_subscriber_->invoke(error::service_stopped, {});
 
+    announcement_handlers announcements;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    announcement_mutex_.lock();
+    announcements.swap(announcements_);
+    announcement_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Subscription after stop is prevented by the stopped test.
+    for (const auto& announcement: announcements)
+        announcement.second(error::service_stopped, {});
+
     // Stop creating new channels and stop those that exist (self-clearing).
     pending_connect_.stop(error::service_stopped);
     pending_handshake_.stop(error::service_stopped);
     pending_close_.stop(error::service_stopped);
 
+    // Release the timers of channels and protocols that remain.
+    timers_->stop();
+
     // Signal threadpool to stop accepting work now that subscribers are clear.
     threadpool_.shutdown();
+
+    for (const auto& shard: shards_)
+        shard->shutdown();
+
     return result;
 }
 
@@ -302,6 +506,10 @@ bool p2p::close()
 
     // Block on join of all threads in the threadpool.
     threadpool_.join();
+
+    for (const auto& shard: shards_)
+        shard->join();
+
     return result;
 }
 
@@ -343,6 +551,16 @@ void p2p::set_top_header(const checkpoint& top)
     top_header_.store(top);
 }
 
+bool p2p::blacklisted(const address& address) const
+{
+    return blacklist_.contains(authority(address));
+}
+
+void p2p::set_blacklist(const subnet::list& subnets)
+{
+    blacklist_.load(blacklist_ranges(settings_, subnets));
+}
+
 bool p2p::stopped() const
 {
     return stopped_;
@@ -353,17 +571,95 @@ threadpool& p2p::thread_pool()
     return threadpool_;
 }
 
+threadpool& p2p::channel_pool()
+{
+    if (shards_.empty())
+        return threadpool_;
+
+    return *shards_[next_shard_++ % shards_.size()];
+}
+
+buffer_pool::ptr p2p::buffers()
+{
+    return buffers_;
+}
+
+channel_cache::ptr p2p::allocations()
+{
+    return allocations_;
+}
+
+dns_cache::ptr p2p::names()
+{
+    return names_;
+}
+
+statistics_exporter::ptr p2p::exporter()
+{
+    return exporter_;
+}
+
+timer_wheel::ptr p2p::timers()
+{
+    return timers_;
+}
+
 // Send.
 // ----------------------------------------------------------------------------
 
 // private
 void p2p::handle_send(const code& ec, channel::ptr channel,
-    channel_handler handle_channel, result_handler handle_complete)
+    inventory_ptr inventory, channel_handler handle_channel,
+    result_handler handle_complete)
 {
+    if (!ec && inventory)
+        for (const auto& hash: *inventory)
+            channel->remember_inventory(hash);
+
     handle_channel(ec, channel);
     handle_complete(ec);
 }
 
+hash_list p2p::inventory_of(const message::inventory& message)
+{
+    hash_list hashes;
+    hashes.reserve(message.inventories().size());
+
+    for (const auto& inventory: message.inventories())
+        hashes.push_back(inventory.hash());
+
+    return hashes;
+}
+
+hash_list p2p::inventory_of(const message::transaction& message)
+{
+    return{ message.hash() };
+}
+
+hash_list p2p::inventory_of(const message::block& message)
+{
+    return{ message.header().hash() };
+}
+
+// Announced inventory is sent in full unless all of it is known.
+bool p2p::known(channel::ptr channel, inventory_ptr inventory)
+{
+    if (!inventory)
+        return false;
+
+    for (const auto& hash: *inventory)
+        if (!channel->known_inventory(hash))
+            return false;
+
+    return true;
+}
+
+bool p2p::relayable(channel::ptr channel,
+    const message::transaction& message) const
+{
+    return channel->admits(message, fee_rate(message));
+}
+
 // Subscriptions.
 // ----------------------------------------------------------------------------
 
@@ -377,6 +673,84 @@ void p2p::subscribe_stop(result_handler handler)
     stop_subscriber_->subscribe(handler, error::service_stopped);
 }
 
+// The stopped test is under the lock, as stop sets it before clearing.
+uint64_t p2p::subscribe_announcement(inventory_handler handler)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    announcement_mutex_.lock();
+
+    if (stopped())
+    {
+        announcement_mutex_.unlock();
+        //---------------------------------------------------------------------
+        handler(error::service_stopped, {});
+        return 0;
+    }
+
+    const auto key = ++announcement_key_;
+    announcements_.emplace(key, std::move(handler));
+
+    announcement_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return key;
+}
+
+void p2p::unsubscribe_announcement(uint64_t key)
+{
+    inventory_handler released;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(announcement_mutex_);
+
+        const auto it = announcements_.find(key);
+
+        if (it == announcements_.end())
+            return;
+
+        // The handler is destroyed outside of the lock, as it may hold the
+        // last reference to a protocol that unsubscribes upon destruct.
+        released = std::move(it->second);
+        announcements_.erase(it);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Inventory relay.
+// ----------------------------------------------------------------------------
+
+// Handlers are invoked on the threadpool, as are those of a relay.
+void p2p::announce(const message::inventory_vector& inventory)
+{
+    announcement_handlers handlers;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    announcement_mutex_.lock_shared();
+    handlers = announcements_;
+    announcement_mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (handlers.empty())
+        return;
+
+    threadpool_.service().post(std::bind(&p2p::do_announce, this,
+        std::move(handlers), inventory));
+}
+
+// private
+// A handler that returns false is released, as by a resubscriber.
+void p2p::do_announce(const announcement_handlers& handlers,
+    const message::inventory_vector& inventory)
+{
+    for (const auto& announcement: handlers)
+        if (!announcement.second(error::success, inventory))
+            unsubscribe_announcement(announcement.first);
+}
+
 // Manual connections.
 // ----------------------------------------------------------------------------
 
@@ -412,6 +786,31 @@ void p2p::connect(const std::string& hostname, uint16_t port,
         manual->connect(hostname, port, handler);
 }
 
+// Simulated connections.
+// ----------------------------------------------------------------------------
+
+code p2p::accept(transport::ptr transport)
+{
+    const auto inbound = inbound_.load();
+
+    if (stopped() || !inbound)
+    {
+        transport->stop();
+        return error::service_stopped;
+    }
+
+    const auto created = allocations_->create(channel_pool(), transport,
+        settings_, buffers_, timers_);
+
+    const auto ec = inbound->accept(created);
+
+    // A rejected channel is not started, so its stop would not be relayed.
+    if (ec)
+        transport->stop();
+
+    return ec;
+}
+
 // Hosts collection.
 // ----------------------------------------------------------------------------
 
@@ -441,11 +840,78 @@ code p2p::fetch_addresses(address::list& out_addresses) const
     return hosts_.fetch(out_addresses);
 }
 
+// The response is sampled once per interval, so that repeated requests
+// neither cost a sample and serialization nor reveal the pool over time.
+proxy::const_payload_ptr p2p::address_payload(uint32_t version)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto interval = settings_.address_cache();
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    address_mutex_.lock_upgrade();
+
+    if (now < address_expiration_)
+    {
+        const auto it = address_payloads_.find(version);
+
+        if (it != address_payloads_.end())
+        {
+            const auto payload = it->second;
+            address_mutex_.unlock_upgrade();
+            //-----------------------------------------------------------------
+            return payload;
+        }
+    }
+
+    address_mutex_.unlock_upgrade_and_lock();
+    //+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+    if (now >= address_expiration_)
+    {
+        address::list addresses;
+        fetch_addresses(addresses);
+        address_cache_ = std::make_shared<const message::address>(
+            std::move(addresses));
+        address_expiration_ = now + interval;
+        address_payloads_.clear();
+    }
+
+    proxy::const_payload_ptr payload;
+
+    if (!address_cache_->addresses().empty())
+    {
+        auto& cached = address_payloads_[version];
+
+        if (!cached)
+            cached = std::make_shared<const data_chunk>(
+                message::serialize(version, *address_cache_,
+                    settings_.identifier));
+
+        payload = cached;
+    }
+
+    address_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return payload;
+}
+
 code p2p::remove(const address& address)
 {
     return hosts_.remove(address);
 }
 
+code p2p::good_address(const address& address)
+{
+    return hosts_.good(address);
+}
+
+code p2p::failed_address(const address& address)
+{
+    return hosts_.failed(address);
+}
+
 // Pending connect collection.
 // ----------------------------------------------------------------------------
 
@@ -475,12 +941,7 @@ void p2p::unpend(channel::ptr channel)
 
 bool p2p::pending(uint64_t version_nonce) const
 {
-    const auto match = [version_nonce](const channel::ptr& element)
-    {
-        return element->nonce() == version_nonce;
-    };
-
-    return pending_handshake_.exists(match);
+    return pending_handshake_.exists(version_nonce);
 }
 
 // Pending close collection (open connections).
@@ -491,26 +952,70 @@ size_t p2p::connection_count() const
     return pending_close_.size();
 }
 
-bool p2p::connected(const address& address) const
+// private
+// Scores are read once, as they may change while sorting.
+channel_registry::channels p2p::ranked_channels() const
 {
-    const auto match = [&address](const channel::ptr& element)
-    {
-        return element->authority() == address;
-    };
+    typedef std::pair<asio::duration, channel::ptr> ranked;
+
+    const auto channels = pending_close_.snapshot();
+    std::vector<ranked> ranks;
+    ranks.reserve(channels->size());
+
+    for (const auto channel: *channels)
+        ranks.emplace_back(channel->latency_score(), channel);
 
-    return pending_close_.exists(match);
+    std::stable_sort(ranks.begin(), ranks.end(),
+        [](const ranked& left, const ranked& right)
+        {
+            return left.first < right.first;
+        });
+
+    channel_registry::channels out;
+    out.reserve(ranks.size());
+
+    for (const auto& rank: ranks)
+        out.push_back(rank.second);
+
+    return out;
 }
 
-code p2p::store(channel::ptr channel)
+// The ranking is stable, so that equally ranked channels keep their order.
+channel_registry::channels p2p::ranked_channels(size_t count,
+    channel_ranking ranking) const
 {
-    const auto address = channel->authority();
-    const auto match = [&address](const channel::ptr& element)
-    {
-        return element->authority() == address;
-    };
+    auto out = ranking ? *pending_close_.snapshot() : ranked_channels();
+
+    if (ranking)
+        std::stable_sort(out.begin(), out.end(), ranking);
+
+    if (out.size() > count)
+        out.resize(count);
 
+    return out;
+}
+
+channel_statistics::list p2p::statistics() const
+{
+    const auto channels = pending_close_.snapshot();
+    channel_statistics::list out;
+    out.reserve(channels->size());
+
+    for (const auto channel: *channels)
+        out.push_back(channel->statistics());
+
+    return out;
+}
+
+bool p2p::connected(const address& address) const
+{
+    return pending_close_.exists(authority(address));
+}
+
+code p2p::store(channel::ptr channel)
+{
     // May return error::address_in_use.
-    const auto ec = pending_close_.store(channel, match);
+    const auto ec = pending_close_.store_unique(channel);
 
     if (!ec && channel->notify())
         channel_subscriber_->relay(error::success, channel);
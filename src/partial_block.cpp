@@ -0,0 +1,354 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/partial_block.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::message;
+
+static const uint64_t short_id_mask = 0x0000ffffffffffff;
+
+// Indexes are differentially encoded on the wire (bip152), each being the
+// distance from the previous index less one, and are held so in messages.
+static uint64_t to_absolute(uint64_t previous, uint64_t differential,
+    bool first)
+{
+    return first ? differential : previous + differential + 1;
+}
+
+static uint64_t read_word(const uint8_t* data)
+{
+    uint64_t value = 0;
+
+    for (size_t byte = 0; byte < sizeof(uint64_t); ++byte)
+        value |= static_cast<uint64_t>(data[byte]) << (8 * byte);
+
+    return value;
+}
+
+static uint64_t rotate(uint64_t value, size_t bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static void sip_round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3)
+{
+    v0 += v1;
+    v1 = rotate(v1, 13);
+    v1 ^= v0;
+    v0 = rotate(v0, 32);
+    v2 += v3;
+    v3 = rotate(v3, 16);
+    v3 ^= v2;
+    v0 += v3;
+    v3 = rotate(v3, 21);
+    v3 ^= v0;
+    v2 += v1;
+    v1 = rotate(v1, 17);
+    v1 ^= v2;
+    v2 = rotate(v2, 32);
+}
+
+// SipHash-2-4 of the data, with the key given as two little endian words.
+static uint64_t sip_hash(uint64_t key0, uint64_t key1, const uint8_t* data,
+    size_t size)
+{
+    auto v0 = 0x736f6d6570736575 ^ key0;
+    auto v1 = 0x646f72616e646f6d ^ key1;
+    auto v2 = 0x6c7967656e657261 ^ key0;
+    auto v3 = 0x7465646279746573 ^ key1;
+
+    const auto words = size / sizeof(uint64_t);
+
+    for (size_t word = 0; word < words; ++word)
+    {
+        const auto value = read_word(data + word * sizeof(uint64_t));
+        v3 ^= value;
+        sip_round(v0, v1, v2, v3);
+        sip_round(v0, v1, v2, v3);
+        v0 ^= value;
+    }
+
+    auto last = static_cast<uint64_t>(size) << 56;
+    const auto tail = data + words * sizeof(uint64_t);
+
+    for (size_t byte = 0; byte < size % sizeof(uint64_t); ++byte)
+        last |= static_cast<uint64_t>(tail[byte]) << (8 * byte);
+
+    v3 ^= last;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    v0 ^= last;
+    v2 ^= 0xff;
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    sip_round(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+static uint64_t to_short_id(uint64_t key0, uint64_t key1,
+    const hash_digest& hash)
+{
+    return short_id_mask & sip_hash(key0, key1, hash.data(), hash.size());
+}
+
+static uint64_t to_value(const mini_hash& id)
+{
+    uint64_t value = 0;
+
+    for (size_t byte = 0; byte < id.size(); ++byte)
+        value |= static_cast<uint64_t>(id[byte]) << (8 * byte);
+
+    return value;
+}
+
+static mini_hash to_mini_hash(uint64_t value)
+{
+    mini_hash id;
+
+    for (size_t byte = 0; byte < id.size(); ++byte)
+        id[byte] = static_cast<uint8_t>(value >> (8 * byte));
+
+    return id;
+}
+
+// The siphash key is the first two little endian words of the sha256 of
+// the serialized header followed by the little endian nonce.
+static hash_digest make_key(const chain::header& header, uint64_t nonce)
+{
+    return sha256_hash(build_chunk({ header.to_data(),
+        to_little_endian(nonce) }));
+}
+
+compact_block partial_block::compact(const message::block& block,
+    uint64_t nonce, bool witness)
+{
+    const auto key = make_key(block.header(), nonce);
+    const auto key0 = read_word(key.data());
+    const auto key1 = read_word(key.data() + sizeof(uint64_t));
+    const auto& transactions = block.transactions();
+
+    mini_hash_list short_ids;
+    prefilled_transaction::list prefilled;
+
+    if (!transactions.empty())
+    {
+        short_ids.reserve(transactions.size() - 1);
+        prefilled.emplace_back(0, transactions.front());
+    }
+
+    for (size_t index = 1; index < transactions.size(); ++index)
+    {
+        const auto hash = transactions[index].hash(witness);
+        short_ids.push_back(to_mini_hash(to_short_id(key0, key1, hash)));
+    }
+
+    return { block.header(), nonce, short_ids, prefilled };
+}
+
+// Slots are first assigned to prefilled transactions, in order of index,
+// and the short ids then take the remaining slots in order.
+partial_block::partial_block(const compact_block& block, bool witness)
+  : header_(block.header()),
+    witness_(witness),
+    key0_(0),
+    key1_(0),
+    valid_(true),
+    filled_count_(0)
+{
+    const auto key = make_key(header_, block.nonce());
+    key0_ = read_word(key.data());
+    key1_ = read_word(key.data() + sizeof(uint64_t));
+
+    const auto& short_ids = block.short_ids();
+    const auto& prefilled = block.transactions();
+    const auto count = short_ids.size() + prefilled.size();
+
+    // A block requires at least a coinbase.
+    if (count == 0)
+    {
+        valid_ = false;
+        return;
+    }
+
+    transactions_.resize(count);
+    filled_.resize(count, false);
+    prefilled_.resize(count, false);
+
+    uint64_t index = 0;
+
+    for (size_t position = 0; position < prefilled.size(); ++position)
+    {
+        const auto& item = prefilled[position];
+        index = to_absolute(index, item.index(), position == 0);
+
+        if (index >= count || prefilled_[index])
+        {
+            valid_ = false;
+            return;
+        }
+
+        transactions_[index] = item.transaction();
+        filled_[index] = true;
+        prefilled_[index] = true;
+        ++filled_count_;
+    }
+
+    size_t id = 0;
+
+    for (size_t slot = 0; slot < count; ++slot)
+    {
+        if (prefilled_[slot])
+            continue;
+
+        // Duplicate short ids cannot be resolved, so the block is invalid.
+        if (!slots_.emplace(to_value(short_ids[id++]), slot).second)
+        {
+            valid_ = false;
+            return;
+        }
+    }
+}
+
+bool partial_block::valid() const
+{
+    return valid_;
+}
+
+hash_digest partial_block::hash() const
+{
+    return header_.hash();
+}
+
+size_t partial_block::populate(transaction_pool pool)
+{
+    if (!valid_ || slots_.empty())
+        return 0;
+
+    const auto start = filled_count_;
+    std::vector<bool> ambiguous(transactions_.size(), false);
+
+    const auto visit = [&](transaction_const_ptr transaction)
+    {
+        const auto it = slots_.find(short_id(transaction->hash(witness_)));
+
+        if (it == slots_.end())
+            return true;
+
+        const auto slot = it->second;
+
+        if (ambiguous[slot])
+            return true;
+
+        // A second match leaves the slot to the block transactions response.
+        if (filled_[slot])
+        {
+            ambiguous[slot] = true;
+            filled_[slot] = false;
+            transactions_[slot] = chain::transaction{};
+            --filled_count_;
+            return true;
+        }
+
+        transactions_[slot] = *transaction;
+        filled_[slot] = true;
+        ++filled_count_;
+        return true;
+    };
+
+    pool(visit);
+    return filled_count_ > start ? filled_count_ - start : 0;
+}
+
+size_t partial_block::missing() const
+{
+    return valid_ ? transactions_.size() - filled_count_ : 0;
+}
+
+get_block_transactions partial_block::request() const
+{
+    std::vector<uint64_t> indexes;
+    indexes.reserve(missing());
+    uint64_t previous = 0;
+
+    for (size_t slot = 0; slot < filled_.size(); ++slot)
+    {
+        if (filled_[slot])
+            continue;
+
+        indexes.push_back(indexes.empty() ? slot : slot - previous - 1);
+        previous = slot;
+    }
+
+    return { hash(), indexes };
+}
+
+code partial_block::fill(const block_transactions& response)
+{
+    const auto& transactions = response.transactions();
+
+    if (!valid_ || response.block_hash() != hash() ||
+        transactions.size() != missing())
+        return error::bad_stream;
+
+    auto it = transactions.begin();
+
+    for (size_t slot = 0; slot < filled_.size(); ++slot)
+    {
+        if (filled_[slot])
+            continue;
+
+        transactions_[slot] = *it++;
+        filled_[slot] = true;
+        ++filled_count_;
+    }
+
+    return error::success;
+}
+
+block_const_ptr partial_block::block() const
+{
+    if (!valid_ || missing() != 0)
+        return {};
+
+    const auto out = std::make_shared<const message::block>(header_,
+        chain::transaction::list(transactions_));
+
+    if (out->generate_merkle_root() != header_.merkle())
+        return {};
+
+    return out;
+}
+
+// private
+uint64_t partial_block::short_id(const hash_digest& hash) const
+{
+    return to_short_id(key0_, key1_, hash);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,227 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/pipe_transport.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace boost::asio;
+
+pipe_transport::pair pipe_transport::make_pair(threadpool& pool,
+    const config::authority& first, const config::authority& second)
+{
+    const auto left = std::make_shared<pipe_transport>(pool, second);
+    const auto right = std::make_shared<pipe_transport>(pool, first);
+    left->peer_ = right;
+    right->peer_ = left;
+    return { left, right };
+}
+
+pipe_transport::pipe_transport(threadpool& pool,
+    const config::authority& peer)
+  : pool_(pool),
+    peer_authority_(peer),
+    stopped_(false),
+    disconnected_(false),
+    partial_(false)
+{
+}
+
+config::authority pipe_transport::authority() const
+{
+    return peer_authority_;
+}
+
+void pipe_transport::read(const mutable_buffer& buffer, io_handler handler)
+{
+    start_read(buffer, std::move(handler), false);
+}
+
+void pipe_transport::read_some(const mutable_buffer& buffer,
+    io_handler handler)
+{
+    start_read(buffer, std::move(handler), true);
+}
+
+void pipe_transport::write(const const_buffers& buffers, io_handler handler)
+{
+    size_t size = 0;
+
+    for (const auto& buffer: buffers)
+        size += buffer_size(buffer);
+
+    std::shared_ptr<pipe_transport> peer;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        shared_lock lock(mutex_);
+
+        if (stopped_)
+        {
+            post(handler, boost::asio::error::operation_aborted, 0);
+            return;
+        }
+
+        peer = peer_.lock();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The peer is not locked within this lock, as it may also be writing.
+    if (!peer || !peer->deliver(buffers))
+    {
+        post(handler, boost::asio::error::broken_pipe, 0);
+        return;
+    }
+
+    post(handler, boost_code(), size);
+}
+
+void pipe_transport::stop()
+{
+    std::shared_ptr<pipe_transport> peer;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(mutex_);
+
+        if (stopped_)
+            return;
+
+        stopped_ = true;
+        received_.clear();
+
+        if (reader_)
+        {
+            post(std::move(reader_), boost::asio::error::operation_aborted, 0);
+            reader_ = nullptr;
+        }
+
+        peer = peer_.lock();
+        peer_.reset();
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (peer)
+        peer->disconnect();
+}
+
+// private
+void pipe_transport::start_read(const mutable_buffer& buffer,
+    io_handler handler, bool partial)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (stopped_)
+    {
+        post(handler, boost::asio::error::operation_aborted, 0);
+        return;
+    }
+
+    BITCOIN_ASSERT_MSG(!reader_, "Concurrent pipe reads.");
+    reading_ = buffer;
+    partial_ = partial;
+    reader_ = std::move(handler);
+    complete_read();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Append the bytes written by the peer, returns false if stopped.
+bool pipe_transport::deliver(const const_buffers& buffers)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (stopped_ || disconnected_)
+        return false;
+
+    for (const auto& buffer: buffers)
+    {
+        const auto begin = buffer_cast<const uint8_t*>(buffer);
+        received_.insert(received_.end(), begin, begin + buffer_size(buffer));
+    }
+
+    complete_read();
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The peer stopped, remaining bytes may still be read.
+void pipe_transport::disconnect()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    disconnected_ = true;
+    peer_.reset();
+    complete_read();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// This must be called under the exclusive lock.
+void pipe_transport::complete_read()
+{
+    if (!reader_)
+        return;
+
+    const auto capacity = buffer_size(reading_);
+    const auto required = partial_ ? std::min<size_t>(capacity, 1) : capacity;
+
+    if (received_.size() >= required)
+    {
+        const auto size = std::min(capacity, received_.size());
+        const auto end = received_.begin() + size;
+        std::copy(received_.begin(), end, buffer_cast<uint8_t*>(reading_));
+        received_.erase(received_.begin(), end);
+        post(std::move(reader_), boost_code(), size);
+        reader_ = nullptr;
+        return;
+    }
+
+    if (disconnected_)
+    {
+        post(std::move(reader_), boost::asio::error::eof, 0);
+        reader_ = nullptr;
+    }
+}
+
+// Completions are posted, so they never run within the caller's lock.
+void pipe_transport::post(io_handler handler, const boost_code& ec,
+    size_t size)
+{
+    pool_.service().post(std::bind(handler, ec, size));
+}
+
+} // namespace network
+} // namespace libbitcoin
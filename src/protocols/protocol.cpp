@@ -30,8 +30,8 @@ namespace network {
 #define NAME "protocol"
 
 protocol::protocol(p2p& network, channel::ptr channel, const std::string& name)
-  : pool_(network.thread_pool()),
-    dispatch_(network.thread_pool(), NAME),
+  : pool_(channel->thread_pool()),
+    dispatch_(channel->thread_pool(), NAME),
     channel_(channel),
     name_(name)
 {
@@ -62,6 +62,21 @@ void protocol::set_peer_version(version_const_ptr value)
     channel_->set_peer_version(value);
 }
 
+void protocol::record_round_trip(const asio::duration& value)
+{
+    channel_->record_round_trip(value);
+}
+
+bool protocol::known_inventory(const hash_digest& hash) const
+{
+    return channel_->known_inventory(hash);
+}
+
+bool protocol::remember_inventory(const hash_digest& hash)
+{
+    return channel_->remember_inventory(hash);
+}
+
 uint32_t protocol::negotiated_version() const
 {
     return channel_->negotiated_version();
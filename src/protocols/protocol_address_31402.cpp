@@ -18,6 +18,9 @@
  */
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <functional>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/channel.hpp>
@@ -48,6 +51,8 @@ protocol_address_31402::protocol_address_31402(p2p& network,
   : protocol_events(network, channel, NAME),
     network_(network),
     self_(configured_self(network_.network_settings())),
+    tokens_(static_cast<double>(max_address)),
+    refilled_(clock::now()),
     CONSTRUCT_TRACK(protocol_address_31402)
 {
 }
@@ -85,12 +90,24 @@ bool protocol_address_31402::handle_receive_address(const code& ec,
     if (stopped(ec))
         return false;
 
+    const auto& addresses = message->addresses();
+    const auto accepted = admit(addresses.size());
+
     LOG_DEBUG(LOG_NETWORK)
-        << "Storing addresses from [" << authority() << "] ("
-        << message->addresses().size() << ")";
+        << "Storing addresses from [" << authority() << "] (" << accepted
+        << " of " << addresses.size() << ")";
 
-    // TODO: manage timestamps (active channels are connected < 3 hours ago).
-    network_.store(message->addresses(), BIND1(handle_store_addresses, _1));
+    // Absent or future timestamps are aged by the host pool upon store.
+    if (accepted == addresses.size())
+    {
+        network_.store(addresses, BIND1(handle_store_addresses, _1));
+    }
+    else if (accepted != 0)
+    {
+        const network_address::list subset(addresses.begin(),
+            addresses.begin() + accepted);
+        network_.store(subset, BIND1(handle_store_addresses, _1));
+    }
 
     // RESUBSCRIBE
     return true;
@@ -102,23 +119,50 @@ bool protocol_address_31402::handle_receive_get_address(const code& ec,
     if (stopped(ec))
         return false;
 
-    bc::message::network_address::list addresses;
-    network_.fetch_addresses(addresses);
+    // The response is shared by all peers and refreshed periodically.
+    const auto payload = network_.address_payload(negotiated_version());
 
-    if (!addresses.empty())
+    if (payload)
     {
-        const address address_subset(addresses);
-        SEND2(address_subset, handle_send, _1, self_.command);
+        send_payload<CLASS>(address::command, payload,
+            &CLASS::handle_send, _1, address::command);
 
         LOG_DEBUG(LOG_NETWORK)
-            << "Sending addresses to [" << authority() << "] ("
-            << self_.addresses().size() << ")";
+            << "Sending addresses to [" << authority() << "]";
     }
 
     // do not resubscribe; one response per connection permitted
     return false;
 }
 
+// A token bucket per peer, refilled at the configured rate and holding up to
+// one full address message, so that a peer cannot flood the host pool.
+size_t protocol_address_31402::admit(size_t count)
+{
+    const auto& settings = network_.network_settings();
+    const auto per_minute = settings.address_accepts_per_minute;
+
+    if (per_minute == 0)
+        return count;
+
+    const auto rate = per_minute / 60.0;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto now = clock::now();
+    const std::chrono::duration<double> elapsed = now - refilled_;
+    refilled_ = now;
+    tokens_ = std::min(static_cast<double>(max_address),
+        tokens_ + elapsed.count() * rate);
+
+    const auto taken = std::min(count, static_cast<size_t>(tokens_));
+    tokens_ -= taken;
+    return taken;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
 void protocol_address_31402::handle_store_addresses(const code& ec)
 {
     if (stopped(ec))
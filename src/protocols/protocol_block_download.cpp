@@ -0,0 +1,247 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/protocols/protocol_block_download.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/block_download.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_timer.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "block_download"
+#define CLASS protocol_block_download
+
+using namespace bc::message;
+using namespace std::placeholders;
+
+// A window of one would idle the peer for a round trip between blocks.
+const size_t protocol_block_download::minimum_window = 2;
+
+static bool is_witness(const settings& settings, version_const_ptr peer)
+{
+    const auto witness = version::service::node_witness;
+    return (settings.services & witness) != 0 && peer &&
+        (peer->services() & witness) != 0;
+}
+
+// The timer is perpetual, each period must see a block if any is requested.
+protocol_block_download::protocol_block_download(p2p& network,
+    channel::ptr channel, block_download::ptr download)
+  : protocol_timer(network, channel, true, NAME),
+    network_(network),
+    download_(download),
+    witness_(is_witness(network.network_settings(), channel->peer_version())),
+    maximum_window_(std::max<size_t>(minimum_window,
+        network.network_settings().block_download_window)),
+    window_(minimum_window),
+    received_(0),
+    rate_(0),
+    CONSTRUCT_TRACK(protocol_block_download)
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void protocol_block_download::start(event_handler handler)
+{
+    const auto& settings = network_.network_settings();
+
+    protocol_timer::start(settings.block_download_stall(),
+        BIND2(handle_event, _1, handler));
+
+    SUBSCRIBE3(block, handle_receive_block, _1, _2, handler);
+    request_blocks(handler);
+}
+
+// Protocol.
+// ----------------------------------------------------------------------------
+
+// An idle channel retries upon each timer event, taking released blocks.
+void protocol_block_download::request_blocks(event_handler complete)
+{
+    block_download::items claimed;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    const size_t window = window_;
+    const auto outstanding = outstanding_.size();
+
+    if (outstanding < window)
+    {
+        download_->claim(window - outstanding, claimed);
+        outstanding_.insert(outstanding_.end(), claimed.begin(),
+            claimed.end());
+    }
+
+    const auto idle = outstanding_.empty();
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (idle && download_->complete())
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Stopping completed block download [" << authority() << "]";
+        complete(error::success);
+        stop(error::channel_stopped);
+        return;
+    }
+
+    if (claimed.empty())
+        return;
+
+    const auto type = witness_ ? inventory_vector::type_id::witness_block :
+        inventory_vector::type_id::block;
+
+    inventory_vector::list inventories;
+    inventories.reserve(claimed.size());
+
+    for (const auto& item: claimed)
+        inventories.emplace_back(type, item.second);
+
+    SEND2(get_data{ std::move(inventories) }, handle_send, _1,
+        get_data::command);
+}
+
+void protocol_block_download::handle_event(const code& ec,
+    event_handler complete)
+{
+    if (stopped(ec))
+    {
+        release();
+        return;
+    }
+
+    if (ec && ec != error::channel_timeout)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure in block download timer for [" << authority() << "] "
+            << ec.message();
+        stop(ec);
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+    const auto waiting = !outstanding_.empty();
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto received = received_.exchange(0);
+
+    if (waiting && received == 0)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Block download stalled on [" << authority() << "]";
+        stop(error::channel_timeout);
+        return;
+    }
+
+    update_window(received);
+    request_blocks(complete);
+}
+
+bool protocol_block_download::handle_receive_block(const code& ec,
+    block_const_ptr message, event_handler complete)
+{
+    if (stopped(ec))
+        return false;
+
+    // Announcements and blocks requested by other protocols are not counted.
+    if (!remove(message->header().hash()))
+        return true;
+
+    ++received_;
+    download_->accept(message, BIND1(handle_rejected, _1));
+    request_blocks(complete);
+    return true;
+}
+
+// The block may be rejected upon delivery of a block from another channel.
+void protocol_block_download::handle_rejected(const code& ec)
+{
+    LOG_DEBUG(LOG_NETWORK)
+        << "Failure downloading block from [" << authority() << "] "
+        << ec.message();
+    stop(ec);
+}
+
+// private
+// ----------------------------------------------------------------------------
+
+bool protocol_block_download::remove(const hash_digest& hash)
+{
+    const auto match = [&hash](const block_download::item& item)
+    {
+        return item.second == hash;
+    };
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto it = std::find_if(outstanding_.begin(), outstanding_.end(),
+        match);
+
+    if (it == outstanding_.end())
+        return false;
+
+    outstanding_.erase(it);
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// The rate is a moving average of blocks per period, rounded up so that a
+// steady single block per period is not truncated to zero.
+void protocol_block_download::update_window(size_t received)
+{
+    const size_t rate = rate_;
+    const auto average = (3 * rate + received + 3) / 4;
+    rate_ = average;
+    window_ = std::min(std::max(average, minimum_window), maximum_window_);
+}
+
+void protocol_block_download::release()
+{
+    block_download::items outstanding;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    outstanding.swap(outstanding_);
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!outstanding.empty())
+        download_->release(outstanding);
+}
+
+} // namespace network
+} // namespace libbitcoin
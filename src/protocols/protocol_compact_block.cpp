@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/protocols/protocol_compact_block.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/partial_block.hpp>
+#include <bitcoin/network/protocols/protocol_events.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "compact_block"
+#define CLASS protocol_compact_block
+
+using namespace bc::message;
+using namespace std::placeholders;
+
+// Version 2 compact blocks identify transactions by witness hash.
+static const uint64_t compact_version_legacy = 1;
+static const uint64_t compact_version_witness = 2;
+
+static bool is_witness(const network::settings& settings)
+{
+    return (settings.services & version::service::node_witness) != 0;
+}
+
+protocol_compact_block::protocol_compact_block(p2p& network,
+    channel::ptr channel, bool high_bandwidth,
+    partial_block::transaction_pool pool, block_handler handler)
+  : protocol_events(network, channel, NAME),
+    witness_(is_witness(network.network_settings())),
+    high_bandwidth_(high_bandwidth),
+    compact_version_(witness_ ? compact_version_witness :
+        compact_version_legacy),
+    pool_(pool),
+    handler_(handler),
+    compatible_(false),
+    CONSTRUCT_TRACK(protocol_compact_block)
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void protocol_compact_block::start()
+{
+    // Must have a handler to capture a shared self pointer in stop subscriber.
+    protocol_events::start(BIND1(handle_stop, _1));
+
+    if (negotiated_version() < version::level::bip152)
+        return;
+
+    SUBSCRIBE2(send_compact, handle_receive_send_compact, _1, _2);
+    SUBSCRIBE2(compact_block, handle_receive_compact_block, _1, _2);
+    SUBSCRIBE2(block_transactions, handle_receive_block_transactions, _1, _2);
+    SEND2((send_compact{ high_bandwidth_, compact_version_ }), handle_send,
+        _1, send_compact::command);
+}
+
+// Protocol.
+// ----------------------------------------------------------------------------
+
+// Compact blocks are accepted once the peer announces the same version.
+bool protocol_compact_block::handle_receive_send_compact(const code& ec,
+    send_compact_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    if (message->version() == compact_version_)
+        compatible_ = true;
+
+    return true;
+}
+
+bool protocol_compact_block::handle_receive_compact_block(const code& ec,
+    compact_block_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    if (!compatible_)
+        return true;
+
+    const auto block = std::make_shared<partial_block>(*message, witness_);
+
+    if (!block->valid())
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Invalid compact block from [" << authority() << "]";
+        request_block(block->hash());
+        return true;
+    }
+
+    block->populate(pool_);
+
+    if (block->missing() == 0)
+    {
+        complete(block);
+        return true;
+    }
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Requesting " << block->missing() << " transactions of compact "
+        << "block [" << encode_hash(block->hash()) << "] from ["
+        << authority() << "]";
+
+    // A newer compact block supersedes one awaiting transactions.
+    exchange_pending(block);
+    SEND2(block->request(), handle_send, _1,
+        get_block_transactions::command);
+    return true;
+}
+
+bool protocol_compact_block::handle_receive_block_transactions(
+    const code& ec, block_transactions_const_ptr message)
+{
+    if (stopped(ec))
+        return false;
+
+    const auto block = exchange_pending({});
+
+    if (!block)
+        return true;
+
+    if (block->hash() != message->block_hash())
+    {
+        exchange_pending(block);
+        return true;
+    }
+
+    const auto result = block->fill(*message);
+
+    if (result)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Invalid block transactions from [" << authority() << "] "
+            << result.message();
+        stop(result);
+        return false;
+    }
+
+    complete(block);
+    return true;
+}
+
+void protocol_compact_block::handle_stop(const code&)
+{
+    exchange_pending({});
+}
+
+// private
+partial_block::ptr protocol_compact_block::exchange_pending(
+    partial_block::ptr block)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    pending_.swap(block);
+    return block;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+void protocol_compact_block::complete(partial_block::ptr block)
+{
+    const auto full = block->block();
+
+    // A short id collision yields a bad merkle root, not a bad peer.
+    if (!full)
+    {
+        request_block(block->hash());
+        return;
+    }
+
+    handler_(full);
+}
+
+// private
+void protocol_compact_block::request_block(const hash_digest& hash)
+{
+    const auto type = witness_ ? inventory_vector::type_id::witness_block :
+        inventory_vector::type_id::block;
+
+    inventory_vector::list inventories{ { type, hash } };
+    SEND2(get_data{ std::move(inventories) }, handle_send, _1,
+        get_data::command);
+}
+
+} // namespace network
+} // namespace libbitcoin
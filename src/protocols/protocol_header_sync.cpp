@@ -0,0 +1,186 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/protocols/protocol_header_sync.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/header_sync.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_timer.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "header_sync"
+#define CLASS protocol_header_sync
+
+using namespace bc::message;
+using namespace std::placeholders;
+
+const size_t protocol_header_sync::unassigned = max_size_t;
+
+// The timer is perpetual, each period must see a response to the request.
+protocol_header_sync::protocol_header_sync(p2p& network,
+    channel::ptr channel, header_sync::ptr sync)
+  : protocol_timer(network, channel, true, NAME),
+    network_(network),
+    sync_(sync),
+    range_(unassigned),
+    received_(false),
+    CONSTRUCT_TRACK(protocol_header_sync)
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void protocol_header_sync::start(event_handler handler)
+{
+    const auto& settings = network_.network_settings();
+
+    protocol_timer::start(settings.header_sync_stall(),
+        BIND2(handle_event, _1, handler));
+
+    SUBSCRIBE3(headers, handle_receive_headers, _1, _2, handler);
+    next_range(handler);
+}
+
+// Protocol.
+// ----------------------------------------------------------------------------
+
+// An idle channel retries upon each timer event, taking a released range.
+void protocol_header_sync::next_range(event_handler complete)
+{
+    size_t range;
+
+    if (!sync_->assign(range))
+    {
+        if (sync_->complete())
+        {
+            LOG_DEBUG(LOG_NETWORK)
+                << "Stopping completed header sync [" << authority() << "]";
+            complete(error::success);
+            stop(error::channel_stopped);
+        }
+
+        return;
+    }
+
+    range_ = range;
+    received_ = true;
+    SEND2(sync_->request(range), handle_send, _1, get_headers::command);
+}
+
+void protocol_header_sync::handle_event(const code& ec,
+    event_handler complete)
+{
+    if (stopped(ec))
+    {
+        release();
+        return;
+    }
+
+    if (ec && ec != error::channel_timeout)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure in header sync timer for [" << authority() << "] "
+            << ec.message();
+        stop(ec);
+        return;
+    }
+
+    if (range_ == unassigned)
+    {
+        next_range(complete);
+        return;
+    }
+
+    if (!received_.exchange(false))
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Header sync stalled on [" << authority() << "]";
+        stop(error::channel_timeout);
+    }
+}
+
+bool protocol_header_sync::handle_receive_headers(const code& ec,
+    headers_const_ptr message, event_handler complete)
+{
+    if (stopped(ec))
+        return false;
+
+    const size_t range = range_;
+
+    // Announcements are not requested and do not count as progress.
+    if (range == unassigned)
+        return true;
+
+    received_ = true;
+    const auto& elements = message->elements();
+    const auto stop_hash = sync_->stop_hash(range);
+
+    // Request the next headers of the range before storing these.
+    const auto pipelined = elements.size() == max_get_headers &&
+        elements.back().hash() != stop_hash;
+
+    if (pipelined)
+        SEND2((get_headers{ { elements.back().hash() }, stop_hash }),
+            handle_send, _1, get_headers::command);
+
+    bool done;
+    const auto result = sync_->accept(range, *message, done);
+
+    if (result)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure syncing headers from [" << authority() << "] "
+            << result.message();
+        stop(result);
+        return false;
+    }
+
+    network_.set_top_header(sync_->top());
+
+    if (done)
+    {
+        release();
+        next_range(complete);
+        return true;
+    }
+
+    if (!pipelined)
+        SEND2(sync_->request(range), handle_send, _1, get_headers::command);
+
+    return true;
+}
+
+// private
+void protocol_header_sync::release()
+{
+    const auto range = range_.exchange(unassigned);
+
+    if (range != unassigned)
+        sync_->release(range);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/protocols/protocol_inventory_relay.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel.hpp>
+#include <bitcoin/network/define.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_timer.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define NAME "inventory_relay"
+#define CLASS protocol_inventory_relay
+
+using namespace bc::message;
+using namespace std::placeholders;
+
+// A peer that does not signal relay (bip37) does not want transactions.
+static bool relays_transactions(version_const_ptr peer)
+{
+    return !peer || peer->value() < version::level::bip37 || peer->relay();
+}
+
+static size_t batch_size(const network::settings& settings)
+{
+    return std::max<size_t>(1, std::min<size_t>(max_inventory,
+        settings.inventory_relay_batch));
+}
+
+// The timer is perpetual, each period flushes any pending announcements.
+protocol_inventory_relay::protocol_inventory_relay(p2p& network,
+    channel::ptr channel)
+  : protocol_timer(network, channel, true, NAME),
+    network_(network),
+    batch_(batch_size(network.network_settings())),
+    relay_transactions_(relays_transactions(channel->peer_version())),
+    announcement_(0),
+    CONSTRUCT_TRACK(protocol_inventory_relay)
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void protocol_inventory_relay::start()
+{
+    const auto& settings = network_.network_settings();
+
+    protocol_timer::start(settings.inventory_relay(),
+        BIND1(handle_event, _1));
+
+    announcement_.store(network_.subscribe_announcement(
+        BIND2(handle_announcement, _1, _2)));
+
+    // A subscription concurrent with stop would otherwise remain.
+    if (stopped())
+        unsubscribe();
+}
+
+// private
+void protocol_inventory_relay::unsubscribe()
+{
+    const auto key = announcement_.exchange(0);
+
+    if (key != 0)
+        network_.unsubscribe_announcement(key);
+}
+
+// Protocol.
+// ----------------------------------------------------------------------------
+
+void protocol_inventory_relay::handle_event(const code& ec)
+{
+    // The subscription holds this protocol and its channel until released.
+    if (ec == error::channel_stopped)
+        unsubscribe();
+
+    if (stopped(ec))
+        return;
+
+    if (ec && ec != error::channel_timeout)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure in inventory relay timer for [" << authority() << "] "
+            << ec.message();
+        stop(ec);
+        return;
+    }
+
+    flush();
+}
+
+bool protocol_inventory_relay::handle_announcement(const code& ec,
+    const inventory_vector& inventory)
+{
+    if (stopped(ec))
+        return false;
+
+    if (inventory.is_transaction_type() && !relay_transactions_)
+        return true;
+
+    if (known_inventory(inventory.hash()))
+        return true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    // Pending inventory is not known until sent, so it is queued only once.
+    if (!queued_.insert(inventory.hash()).second)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return true;
+    }
+
+    pending_.push_back(inventory);
+    const auto full = pending_.size() >= batch_;
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (full)
+        flush();
+
+    return true;
+}
+
+// private
+void protocol_inventory_relay::flush()
+{
+    inventory_vector::list pending;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    pending.swap(pending_);
+    queued_.clear();
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (pending.empty())
+        return;
+
+    LOG_VERBOSE(LOG_NETWORK)
+        << "Relaying inventory to [" << authority() << "] ("
+        << pending.size() << ")";
+
+    hash_list hashes;
+    hashes.reserve(pending.size());
+
+    for (const auto& inventory: pending)
+        hashes.push_back(inventory.hash());
+
+    SEND2(inventory{ std::move(pending) }, handle_relayed, _1,
+        std::move(hashes));
+}
+
+// private
+// A failed or dropped send leaves the inventory unknown, for a later relay.
+void protocol_inventory_relay::handle_relayed(const code& ec,
+    const hash_list& hashes)
+{
+    if (ec)
+        return;
+
+    for (const auto& hash: hashes)
+        remember_inventory(hash);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -18,6 +18,7 @@
  */
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -66,6 +67,8 @@ void protocol_ping_60001::send_ping(const code& ec)
         return;
     }
 
+    // The round trip includes time in the send queue, as does propagation.
+    sent_ = clock::now();
     pending_ = true;
     const auto nonce = pseudo_random::next();
     SUBSCRIBE3(pong, handle_receive_pong, _1, _2, nonce);
@@ -121,16 +124,17 @@ bool protocol_ping_60001::handle_receive_pong(const code& ec,
         return false;
     }
 
-    pending_ = false;
-
     if (message->nonce() != nonce)
     {
+        pending_ = false;
         LOG_WARNING(LOG_NETWORK)
             << "Invalid pong nonce from [" << authority() << "]";
         stop(error::bad_stream);
         return false;
     }
 
+    record_round_trip(clock::now() - sent_);
+    pending_ = false;
     return false;
 }
 
@@ -100,7 +100,7 @@ bool protocol_seed_31402::handle_receive_address(const code& ec,
         << "Storing addresses from seed [" << authority() << "] ("
         << message->addresses().size() << ")";
 
-    // TODO: manage timestamps (active channels are connected < 3 hours ago).
+    // Absent or future timestamps are aged by the host pool upon store.
     network_.store(message->addresses(), BIND1(handle_store_addresses, _1));
     return false;
 }
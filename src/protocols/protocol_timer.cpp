@@ -18,6 +18,7 @@
  */
 #include <bitcoin/network/protocols/protocol_timer.hpp>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <string>
@@ -25,6 +26,7 @@
 #include <bitcoin/network/channel.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/protocols/protocol_events.hpp>
+#include <bitcoin/network/timer_wheel.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -35,7 +37,10 @@ using namespace std::placeholders;
 protocol_timer::protocol_timer(p2p& network, channel::ptr channel,
     bool perpetual, const std::string& name)
   : protocol_events(network, channel, name),
-    perpetual_(perpetual)
+    perpetual_(perpetual),
+    timers_(network.timers()),
+    timeout_(asio::duration::zero()),
+    timer_(0)
 {
 }
 
@@ -46,8 +51,8 @@ protocol_timer::protocol_timer(p2p& network, channel::ptr channel,
 void protocol_timer::start(const asio::duration& timeout,
     event_handler handle_event)
 {
-    // The deadline timer is thread safe.
-    timer_ = std::make_shared<deadline>(pool(), timeout);
+    // The timer of the shared wheel is set upon each reset.
+    timeout_ = timeout;
     protocol_events::start(BIND2(handle_notify, _1, handle_event));
     reset_timer();
 }
@@ -55,7 +60,7 @@ void protocol_timer::start(const asio::duration& timeout,
 void protocol_timer::handle_notify(const code& ec, event_handler handler)
 {
     if (ec == error::channel_stopped)
-        timer_->stop();
+        timers_->cancel(timer_.exchange(0));
 
     handler(ec);
 }
@@ -69,12 +74,18 @@ void protocol_timer::reset_timer()
     if (stopped())
         return;
 
-    timer_->start(BIND1(handle_timer, _1));
+    // The previous timer is canceled, as a reset may precede its expiry.
+    timers_->cancel(timer_.exchange(timers_->schedule(pool(), timeout_,
+        BIND1(handle_timer, _1))));
+
+    // A timer set concurrently with stop would otherwise remain scheduled.
+    if (stopped())
+        timers_->cancel(timer_.exchange(0));
 }
 
 void protocol_timer::handle_timer(const code& ec)
 {
-    if (stopped())
+    if (stopped() || ec == error::service_stopped)
         return;
 
     LOG_VERBOSE(LOG_NETWORK)
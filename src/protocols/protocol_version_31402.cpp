@@ -57,6 +57,17 @@ protocol_version_31402::protocol_version_31402(p2p& network,
     channel::ptr channel, uint32_t own_version, uint64_t own_services,
     uint64_t invalid_services, uint32_t minimum_version,
     uint64_t minimum_services)
+  : protocol_version_31402(network, channel, own_version, own_services,
+        invalid_services, minimum_version, minimum_services,
+        make_template(network.network_settings(), own_version, own_services,
+            false))
+{
+}
+
+protocol_version_31402::protocol_version_31402(p2p& network,
+    channel::ptr channel, uint32_t own_version, uint64_t own_services,
+    uint64_t invalid_services, uint32_t minimum_version,
+    uint64_t minimum_services, version_const_ptr prototype)
   : protocol_timer(network, channel, false, NAME),
     network_(network),
     own_version_(own_version),
@@ -64,6 +75,10 @@ protocol_version_31402::protocol_version_31402(p2p& network,
     invalid_services_(invalid_services),
     minimum_version_(minimum_version),
     minimum_services_(minimum_services),
+    prototype_(prototype),
+    received_version_(false),
+    received_verack_(false),
+    completed_(false),
     CONSTRUCT_TRACK(protocol_version_31402)
 {
 }
@@ -73,40 +88,60 @@ protocol_version_31402::protocol_version_31402(p2p& network,
 
 void protocol_version_31402::start(event_handler handler)
 {
-    const auto period = network_.network_settings().channel_handshake();
+    const auto& settings = network_.network_settings();
+    const auto period = settings.channel_handshake();
 
-    const auto join_handler = synchronize(handler, 2, NAME,
-        synchronizer_terminate::on_error);
+    if (settings.channel_handshake_pipelining)
+    {
+        // The handler is invoked in the context of the version receipt.
+        protocol_timer::start(period,
+            BIND2(handle_pipelined_event, _1, handler));
+    }
+    else
+    {
+        const auto join_handler = synchronize(handler, 2, NAME,
+            synchronizer_terminate::on_error);
 
-    // The handler is invoked in the context of the last message receipt.
-    protocol_timer::start(period, join_handler);
+        // The handler is invoked in the context of the last message receipt.
+        protocol_timer::start(period, join_handler);
+    }
 
     SUBSCRIBE2(version, handle_receive_version, _1, _2);
     SUBSCRIBE2(verack, handle_receive_verack, _1, _2);
     SEND2(version_factory(), handle_send, _1, version::command);
 }
 
+version_const_ptr protocol_version_31402::make_template(
+    const settings& settings, uint32_t own_version, uint64_t own_services,
+    bool relay)
+{
+    const auto version = std::make_shared<message::version>();
+    version->set_value(own_version);
+    version->set_services(own_services);
+    version->set_address_sender(settings.self.to_network_address());
+    version->set_user_agent(BC_USER_AGENT);
+    version->set_relay(relay);
+
+    // The peer's services cannot be reflected, so zero it.
+    version->address_receiver().set_services(version::service::none);
+
+    // We always match the services declared in our version.services.
+    version->address_sender().set_services(own_services);
+    return version;
+}
+
+// Only the fields that vary by channel are set on a copy of the template.
 message::version protocol_version_31402::version_factory() const
 {
-    const auto& settings = network_.network_settings();
     const auto height = network_.top_block().height();
     BITCOIN_ASSERT_MSG(height <= max_uint32, "Time to upgrade the protocol.");
 
-    message::version version;
-    version.set_value(own_version_);
-    version.set_services(own_services_);
+    auto version = *prototype_;
     version.set_timestamp(static_cast<uint64_t>(zulu_time()));
     version.set_address_receiver(authority().to_network_address());
-    version.set_address_sender(settings.self.to_network_address());
+    version.address_receiver().set_services(version::service::none);
     version.set_nonce(nonce());
-    version.set_user_agent(BC_USER_AGENT);
     version.set_start_height(static_cast<uint32_t>(height));
-
-    // The peer's services cannot be reflected, so zero it.
-    version.address_receiver().set_services(version::service::none);
-
-    // We always match the services declared in our version.services.
-    version.address_sender().set_services(own_services_);
     return version;
 }
 
@@ -132,40 +167,6 @@ bool protocol_version_31402::handle_receive_version(const code& ec,
         << "Peer [" << authority() << "] protocol version ("
         << message->value() << ") user agent: " << message->user_agent();
 
-    // TODO: move these three checks to initialization.
-    //-------------------------------------------------------------------------
-
-    const auto& settings = network_.network_settings();
-
-    if (settings.protocol_minimum < version::level::minimum)
-    {
-        LOG_ERROR(LOG_NETWORK)
-            << "Invalid protocol version configuration, minimum below ("
-            << version::level::minimum << ").";
-        set_event(error::channel_stopped);
-        return false;
-    }
-
-    if (settings.protocol_maximum > version::level::maximum)
-    {
-        LOG_ERROR(LOG_NETWORK)
-            << "Invalid protocol version configuration, maximum above ("
-            << version::level::maximum << ").";
-        set_event(error::channel_stopped);
-        return false;
-    }
-
-    if (settings.protocol_minimum > settings.protocol_maximum)
-    {
-        LOG_ERROR(LOG_NETWORK)
-            << "Invalid protocol version configuration, "
-            << "minimum exceeds maximum.";
-        set_event(error::channel_stopped);
-        return false;
-    }
-
-    //-------------------------------------------------------------------------
-
     if (!sufficient_peer(message))
     {
         set_event(error::channel_stopped);
@@ -183,6 +184,7 @@ bool protocol_version_31402::handle_receive_version(const code& ec,
     SEND2(verack(), handle_send, _1, verack::command);
 
     // 1 of 2
+    received_version_ = true;
     set_event(error::success);
     return false;
 }
@@ -232,9 +234,39 @@ bool protocol_version_31402::handle_receive_verack(const code& ec,
     }
 
     // 2 of 2
+    received_verack_ = true;
     set_event(error::success);
     return false;
 }
 
+// private
+// Events are the version, verack, failures, stop and the handshake timer.
+// The handshake completes upon version or failure, and a later failure or
+// timeout prior to verack stops the channel as there is no longer a handler.
+void protocol_version_31402::handle_pipelined_event(const code& ec,
+    event_handler handler)
+{
+    if (!completed_)
+    {
+        // A verack that precedes the version does not complete the handshake.
+        if (!ec && !received_version_)
+            return;
+
+        if (!completed_.exchange(true))
+        {
+            handler(ec);
+            return;
+        }
+    }
+
+    if (!ec || received_verack_ || stopped(ec))
+        return;
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Failure awaiting pipelined verack from [" << authority() << "] "
+        << ec.message();
+    stop(ec);
+}
+
 } // namespace network
 } // namespace libbitcoin
@@ -57,8 +57,19 @@ protocol_version_70002::protocol_version_70002(p2p& network,
     channel::ptr channel, uint32_t own_version, uint64_t own_services,
     uint64_t invalid_services, uint32_t minimum_version,
     uint64_t minimum_services, bool relay)
+  : protocol_version_70002(network, channel, own_version, own_services,
+        invalid_services, minimum_version, minimum_services, relay,
+        make_template(network.network_settings(), own_version, own_services,
+            relay))
+{
+}
+
+protocol_version_70002::protocol_version_70002(p2p& network,
+    channel::ptr channel, uint32_t own_version, uint64_t own_services,
+    uint64_t invalid_services, uint32_t minimum_version,
+    uint64_t minimum_services, bool relay, version_const_ptr prototype)
   : protocol_version_31402(network, channel, own_version, own_services,
-        invalid_services, minimum_version, minimum_services),
+        invalid_services, minimum_version, minimum_services, prototype),
     relay_(relay),
     CONSTRUCT_TRACK(protocol_version_70002)
 {
@@ -74,15 +85,6 @@ void protocol_version_70002::start(event_handler handler)
     SUBSCRIBE2(reject, handle_receive_reject, _1, _2);
 }
 
-message::version protocol_version_70002::version_factory() const
-{
-    auto version = protocol_version_31402::version_factory();
-
-    // This is the only difference at protocol level 70001.
-    version.set_relay(relay_);
-    return version;
-}
-
 // Protocol.
 // ----------------------------------------------------------------------------
 
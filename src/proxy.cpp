@@ -21,15 +21,19 @@
 #define BOOST_BIND_NO_PLACEHOLDERS
 
 #include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/checksum.hpp>
 #include <bitcoin/network/define.hpp>
 #include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/transport.hpp>
 
 namespace libbitcoin {
 namespace network {
@@ -40,19 +44,56 @@ using namespace std::placeholders;
 using namespace boost::asio;
 using namespace bc::message;
 
+// The rate of inventory not sent because it is falsely considered known.
+static const double known_false_positive_rate = 0.000001;
+
 // Dump up to 1k of payload as hex in order to diagnose failure.
 static const size_t invalid_payload_dump_size = 1024;
 
-// payload_buffer_ sizing assumes monotonically increasing size by version.
-// Initialize to pre-witness max payload and let grow to witness as required.
-// The socket owns the single thread on which this channel reads and writes.
-proxy::proxy(threadpool& pool, socket::ptr socket, const settings& settings)
-  : authority_(socket->authority()),
+// These may be dropped when the send queue is saturated.
+static bool low_priority(const std::string& command)
+{
+    return command == inventory::command || command == address::command;
+}
+
+// These high volume messages are decoded directly from the payload buffer.
+static bool contiguous_decode(message_type type)
+{
+    return type == message_type::block || type == message_type::headers ||
+        type == message_type::inventory || type == message_type::transaction;
+}
+
+// Messages that relay chain or pool data, as opposed to session control.
+static bool useful_message(message_type type)
+{
+    return contiguous_decode(type) || type == message_type::merkle_block ||
+        type == message_type::compact_block ||
+        type == message_type::block_transactions;
+}
+
+// payload_buffer_ is drawn from the shared pool only for the payload read.
+// read_buffer_ holds bytes read ahead of the message being parsed, and is
+// also drawn from the pool, so that it is reused by a subsequent channel.
+// The transport owns the single thread on which this channel reads and writes.
+proxy::proxy(threadpool& pool, transport::ptr transport,
+    const settings& settings, buffer_pool::ptr buffers)
+  : pool_(pool),
+    authority_(transport->authority()),
+    authority_text_(authority_.to_string()),
     heading_buffer_(heading::maximum_size()),
-    payload_buffer_(heading::maximum_payload_size(settings.protocol_maximum, false)),
+    read_buffer_(buffers->get(std::max<size_t>(settings.read_buffer_bytes,
+        heading::maximum_size()))),
+    read_begin_(0),
+    read_end_(0),
+    payload_read_(0),
+    stream_decoder_(message_subscriber_),
     maximum_payload_(heading::maximum_payload_size(settings.protocol_maximum,
         (settings.services & version::service::node_witness) != 0)),
-    socket_(socket),
+    send_batch_bytes_(settings.send_batch_bytes),
+    send_high_water_bytes_(settings.send_high_water_bytes),
+    send_high_water_messages_(settings.send_high_water_messages),
+    transport_(transport),
+    buffers_(buffers),
     stopped_(true),
     protocol_magic_(settings.identifier),
     validate_checksum_(settings.validate_checksum),
@@ -60,7 +101,11 @@ proxy::proxy(threadpool& pool, socket::ptr socket, const settings& settings)
     version_(settings.protocol_maximum),
     message_subscriber_(pool),
     stop_subscriber_(std::make_shared<stop_subscriber>(pool, NAME "_sub")),
-    dispatch_(pool, NAME "_dispatch")
+    dispatch_(pool, NAME "_dispatch"),
+    known_inventory_(settings.known_inventory_capacity,
+        known_false_positive_rate),
+    sending_(false),
+    send_bytes_(0)
 {
 }
 
@@ -72,6 +117,11 @@ proxy::~proxy()
 // Properties.
 // ----------------------------------------------------------------------------
 
+threadpool& proxy::thread_pool()
+{
+    return pool_;
+}
+
 const config::authority& proxy::authority() const
 {
     return authority_;
@@ -87,6 +137,11 @@ void proxy::set_negotiated_version(uint32_t value)
     version_.store(value);
 }
 
+void proxy::set_validate_checksum(bool value)
+{
+    validate_checksum_.store(value);
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 
@@ -109,9 +164,27 @@ void proxy::start(result_handler handler)
     read_heading();
 }
 
-// Stop subscription.
+// Subscriptions.
 // ----------------------------------------------------------------------------
 
+void proxy::subscribe_payload(payload_handler&& handler)
+{
+    message_subscriber_.subscribe_payload(
+        std::forward<payload_handler>(handler));
+}
+
+void proxy::subscribe_block_stream(block_stream_handler&& handler)
+{
+    message_subscriber_.subscribe_block_stream(
+        std::forward<block_stream_handler>(handler));
+}
+
+void proxy::subscribe_headers_stream(headers_stream_handler&& handler)
+{
+    message_subscriber_.subscribe_headers_stream(
+        std::forward<headers_stream_handler>(handler));
+}
+
 void proxy::subscribe_stop(result_handler handler)
 {
     stop_subscriber_->subscribe(handler, error::channel_stopped);
@@ -120,17 +193,45 @@ void proxy::subscribe_stop(result_handler handler)
 // Read cycle (read continues until stop).
 // ----------------------------------------------------------------------------
 
+// Complete headings and payloads are parsed from the read buffer until it is
+// exhausted, and only then is a read issued. A payload that exceeds the
+// buffered bytes is completed by a read directly into its own buffer.
 void proxy::read_heading()
 {
-    if (stopped())
-        return;
+    const auto heading_size = heading_buffer_.size();
+    const auto begin = read_buffer_->begin();
 
-    async_read(socket_->get(), buffer(heading_buffer_),
-        std::bind(&proxy::handle_read_heading,
-            shared_from_this(), _1, _2));
+    while (!stopped())
+    {
+        const auto buffered = read_end_ - read_begin_;
+
+        if (buffered < heading_size)
+        {
+            // Move any partial heading to the front of the buffer.
+            std::copy(begin + read_begin_, begin + read_end_, begin);
+            read_begin_ = 0;
+            read_end_ = buffered;
+
+            transport_->read_some(
+                buffer(read_buffer_->data() + read_end_,
+                    read_buffer_->size() - read_end_),
+                std::bind(&proxy::handle_read_some,
+                    shared_from_this(), _1, _2));
+            return;
+        }
+
+        std::copy_n(begin + read_begin_, heading_size,
+            heading_buffer_.begin());
+        read_begin_ += heading_size;
+
+        const auto head = heading::factory(heading_buffer_);
+
+        if (!handle_heading(head) || !read_payload(head))
+            return;
+    }
 }
 
-void proxy::handle_read_heading(const boost_code& ec, size_t)
+void proxy::handle_read_some(const boost_code& ec, size_t size)
 {
     if (stopped())
         return;
@@ -138,20 +239,25 @@ void proxy::handle_read_heading(const boost_code& ec, size_t)
     if (ec)
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Heading read failure [" << authority() << "] "
+            << "Read failure [" << authority_text_ << "] "
             << code(error::boost_to_error_code(ec)).message();
         stop(ec);
         return;
     }
 
-    const auto head = heading::factory(heading_buffer_);
+    read_end_ += size;
+    read_heading();
+}
 
+// Returns false if the channel has been stopped.
+bool proxy::handle_heading(const heading& head)
+{
     if (!head.is_valid())
     {
         LOG_WARNING(LOG_NETWORK)
-            << "Invalid heading from [" << authority() << "]";
+            << "Invalid heading from [" << authority_text_ << "]";
         stop(error::bad_stream);
-        return;
+        return false;
     }
 
     if (head.magic() != protocol_magic_)
@@ -159,148 +265,601 @@ void proxy::handle_read_heading(const boost_code& ec, size_t)
         // These are common, with magic 542393671 coming from http requests.
         LOG_DEBUG(LOG_NETWORK)
             << "Invalid heading magic (" << head.magic() << ") from ["
-            << authority() << "]";
+            << authority_text_ << "]";
         stop(error::bad_stream);
-        return;
+        return false;
     }
 
     if (head.payload_size() > maximum_payload_)
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Oversized payload indicated by " << head.command()
-            << " heading from [" << authority() << "] ("
+            << " heading from [" << authority_text_ << "] ("
             << head.payload_size() << " bytes)";
         stop(error::bad_stream);
-        return;
+        return false;
     }
 
-    read_payload(head);
+    return true;
 }
 
-void proxy::read_payload(const heading& head)
+// Returns true if the payload was buffered and handled without stopping.
+bool proxy::read_payload(const heading& head)
+{
+    const size_t payload_size = head.payload_size();
+    const auto buffered = std::min(payload_size, read_end_ - read_begin_);
+    const auto begin = read_buffer_->begin() + read_begin_;
+
+    // The buffer is sized by class, so it is not reallocated by the read.
+    payload_buffer_ = buffers_->get(payload_size);
+    read_started_ = channel_metrics::clock::now();
+    std::copy_n(begin, buffered, payload_buffer_->begin());
+    read_begin_ += buffered;
+
+    // Stream subscribers are notified of the parts present, whole or not.
+    if (stream_decoder_.start(head.type(), version_, payload_size))
+        stream_decoder_.parse(payload_buffer_->data(), buffered);
+
+    if (buffered == payload_size)
+        return handle_payload(head, false);
+
+    // The read buffer is now empty, so the remainder bypasses it.
+    read_begin_ = 0;
+    read_end_ = 0;
+
+    // The remainder is hashed and decoded in parts as it arrives.
+    if (validate_checksum_ || stream_decoder_.streaming())
+    {
+        if (validate_checksum_)
+        {
+            payload_hasher_.reset();
+            payload_hasher_.update(payload_buffer_->data(), buffered);
+        }
+
+        payload_read_ = buffered;
+        read_payload_some(head);
+        return false;
+    }
+
+    transport_->read(
+        buffer(payload_buffer_->data() + buffered, payload_size - buffered),
+        std::bind(&proxy::handle_read_payload,
+            shared_from_this(), _1, _2, head));
+    return false;
+}
+
+void proxy::handle_read_payload(const boost_code& ec, size_t,
+    const heading& head)
 {
     if (stopped())
+    {
+        payload_buffer_.reset();
+        return;
+    }
+
+    if (ec)
+    {
+        payload_buffer_.reset();
+        LOG_DEBUG(LOG_NETWORK)
+            << "Payload read failure [" << authority_text_ << "] "
+            << code(error::boost_to_error_code(ec)).message();
+        stop(ec);
         return;
+    }
 
-    // This does not cause a reallocation.
-    payload_buffer_.resize(head.payload_size());
+    if (handle_payload(head, false))
+        read_heading();
+}
 
-    async_read(socket_->get(), buffer(payload_buffer_),
-        std::bind(&proxy::handle_read_payload,
+void proxy::read_payload_some(const heading& head)
+{
+    const auto data = payload_buffer_->data() + payload_read_;
+    const auto remaining = payload_buffer_->size() - payload_read_;
+
+    transport_->read_some(buffer(data, remaining),
+        std::bind(&proxy::handle_read_payload_some,
             shared_from_this(), _1, _2, head));
 }
 
-void proxy::handle_read_payload(const boost_code& ec, size_t payload_size,
+void proxy::handle_read_payload_some(const boost_code& ec, size_t size,
     const heading& head)
 {
     if (stopped())
+    {
+        payload_buffer_.reset();
         return;
+    }
 
     if (ec)
     {
+        payload_buffer_.reset();
         LOG_DEBUG(LOG_NETWORK)
-            << "Payload read failure [" << authority() << "] "
+            << "Payload read failure [" << authority_text_ << "] "
             << code(error::boost_to_error_code(ec)).message();
         stop(ec);
         return;
     }
 
-    // This is a pointless test but we allow it as an option for completeness.
-    if (validate_checksum_ &&
-        head.checksum() != bitcoin_checksum(payload_buffer_))
+    if (validate_checksum_)
+        payload_hasher_.update(payload_buffer_->data() + payload_read_, size);
+
+    payload_read_ += size;
+
+    if (stream_decoder_.streaming())
+        stream_decoder_.parse(payload_buffer_->data(), payload_read_);
+
+    if (payload_read_ < payload_buffer_->size())
     {
-        LOG_WARNING(LOG_NETWORK)
-            << "Invalid " << head.command() << " payload from [" << authority()
-            << "] bad checksum.";
-        stop(error::bad_stream);
+        read_payload_some(head);
         return;
     }
 
-    // Notify subscribers of the new message.
-    payload_source source(payload_buffer_);
-    payload_stream istream(source);
+    if (handle_payload(head, validate_checksum_))
+        read_heading();
+}
+
+// Returns false if the channel has been stopped.
+// If hashed the payload checksum was accumulated as the payload was read.
+bool proxy::handle_payload(const heading& head, bool hashed)
+{
+    // The buffer returns to the pool upon return, unless it is relayed.
+    const auto payload = std::move(payload_buffer_);
+    const auto payload_size = payload->size();
+
+    if (stopped())
+        return false;
+
+    // TCP protects the stream, so this is of value only for untrusted peers.
+    if (validate_checksum_ && head.checksum() !=
+        (hashed ? payload_hasher_.checksum() : payload_checksum(*payload)))
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Invalid " << head.command() << " payload from ["
+            << authority_text_ << "] bad checksum.";
+        stop(error::bad_stream);
+        return false;
+    }
 
     // Failures are not forwarded to subscribers and channel is stopped below.
-    const auto code = message_subscriber_.load(head.type(), version_, istream);
-    const auto consumed = istream.peek() == std::istream::traits_type::eof();
+    auto consumed = false;
+    const auto code = decode(head, *payload, consumed);
 
     if (verbose_ && code)
     {
         const auto size = std::min(payload_size, invalid_payload_dump_size);
-        const auto begin = payload_buffer_.begin();
+        const auto begin = payload->begin();
 
         LOG_VERBOSE(LOG_NETWORK)
-            << "Invalid payload from [" << authority() << "] "
+            << "Invalid payload from [" << authority_text_ << "] "
             << encode_base16(data_chunk{ begin, begin + size });
         stop(code);
-        return;
+        return false;
     }
 
     if (code)
     {
         LOG_WARNING(LOG_NETWORK)
-            << "Invalid " << head.command() << " payload from [" << authority()
-            << "] " << code.message();
+            << "Invalid " << head.command() << " payload from ["
+            << authority_text_ << "] " << code.message();
         stop(code);
-        return;
+        return false;
     }
 
     if (!consumed)
     {
         LOG_WARNING(LOG_NETWORK)
-            << "Invalid " << head.command() << " payload from [" << authority()
-            << "] trailing bytes.";
+            << "Invalid " << head.command() << " payload from ["
+            << authority_text_ << "] trailing bytes.";
         stop(error::bad_stream);
-        return;
+        return false;
     }
 
-    LOG_VERBOSE(LOG_NETWORK)
-        << "Received " << head.command() << " from [" << authority()
+    metrics_.received(head.type(), heading::satoshi_fixed_size() +
+        payload_size, channel_metrics::clock::now() - read_started_);
+
+    LOG_VERBOSE_IF(verbose_, LOG_NETWORK)
+        << "Received " << head.command() << " from [" << authority_text_
         << "] (" << payload_size << " bytes)";
 
+    // Transfer the buffer to payload subscribers, read uses another.
+    if (message_subscriber_.payload_subscribed())
+        message_subscriber_.relay(head.type(), payload);
+
     signal_activity();
-    read_heading();
+
+    if (useful_message(head.type()))
+        signal_useful();
+
+    return true;
+}
+
+// Notify subscribers of the new message.
+// Inventory and relay filter messages are handled here on the reading thread,
+// before subscribers, without a subscription for each channel. A message of
+// any other type without subscription is not parsed.
+code proxy::decode(const heading& head, const data_chunk& payload,
+    bool& consumed)
+{
+    const auto type = head.type();
+    const auto known = known_inventory_.capacity() != 0;
+
+    switch (type)
+    {
+        case message_type::inventory:
+            if (known)
+                return decode<inventory>(type, payload, consumed,
+                    &proxy::handle_receive_inventory);
+            break;
+        case message_type::transaction:
+            if (known)
+                return decode<transaction>(type, payload, consumed,
+                    &proxy::handle_receive_transaction);
+            break;
+        case message_type::block:
+            if (known)
+                return decode<block>(type, payload, consumed,
+                    &proxy::handle_receive_block);
+            break;
+        case message_type::fee_filter:
+            return decode<fee_filter>(type, payload, consumed,
+                &proxy::handle_receive_fee_filter);
+        case message_type::filter_load:
+            return decode<filter_load>(type, payload, consumed,
+                &proxy::handle_receive_filter_load);
+        case message_type::filter_add:
+            return decode<filter_add>(type, payload, consumed,
+                &proxy::handle_receive_filter_add);
+        case message_type::filter_clear:
+            return decode<filter_clear>(type, payload, consumed,
+                &proxy::handle_receive_filter_clear);
+        default:
+            break;
+    }
+
+    // The payload is skipped, so it is not subject to the trailing check.
+    if (!message_subscriber_.subscribed(type))
+    {
+        consumed = true;
+        return error::success;
+    }
+
+    if (contiguous_decode(type))
+    {
+        auto source = make_safe_deserializer(payload.begin(), payload.end());
+        const auto ec = message_subscriber_.load(head.type(), version_, source);
+        consumed = source.is_exhausted();
+        return ec;
+    }
+
+    payload_source source(payload);
+    payload_stream istream(source);
+    const auto ec = message_subscriber_.load(head.type(), version_, istream);
+    consumed = istream.peek() == std::istream::traits_type::eof();
+    return ec;
 }
 
 // Message send sequence.
 // ----------------------------------------------------------------------------
 
-void proxy::do_send(command_ptr command, payload_ptr payload,
-    result_handler handler)
+void proxy::send(const std::string& command, const_payload_ptr payload,
+    send_handler handler)
 {
-    async_write(socket_->get(), buffer(*payload),
+    const auto type = channel_metrics::to_type(command);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    send_mutex_.lock();
+
+    if (saturated(1) && low_priority(command))
+    {
+        send_mutex_.unlock();
+        //---------------------------------------------------------------------
+        handler(error::peer_throttling);
+        return;
+    }
+
+    if (saturated(2))
+    {
+        send_mutex_.unlock();
+        //---------------------------------------------------------------------
+        LOG_DEBUG(LOG_NETWORK)
+            << "Send queue overflow with " << command << " to ["
+            << authority_text_ << "]";
+        stop(error::peer_throttling);
+        handler(error::peer_throttling);
+        return;
+    }
+
+    send_bytes_ += payload->size();
+    send_queue_.push_back(
+        { type, command, std::move(payload), std::move(handler) });
+
+    // The write in progress picks up the message upon its completion.
+    if (sending_)
+    {
+        send_mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    sending_ = true;
+    send_mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Writes are initiated off of the caller's thread.
+    dispatch_.concurrent(&proxy::do_send, shared_from_this());
+}
+
+// Gather queued payloads into one write, limited by the batch size.
+// A payload that exceeds the batch size is written alone.
+void proxy::do_send()
+{
+    const auto batch = std::make_shared<outbounds>();
+    transport::const_buffers buffers;
+    size_t bytes = 0;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(send_mutex_);
+
+        while (!send_queue_.empty())
+        {
+            const auto size = send_queue_.front().payload->size();
+
+            if (!batch->empty() && ceiling_add(bytes, size) > send_batch_bytes_)
+                break;
+
+            bytes += size;
+            send_bytes_ -= size;
+            batch->push_back(std::move(send_queue_.front()));
+            send_queue_.pop_front();
+        }
+
+        if (batch->empty())
+        {
+            sending_ = false;
+            return;
+        }
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    buffers.reserve(batch->size());
+
+    for (const auto& message: *batch)
+        buffers.push_back(buffer(*message.payload));
+
+    write_started_ = channel_metrics::clock::now();
+
+    transport_->write(buffers,
         std::bind(&proxy::handle_send,
-            shared_from_this(), _1, _2, command, payload, handler));
+            shared_from_this(), _1, _2, batch));
 }
 
-void proxy::handle_send(const boost_code& ec, size_t, command_ptr command,
-    payload_ptr payload, result_handler handler)
+void proxy::handle_send(const boost_code& ec, size_t bytes,
+    outbounds_ptr batch)
 {
-    dispatch_.unlock();
-    const auto size = payload->size();
     const auto error = code(error::boost_to_error_code(ec));
 
     if (stopped())
     {
-        handler(error);
+        for (const auto& message: *batch)
+            message.handler(error);
+
+        clear_send(error::channel_stopped);
         return;
     }
 
     if (error)
     {
         LOG_DEBUG(LOG_NETWORK)
-            << "Failure sending " << *command << " to [" << authority()
-            << "] (" << size << " bytes) " << error.message();
+            << "Failure sending " << batch->size() << " messages to ["
+            << authority_text_ << "] (" << bytes << " bytes) "
+            << error.message();
         stop(error);
-        handler(error);
+
+        for (const auto& message: *batch)
+            message.handler(error);
+
+        clear_send(error);
         return;
     }
 
-    LOG_VERBOSE(LOG_NETWORK)
-        << "Sent " << *command << " to [" << authority() << "] (" << size
-        << " bytes)";
+    metrics_.written(channel_metrics::clock::now() - write_started_);
+
+    // Handlers are invoked in order of send.
+    for (const auto& message: *batch)
+    {
+        metrics_.sent(message.type, message.payload->size());
+
+        LOG_VERBOSE_IF(verbose_, LOG_NETWORK)
+            << "Sent " << message.command << " to [" << authority_text_
+            << "] (" << message.payload->size() << " bytes)";
+
+        message.handler(error);
+    }
+
+    // Continue with messages queued during the write, if any.
+    do_send();
+}
+
+// Fail all queued messages, subsequent sends initiate a new write.
+void proxy::clear_send(const code& ec)
+{
+    outbound_queue cleared;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(send_mutex_);
+
+        cleared.swap(send_queue_);
+        sending_ = false;
+        send_bytes_ = 0;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (const auto& message: cleared)
+        message.handler(ec);
+}
+
+channel_statistics proxy::statistics() const
+{
+    channel_statistics out;
+    out.authority = authority_;
+    out.nonce = 0;
+    out.round_trip = std::chrono::microseconds(0);
+    out.minimum_round_trip = std::chrono::microseconds(0);
+    out.options = transport_->options();
+    metrics_.copy(out);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(send_mutex_);
+
+    out.queued_messages = send_queue_.size();
+    out.queued_bytes = send_bytes_;
+    return out;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool proxy::saturated() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(send_mutex_);
+
+    return saturated(1);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private, call under send_mutex_, a zero mark disables its limit.
+bool proxy::saturated(size_t factor) const
+{
+    return
+        (send_high_water_bytes_ != 0 &&
+            send_bytes_ >= factor * send_high_water_bytes_) ||
+        (send_high_water_messages_ != 0 &&
+            send_queue_.size() >= factor * send_high_water_messages_);
+}
+
+// Known inventory.
+// ----------------------------------------------------------------------------
+
+bool proxy::known_inventory(const hash_digest& hash) const
+{
+    return known_inventory_.contains(hash);
+}
+
+bool proxy::remember_inventory(const hash_digest& hash)
+{
+    return known_inventory_.insert(hash);
+}
+
+// private
+bool proxy::handle_receive_inventory(const code& ec,
+    inventory_const_ptr message)
+{
+    if (ec)
+        return false;
+
+    for (const auto& inventory: message->inventories())
+        known_inventory_.insert(inventory.hash());
+
+    return true;
+}
+
+// private
+bool proxy::handle_receive_transaction(const code& ec,
+    transaction_const_ptr message)
+{
+    if (ec)
+        return false;
+
+    known_inventory_.insert(message->hash());
+    return true;
+}
+
+// private
+bool proxy::handle_receive_block(const code& ec, block_const_ptr message)
+{
+    if (ec)
+        return false;
+
+    known_inventory_.insert(message->header().hash());
+    return true;
+}
+
+// Relay filters.
+// ----------------------------------------------------------------------------
+
+bool proxy::admits(const chain::transaction& tx, uint64_t fee_rate)
+{
+    return relay_filter_.admits(tx, fee_rate);
+}
+
+// private
+bool proxy::handle_receive_fee_filter(const code& ec,
+    fee_filter_const_ptr message)
+{
+    if (ec)
+        return false;
+
+    relay_filter_.set_minimum_fee_rate(message->minimum_fee());
+    return true;
+}
+
+// private
+bool proxy::handle_receive_filter_load(const code& ec,
+    filter_load_const_ptr message)
+{
+    if (ec)
+        return false;
+
+    const auto result = relay_filter_.load(*message);
+
+    if (result)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Invalid filter_load from [" << authority_text_ << "] "
+            << result.message();
+        stop(result);
+        return false;
+    }
+
+    return true;
+}
+
+// private
+bool proxy::handle_receive_filter_add(const code& ec,
+    filter_add_const_ptr message)
+{
+    if (ec)
+        return false;
+
+    const auto result = relay_filter_.add(*message);
+
+    if (result)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Invalid filter_add from [" << authority_text_ << "] "
+            << result.message();
+        stop(result);
+        return false;
+    }
+
+    return true;
+}
+
+// private
+bool proxy::handle_receive_filter_clear(const code& ec,
+    filter_clear_const_ptr)
+{
+    if (ec)
+        return false;
 
-    handler(error);
+    relay_filter_.clear();
+    return true;
 }
 
 // Stop sequence.
@@ -327,8 +886,8 @@ void proxy::stop(const code& ec)
     // Give channel opportunity to terminate timers.
     handle_stopping();
 
-    // Signal socket to stop reading and accepting new work.
-    socket_->stop();
+    // Signal transport to stop reading and accepting new work.
+    transport_->stop();
 }
 
 void proxy::stop(const boost_code& ec)
@@ -0,0 +1,283 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/relay_filter.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::chain;
+
+// The bip37 limits on the size of a filter and of an added element.
+static const size_t max_filter_bytes = 36000;
+static const size_t max_hash_functions = 50;
+static const size_t max_element_bytes = 520;
+
+static const uint32_t seed_multiplier = 0xfba4c795;
+
+static uint32_t rotate(uint32_t value, size_t bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// MurmurHash3 (x86, 32 bit), as specified for bloom filters by bip37.
+static uint32_t murmur3(uint32_t seed, const data_chunk& data)
+{
+    static const uint32_t c1 = 0xcc9e2d51;
+    static const uint32_t c2 = 0x1b873593;
+
+    auto hash = seed;
+    const auto blocks = data.size() / sizeof(uint32_t);
+
+    for (size_t block = 0; block < blocks; ++block)
+    {
+        const auto at = &data[block * sizeof(uint32_t)];
+        auto value = static_cast<uint32_t>(at[0]) |
+            static_cast<uint32_t>(at[1]) << 8 |
+            static_cast<uint32_t>(at[2]) << 16 |
+            static_cast<uint32_t>(at[3]) << 24;
+
+        value *= c1;
+        value = rotate(value, 15);
+        value *= c2;
+        hash ^= value;
+        hash = rotate(hash, 13);
+        hash = hash * 5 + 0xe6546b64;
+    }
+
+    const auto tail = data.data() + blocks * sizeof(uint32_t);
+    uint32_t value = 0;
+
+    switch (data.size() & 3)
+    {
+        case 3:
+            value ^= static_cast<uint32_t>(tail[2]) << 16;
+            // fall through
+        case 2:
+            value ^= static_cast<uint32_t>(tail[1]) << 8;
+            // fall through
+        case 1:
+            value ^= tail[0];
+            value *= c1;
+            value = rotate(value, 15);
+            value *= c2;
+            hash ^= value;
+    }
+
+    hash ^= static_cast<uint32_t>(data.size());
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+relay_filter::relay_filter()
+  : minimum_fee_rate_(0),
+    loaded_(false),
+    hash_functions_(0),
+    tweak_(0),
+    flags_(update_none)
+{
+}
+
+uint64_t relay_filter::minimum_fee_rate() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return minimum_fee_rate_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void relay_filter::set_minimum_fee_rate(uint64_t satoshi_per_kilobyte)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    minimum_fee_rate_ = satoshi_per_kilobyte;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+code relay_filter::load(const message::filter_load& message)
+{
+    if (message.filter().size() > max_filter_bytes ||
+        message.hash_functions() > max_hash_functions)
+        return error::bad_stream;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    loaded_ = true;
+    filter_ = message.filter();
+    hash_functions_ = message.hash_functions();
+    tweak_ = message.tweak();
+    flags_ = message.flags();
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+code relay_filter::add(const message::filter_add& message)
+{
+    if (message.data().size() > max_element_bytes)
+        return error::bad_stream;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (!loaded_)
+        return error::bad_stream;
+
+    insert(message.data());
+    return error::success;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void relay_filter::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    loaded_ = false;
+    filter_.clear();
+    hash_functions_ = 0;
+    tweak_ = 0;
+    flags_ = update_none;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool relay_filter::loaded() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return loaded_;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool relay_filter::admits(const transaction& tx, uint64_t fee_rate)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (fee_rate != max_uint64 && fee_rate < minimum_fee_rate_)
+        return false;
+
+    return !loaded_ || matches(tx);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private, call under mutex_.
+// ----------------------------------------------------------------------------
+
+bool relay_filter::contains(const data_chunk& data) const
+{
+    if (filter_.empty())
+        return false;
+
+    const auto bits = filter_.size() * 8;
+
+    for (uint32_t function = 0; function < hash_functions_; ++function)
+    {
+        const auto seed = function * seed_multiplier + tweak_;
+        const auto index = murmur3(seed, data) % bits;
+
+        if ((filter_[index >> 3] & (1 << (index & 7))) == 0)
+            return false;
+    }
+
+    return true;
+}
+
+void relay_filter::insert(const data_chunk& data)
+{
+    if (filter_.empty())
+        return;
+
+    const auto bits = filter_.size() * 8;
+
+    for (uint32_t function = 0; function < hash_functions_; ++function)
+    {
+        const auto seed = function * seed_multiplier + tweak_;
+        const auto index = murmur3(seed, data) % bits;
+        filter_[index >> 3] |= (1 << (index & 7));
+    }
+}
+
+// A transaction matches by its hash, a data push of an output script, the
+// point of an input or a data push of an input script. Matched outputs are
+// added to the filter as points, so that their spends also match (bip37).
+bool relay_filter::matches(const transaction& tx)
+{
+    const auto hash = tx.hash();
+    auto matched = contains(to_chunk(hash));
+    const auto& outputs = tx.outputs();
+
+    for (uint32_t index = 0; index < outputs.size(); ++index)
+    {
+        const auto& operations = outputs[index].script().operations();
+
+        for (const auto& operation: operations)
+        {
+            if (operation.data().empty() || !contains(operation.data()))
+                continue;
+
+            matched = true;
+
+            const auto add_point = flags_ == update_all ||
+                (flags_ == update_pay_key_only &&
+                    (script::is_pay_public_key_pattern(operations) ||
+                    script::is_pay_multisig_pattern(operations)));
+
+            if (add_point)
+                insert(output_point{ hash, index }.to_data());
+
+            break;
+        }
+    }
+
+    if (matched)
+        return true;
+
+    for (const auto& input: tx.inputs())
+    {
+        if (contains(input.previous_output().to_data()))
+            return true;
+
+        for (const auto& operation: input.script().operations())
+            if (!operation.data().empty() && contains(operation.data()))
+                return true;
+    }
+
+    return false;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/rolling_bloom.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+static const size_t generations = 3;
+static const size_t word_bits = 64;
+
+// The optimal number of bits for the entries at the false positive rate.
+static size_t bit_count(size_t entries, double false_positive_rate)
+{
+    if (entries == 0)
+        return 0;
+
+    const auto rate = std::min(std::max(false_positive_rate, 1e-12), 0.5);
+    const auto ln2 = std::log(2.0);
+    const auto bits = -std::log(rate) * entries / (ln2 * ln2);
+    return std::max<size_t>(word_bits, static_cast<size_t>(std::ceil(bits)));
+}
+
+// The optimal number of hash functions for the bits per entry.
+static size_t hash_count(size_t bits, size_t entries)
+{
+    if (entries == 0)
+        return 0;
+
+    const auto count = std::log(2.0) * bits / entries;
+    return std::min<size_t>(50, std::max<size_t>(1,
+        static_cast<size_t>(std::round(count))));
+}
+
+// A bijective mixer, so that distinct salted words remain distinct.
+static uint64_t mix(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111eb;
+    value ^= value >> 31;
+    return value;
+}
+
+static bool is_set(const std::vector<uint64_t>& bits, size_t index)
+{
+    return (bits[index / word_bits] & (uint64_t(1) << (index % word_bits)))
+        != 0;
+}
+
+static uint64_t word(const hash_digest& hash, size_t offset)
+{
+    uint64_t value = 0;
+
+    for (size_t byte = 0; byte < sizeof(uint64_t); ++byte)
+        value |= static_cast<uint64_t>(hash[offset + byte]) << (8 * byte);
+
+    return value;
+}
+
+// Each generation takes half of the capacity, and all three are probed, so
+// the rate of each is a third of the rate of the set.
+rolling_bloom::rolling_bloom(size_t capacity, double false_positive_rate)
+  : capacity_(capacity),
+    entries_(capacity == 0 ? 0 : std::max<size_t>(1, (capacity + 1) / 2)),
+    bits_(bit_count(entries_, false_positive_rate / generations)),
+    hashes_(hash_count(bits_, entries_)),
+    salt_(pseudo_random::next()),
+    count_(0),
+    newest_(0)
+{
+}
+
+size_t rolling_bloom::capacity() const
+{
+    return capacity_;
+}
+
+bool rolling_bloom::contains(const hash_digest& hash) const
+{
+    if (bits_ == 0)
+        return false;
+
+    std::vector<size_t> indexes;
+    positions(hash, indexes);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return contained(indexes);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+bool rolling_bloom::insert(const hash_digest& hash)
+{
+    if (bits_ == 0)
+        return true;
+
+    std::vector<size_t> indexes;
+    positions(hash, indexes);
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (contained(indexes))
+        return false;
+
+    // The filters are allocated upon first use, as many channels never
+    // insert, such as those that fail the handshake.
+    if (filters_.empty())
+        filters_.assign(generations,
+            filter((bits_ + word_bits - 1) / word_bits, 0));
+
+    // The two older generations hold the most recent capacity hashes.
+    if (count_ == entries_)
+    {
+        newest_ = (newest_ + 1) % generations;
+        std::fill(filters_[newest_].begin(), filters_[newest_].end(), 0);
+        count_ = 0;
+    }
+
+    auto& newest = filters_[newest_];
+
+    for (const auto index: indexes)
+        newest[index / word_bits] |= uint64_t(1) << (index % word_bits);
+
+    ++count_;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void rolling_bloom::clear()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    for (auto& filter: filters_)
+        std::fill(filter.begin(), filter.end(), 0);
+
+    count_ = 0;
+    newest_ = 0;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+// Positions are mixed from a sequence over two salted words of the hash, as
+// plain double hashing modulo the filter size raises the false positives.
+void rolling_bloom::positions(const hash_digest& hash,
+    std::vector<size_t>& out_positions) const
+{
+    const auto first = mix(word(hash, 0) ^ salt_);
+    const auto second = mix(word(hash, 8) ^ salt_) | 1;
+
+    out_positions.resize(hashes_);
+
+    for (size_t index = 0; index < hashes_; ++index)
+        out_positions[index] = static_cast<size_t>(
+            mix(first + index * second) % bits_);
+}
+
+bool rolling_bloom::contained(const std::vector<size_t>& positions) const
+{
+    const auto contains_all = [&positions](const filter& bits)
+    {
+        for (const auto index: positions)
+            if (!is_set(bits, index))
+                return false;
+
+        return true;
+    };
+
+    return std::any_of(filters_.begin(), filters_.end(), contains_all);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/acceptor.hpp>
 #include <bitcoin/network/channel.hpp>
@@ -41,11 +42,20 @@ namespace network {
 
 using namespace std::placeholders;
 
+// The version of this node as configured, for all but seed channels.
+static version_const_ptr configured_version(const settings& settings)
+{
+    return protocol_version_31402::make_template(settings,
+        settings.protocol_maximum, settings.services,
+        settings.relay_transactions);
+}
+
 session::session(p2p& network, bool notify_on_connect)
   : stopped_(true),
     notify_on_connect_(notify_on_connect),
     network_(network),
     dispatch_(network.thread_pool(), NAME),
+    version_template_(configured_version(network.network_settings())),
     pool_(network.thread_pool()),
     settings_(network.network_settings())
 {
@@ -75,15 +85,25 @@ code session::fetch_address(address& out_address) const
     return network_.fetch_address(out_address);
 }
 
+code session::failed_address(const authority& authority)
+{
+    return network_.failed_address(authority.to_network_address());
+}
+
 bool session::blacklisted(const authority& authority) const
 {
-    const auto ip_compare = [&](const config::authority& blocked)
-    {
-        return authority.ip() == blocked.ip();
-    };
+    return network_.blacklisted(authority.to_network_address());
+}
+
+void session::store(const address::list& addresses, result_handler handler)
+{
+    network_.store(addresses, handler);
+}
 
-    const auto& list = settings_.blacklists;
-    return std::any_of(list.begin(), list.end(), ip_compare);
+void session::resolve(const std::string& hostname, uint16_t port,
+    dns_cache::resolve_handler handler)
+{
+    network_.names()->resolve(hostname, port, handler);
 }
 
 bool session::stopped() const
@@ -96,17 +116,60 @@ bool session::stopped(const code& ec) const
     return stopped() || ec == error::service_stopped;
 }
 
+std::string session::name() const
+{
+    return NAME;
+}
+
+// The version is built once per session and patched for each channel.
+version_const_ptr session::version_template() const
+{
+    return version_template_;
+}
+
+bool session::validate_checksum() const
+{
+    return settings_.validate_checksum;
+}
+
+// Statistics.
+// ----------------------------------------------------------------------------
+
+// Attempts canceled by stop or by a sibling are not counted.
+void session::record_connect(const code& ec, connector::ptr connector)
+{
+    if (!stopped(ec) && ec != error::channel_stopped &&
+        ec != error::operation_failed)
+        network_.exporter()->connected(ec, connector->elapsed());
+}
+
+void session::record_accept()
+{
+    network_.exporter()->accepted();
+}
+
 // Socket creators.
 // ----------------------------------------------------------------------------
 
+// Each accepted channel is placed on the next channel pool.
 acceptor::ptr session::create_acceptor()
 {
-    return std::make_shared<acceptor>(pool_, settings_);
+    auto& network = network_;
+    const auto select = [&network]() -> threadpool&
+    {
+        return network.channel_pool();
+    };
+
+    return std::make_shared<acceptor>(pool_, settings_, network_.buffers(),
+        network_.allocations(), network_.timers(), select);
 }
 
+// The connector runs on the pool of the channel that it creates.
 connector::ptr session::create_connector()
 {
-    return std::make_shared<connector>(pool_, settings_);
+    return std::make_shared<connector>(network_.channel_pool(), settings_,
+        network_.buffers(), network_.allocations(), network_.names(),
+        network_.timers());
 }
 
 // Pending connect.
@@ -188,6 +251,10 @@ void session::register_channel(channel::ptr channel,
         return;
     }
 
+    // The nonce is set before start_channel, which may pend the channel
+    // under it, so that a channel connected to self can be detected.
+    channel->set_nonce(pseudo_random::next(1, max_uint64));
+
     start_channel(channel,
         BIND4(handle_start, _1, channel, handle_started, handle_stopped));
 }
@@ -196,7 +263,7 @@ void session::start_channel(channel::ptr channel,
     result_handler handle_started)
 {
     channel->set_notify(notify_on_connect_);
-    channel->set_nonce(pseudo_random::next(1, max_uint64));
+    channel->set_validate_checksum(validate_checksum());
 
     // The channel starts, invokes the handler, then starts the read cycle.
     channel->start(
@@ -225,14 +292,25 @@ void session::attach_handshake_protocols(channel::ptr channel,
     // Reject messages are not handled until bip61 (70002).
     // The negotiated_version is initialized to the configured maximum.
     if (channel->negotiated_version() >= message::version::level::bip61)
-        attach<protocol_version_70002>(channel)->start(handle_started);
+        attach<protocol_version_70002>(channel, settings_.protocol_maximum,
+            settings_.services, settings_.invalid_services,
+            settings_.protocol_minimum, message::version::service::none,
+            settings_.relay_transactions, version_template())
+            ->start(handle_started);
     else
-        attach<protocol_version_31402>(channel)->start(handle_started);
+        attach<protocol_version_31402>(channel, settings_.protocol_maximum,
+            settings_.services, settings_.invalid_services,
+            settings_.protocol_minimum, message::version::service::none,
+            version_template())
+            ->start(handle_started);
 }
 
 void session::handle_handshake(const code& ec, channel::ptr channel,
     result_handler handle_started)
 {
+    if (!stopped(ec))
+        network_.exporter()->handshaken(ec);
+
     if (ec)
     {
         LOG_DEBUG(LOG_NETWORK)
@@ -256,6 +334,14 @@ void session::handshake_complete(channel::ptr channel,
 void session::handle_start(const code& ec, channel::ptr channel,
     result_handler handle_started, result_handler handle_stopped)
 {
+    const auto host = channel->authority().to_network_address();
+
+    // Feed the outcome back to the host pool, duplicate connections aside.
+    if (!ec)
+        network_.good_address(host);
+    else if (ec != error::address_in_use && !stopped(ec))
+        network_.failed_address(host);
+
     // Must either stop or subscribe the channel for stop before returning.
     // All closures must eventually be invoked as otherwise it is a leak.
     // Therefore upon start failure expect start failure and stop callbacks.
@@ -266,6 +352,7 @@ void session::handle_start(const code& ec, channel::ptr channel,
     }
     else
     {
+        network_.exporter()->registered(name());
         channel->subscribe_stop(
             BIND3(handle_remove, _1, channel, handle_stopped));
     }
@@ -278,6 +365,7 @@ void session::handle_remove(const code& , channel::ptr channel,
     result_handler handle_stopped)
 {
     network_.remove(channel);
+    network_.exporter()->removed(name());
     handle_stopped(error::success);
 }
 
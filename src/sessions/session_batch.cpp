@@ -40,42 +40,58 @@ session_batch::session_batch(p2p& network, bool notify_on_connect)
 {
 }
 
+session_batch::race::race(size_t size, channel_handler handler)
+  : size(size),
+    handler(handler),
+    won(false),
+    remaining(size),
+    canceled(0),
+    discarded(0)
+{
+}
+
 // Connect sequence.
 // ----------------------------------------------------------------------------
 
 // protected:
 void session_batch::connect(channel_handler handler)
 {
-    const auto join_handler = synchronize(handler, batch_size_, NAME "_join",
-        synchronizer_terminate::on_success);
+    const auto batch = std::make_shared<race>(batch_size_, handler);
+    batch->connectors.reserve(batch_size_);
 
+    // All connectors exist before any attempt, so all can be canceled.
     for (size_t host = 0; host < batch_size_; ++host)
-        new_connect(join_handler);
+        batch->connectors.push_back(create_connector());
+
+    for (const auto connector: batch->connectors)
+        new_connect(connector, batch);
 }
 
-void session_batch::new_connect(channel_handler handler)
+void session_batch::new_connect(connector::ptr connector, race::ptr batch)
 {
     if (stopped())
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Suspended batch connection.";
-        handler(error::channel_stopped, nullptr);
+        connector->stop(error::channel_stopped);
+        handle_finish(error::channel_stopped, nullptr, batch);
         return;
     }
 
     network_address address;
     const auto ec = fetch_address(address);
-    start_connect(ec, address, handler);
+    start_connect(ec, address, connector, batch);
 }
 
 void session_batch::start_connect(const code& ec, const authority& host,
-    channel_handler handler)
+    connector::ptr connector, race::ptr batch)
 {
     if (stopped(ec))
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Batch session stopped while starting.";
-        handler(error::service_stopped, nullptr);
+        connector->stop(error::service_stopped);
+        handle_finish(error::service_stopped, nullptr, batch);
         return;
     }
 
@@ -84,46 +100,94 @@ void session_batch::start_connect(const code& ec, const authority& host,
     {
         LOG_WARNING(LOG_NETWORK)
             << "Failure fetching new address: " << ec.message();
-        handler(ec, nullptr);
+        connector->stop(ec);
+        handle_finish(ec, nullptr, batch);
         return;
     }
 
-    // This creates a tight loop in the case of a small address pool.
+    // Outbound backoff prevents a tight loop in a small address pool.
     if (blacklisted(host))
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Fetched blacklisted address [" << host << "] ";
-        handler(error::address_blocked, nullptr);
+        connector->stop(error::address_blocked);
+        handle_finish(error::address_blocked, nullptr, batch);
         return;
     }
 
     LOG_VERBOSE(LOG_NETWORK)
         << "Connecting to [" << host << "]";
 
-    const auto connector = create_connector();
     pend(connector);
 
     // CONNECT
     connector->connect(host,
-        BIND4(handle_connect, _1, _2, connector, handler));
+        BIND5(handle_connect, _1, _2, host, connector, batch));
 }
 
 void session_batch::handle_connect(const code& ec, channel::ptr channel,
-    connector::ptr connector, channel_handler handler)
+    const authority& host, connector::ptr connector, race::ptr batch)
 {
     unpend(connector);
+    record_connect(ec, connector);
 
     if (ec)
     {
-        handler(ec, nullptr);
+        // An attempt canceled by the winner does not reflect on the address.
+        if (batch->won)
+            ++batch->canceled;
+
+        // Unreachable addresses are dropped or demoted in the host pool.
+        else if (!stopped(ec))
+            failed_address(host);
+
+        handle_finish(ec, nullptr, batch);
         return;
     }
 
     LOG_DEBUG(LOG_NETWORK)
         << "Connected to [" << channel->authority() << "]";
 
+    handle_finish(error::success, channel, batch);
+}
+
+// The first success is returned and cancels its siblings. A channel connected
+// after the first success is closed. If all fail the last code is returned.
+void session_batch::handle_finish(const code& ec, channel::ptr channel,
+    race::ptr batch)
+{
+    if (!ec)
+    {
+        if (!batch->won.exchange(true))
+        {
+            // Stopping a completed connector has no effect.
+            for (const auto connector: batch->connectors)
+                connector->stop(error::service_stopped);
+
+            // This is the end of the connect sequence.
+            batch->handler(error::success, channel);
+        }
+        else
+        {
+            ++batch->discarded;
+            channel->stop(error::channel_stopped);
+        }
+    }
+
+    if (--batch->remaining != 0)
+        return;
+
+    if (batch->won)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Batch of (" << batch->size << ") connects wasted ("
+            << batch->canceled << ") canceled and (" << batch->discarded
+            << ") connected attempts.";
+        return;
+    }
+
     // This is the end of the connect sequence.
-    handler(error::success, channel);
+    batch->handler(ec, nullptr);
 }
 
 } // namespace network
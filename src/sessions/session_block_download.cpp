@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/sessions/session_block_download.hpp>
+
+#include <functional>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/block_download.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_block_download.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define CLASS session_block_download
+#define NAME "session_block_download"
+
+using namespace std::placeholders;
+
+session_block_download::session_block_download(p2p& network,
+    block_download::ptr download)
+  : session_sync(network),
+    download_(download),
+    CONSTRUCT_TRACK(session_block_download)
+{
+}
+
+std::string session_block_download::name() const
+{
+    return NAME;
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void session_block_download::start(result_handler handler)
+{
+    if (download_->complete())
+    {
+        handler(error::success);
+        return;
+    }
+
+    LOG_INFO(LOG_NETWORK)
+        << "Starting block download session from height "
+        << download_->next_height() << ".";
+
+    session_sync::start(BIND2(handle_complete, _1, handler));
+}
+
+void session_block_download::attach_sync_protocol(channel::ptr channel,
+    result_handler complete)
+{
+    attach<protocol_block_download>(channel, download_)->start(complete);
+}
+
+void session_block_download::handle_complete(const code& ec,
+    result_handler handler)
+{
+    if (!ec)
+    {
+        LOG_INFO(LOG_NETWORK)
+            << "Block download complete at height "
+            << download_->next_height() - 1 << ".";
+    }
+
+    // This is the end of the block download sequence.
+    handler(ec);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/sessions/session_header_sync.hpp>
+
+#include <functional>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/header_sync.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_header_sync.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define CLASS session_header_sync
+#define NAME "session_header_sync"
+
+using namespace std::placeholders;
+
+session_header_sync::session_header_sync(p2p& network,
+    header_sync::ptr sync)
+  : session_sync(network),
+    sync_(sync),
+    CONSTRUCT_TRACK(session_header_sync)
+{
+}
+
+std::string session_header_sync::name() const
+{
+    return NAME;
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void session_header_sync::start(result_handler handler)
+{
+    if (sync_->complete())
+    {
+        handler(error::success);
+        return;
+    }
+
+    LOG_INFO(LOG_NETWORK)
+        << "Starting header sync session from height "
+        << sync_->top().height() << ".";
+
+    session_sync::start(BIND2(handle_complete, _1, handler));
+}
+
+void session_header_sync::attach_sync_protocol(channel::ptr channel,
+    result_handler complete)
+{
+    if (channel->negotiated_version() < message::version::level::headers)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Header sync peer does not support headers ["
+            << channel->authority() << "]";
+        channel->stop(error::channel_stopped);
+        return;
+    }
+
+    attach<protocol_header_sync>(channel, sync_)->start(complete);
+}
+
+void session_header_sync::handle_complete(const code& ec,
+    result_handler handler)
+{
+    if (!ec)
+    {
+        LOG_INFO(LOG_NETWORK)
+            << "Header sync complete at height " << sync_->top().height()
+            << ".";
+    }
+
+    // This is the end of the header sync sequence.
+    handler(ec);
+}
+
+} // namespace network
+} // namespace libbitcoin
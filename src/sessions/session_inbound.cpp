@@ -18,11 +18,14 @@
  */
 #include <bitcoin/network/sessions/session_inbound.hpp>
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_inventory_relay.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
@@ -31,23 +34,44 @@ namespace libbitcoin {
 namespace network {
 
 #define CLASS session_inbound
+#define NAME "session_inbound"
 
 using namespace std::placeholders;
 
+// Accept errors are local (such as descriptor exhaustion), so cap them low.
+static const auto inbound_initial_delay = asio::milliseconds(100);
+static const auto inbound_maximum_delay = asio::seconds(10);
+
 session_inbound::session_inbound(p2p& network, bool notify_on_connect)
   : session(network, notify_on_connect),
     connection_limit_(settings_.inbound_connections +
         settings_.outbound_connections + settings_.peers.size()),
+    backoff_(inbound_initial_delay, inbound_maximum_delay),
+    tokens_(settings_.inbound_accept_rate),
+    refilled_(clock::now()),
     CONSTRUCT_TRACK(session_inbound)
 {
 }
 
+std::string session_inbound::name() const
+{
+    return NAME;
+}
+
+bool session_inbound::validate_checksum() const
+{
+    return settings_.validate_checksum || settings_.validate_inbound_checksum;
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 
+// A zero port disables the session unless configured to accept only
+// connections on transports passed to accept.
 void session_inbound::start(result_handler handler)
 {
-    if (settings_.inbound_port == 0 || settings_.inbound_connections == 0)
+    if (settings_.inbound_connections == 0 || (settings_.inbound_port == 0 &&
+        !settings_.inbound_transport_only))
     {
         LOG_INFO(LOG_NETWORK)
             << "Not configured for accepting incoming connections.";
@@ -55,9 +79,13 @@ void session_inbound::start(result_handler handler)
         return;
     }
 
-    LOG_INFO(LOG_NETWORK)
-        << "Starting inbound session on port (" << settings_.inbound_port
-        << ").";
+    if (settings_.inbound_transport_only)
+        LOG_INFO(LOG_NETWORK)
+            << "Starting inbound session without listener.";
+    else
+        LOG_INFO(LOG_NETWORK)
+            << "Starting inbound session on port (" << settings_.inbound_port
+            << ").";
 
     session::start(CONCURRENT_DELEGATE2(handle_started, _1, handler));
 }
@@ -70,6 +98,13 @@ void session_inbound::handle_started(const code& ec, result_handler handler)
         return;
     }
 
+    // Without a listener channels are only accepted by the accept method.
+    if (settings_.inbound_transport_only)
+    {
+        handler(error::success);
+        return;
+    }
+
     acceptor_ = create_acceptor();
 
     // Relay stop to the acceptor.
@@ -86,7 +121,11 @@ void session_inbound::handle_started(const code& ec, result_handler handler)
         return;
     }
 
-    start_accept(error::success);
+    // Keep multiple accepts outstanding, each completing on any pool thread.
+    const auto accepts = std::max(settings_.inbound_accepts, 1u);
+
+    for (uint32_t accept = 0; accept < accepts; ++accept)
+        start_accept(error::success);
 
     // This is the end of the start sequence.
     handler(error::success);
@@ -111,7 +150,7 @@ void session_inbound::start_accept(const code&)
     }
 
     // ACCEPT THE NEXT INCOMING CONNECTION
-    acceptor_->accept(BIND2(handle_accept, _1, _2));
+    acceptor_->accept(BIND1(admit, _1), BIND2(handle_accept, _1, _2));
 }
 
 void session_inbound::handle_accept(const code& ec, channel::ptr channel)
@@ -123,37 +162,292 @@ void session_inbound::handle_accept(const code& ec, channel::ptr channel)
         return;
     }
 
-    // Start accepting with conditional delay in case of network error.
-    dispatch_delayed(cycle_delay(ec), BIND1(start_accept, _1));
+    // An admission rejection is not a failure of the accept.
+    const auto rejected = (ec == error::address_blocked ||
+        ec == error::peer_throttling);
+
+    // Restart this accept with increasing delay in case of repeated failure.
+    dispatch_delayed(cycle_delay(rejected ? error::success : ec, backoff_),
+        BIND1(start_accept, _1));
 
     if (ec)
     {
-        LOG_DEBUG(LOG_NETWORK)
-            << "Failure accepting connection: " << ec.message();
+        if (!rejected)
+            LOG_DEBUG(LOG_NETWORK)
+                << "Failure accepting connection: " << ec.message();
+
         return;
     }
 
-    if (blacklisted(channel->authority()))
+    record_accept();
+    register_accepted(channel);
+}
+
+code session_inbound::accept(channel::ptr channel)
+{
+    const auto ec = stopped() ? error::service_stopped :
+        admit(channel->authority());
+
+    if (ec)
+        return ec;
+
+    record_accept();
+    register_accepted(channel);
+    return error::success;
+}
+
+// private
+// The slot of an evicted channel is released only once it has stopped, so
+// while evictions are pending an accepted channel waits for one of them.
+void session_inbound::register_accepted(channel::ptr channel)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (deferred_.size() < evicted_.size())
     {
-        LOG_DEBUG(LOG_NETWORK)
-            << "Rejected inbound connection from ["
-            << channel->authority() << "] due to blacklisted address.";
+        deferred_.push_back(channel);
+        mutex_.unlock();
+        //---------------------------------------------------------------------
         return;
     }
 
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    start_accepted(channel);
+}
+
+// private
+// The subnet slot of the channel was reserved by its admission.
+void session_inbound::start_accepted(channel::ptr channel)
+{
+    register_channel(channel,
+        BIND2(handle_channel_start, _1, channel),
+        BIND2(handle_channel_stop, _1, channel));
+}
+
+// Admission.
+// ----------------------------------------------------------------------------
+// These run on the raw socket endpoint, before creation of the channel.
+
+code session_inbound::admit(const authority& authority)
+{
+    if (blacklisted(authority))
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Rejected inbound connection from [" << authority
+            << "] due to blacklisted address.";
+        return error::address_blocked;
+    }
+
+    if (throttled())
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Rejected inbound connection from [" << authority
+            << "] due to accept rate limit.";
+        return error::peer_throttling;
+    }
+
+    if (!reserve_subnet(authority))
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Rejected inbound connection from [" << authority
+            << "] due to subnet connection limit.";
+        return error::peer_throttling;
+    }
+
     // Inbound connections can easily overflow in the case where manual and/or
     // outbound connections at the time are not yet connected as configured.
-    if (connection_count() >= connection_limit_)
+    // This is checked last so that a peer is not evicted for a rejected one.
+    if (connection_count() >= connection_limit_ && !evict())
     {
+        release_subnet(authority);
         LOG_DEBUG(LOG_NETWORK)
-            << "Rejected inbound connection from ["
-            << channel->authority() << "] due to connection limit.";
+            << "Rejected inbound connection from [" << authority
+            << "] due to connection limit.";
+        return error::peer_throttling;
+    }
+
+    return error::success;
+}
+
+// The check and the count are atomic, so that concurrent accepts from one
+// subnet cannot together exceed the limit.
+bool session_inbound::reserve_subnet(const authority& authority)
+{
+    const auto limit = settings_.inbound_subnet_limit;
+
+    if (limit == 0)
+        return true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    auto& count = subnets_[subnet::group(authority)];
+
+    if (count >= limit)
+        return false;
+
+    ++count;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void session_inbound::release_subnet(const authority& authority)
+{
+    if (settings_.inbound_subnet_limit == 0)
         return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto it = subnets_.find(subnet::group(authority));
+
+    if (it != subnets_.end() && --it->second == 0)
+        subnets_.erase(it);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// A token bucket refilled at the configured rate, holding up to one second.
+bool session_inbound::throttled()
+{
+    const auto rate = settings_.inbound_accept_rate;
+
+    if (rate == 0)
+        return false;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    const auto now = clock::now();
+    const std::chrono::duration<double> elapsed = now - refilled_;
+    refilled_ = now;
+    tokens_ = std::min(static_cast<double>(rate),
+        tokens_ + elapsed.count() * rate);
+
+    if (tokens_ < 1.0)
+        return true;
+
+    tokens_ -= 1.0;
+    return false;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Eviction.
+// ----------------------------------------------------------------------------
+// When full, an inbound peer that has relayed nothing for the configured idle
+// period gives up its slot. Candidates are ranked by round trip, data idle
+// time and the number of candidates in its network group, and the peer with
+// the worst sum of ranks is evicted, so no one criterion can be gamed alone.
+
+bool session_inbound::evict()
+{
+    if (settings_.inbound_eviction_idle_seconds == 0)
+        return false;
+
+    const auto idle = settings_.inbound_eviction_idle();
+
+    struct candidate
+    {
+        channel::ptr channel;
+        asio::duration latency;
+        asio::duration idle;
+        size_t peers;
+        size_t rank;
+    };
+
+    std::vector<candidate> candidates;
+    subnet_map groups;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    // Scores are read once, as they may change while sorting.
+    for (const auto channel: channels_)
+    {
+        const auto elapsed = channel->useful_idle();
+
+        if (elapsed >= idle)
+            candidates.push_back(
+                { channel, channel->latency_score(), elapsed, 0, 0 });
     }
 
-    register_channel(channel,
-        BIND2(handle_channel_start, _1, channel),
-        BIND1(handle_channel_stop, _1));
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (candidates.empty())
+        return false;
+
+    for (const auto& entry: candidates)
+        ++groups[subnet::group(entry.channel->authority())];
+
+    for (auto& entry: candidates)
+        entry.peers = groups[subnet::group(entry.channel->authority())];
+
+    // Add the position of each candidate in order of increasing badness.
+    const auto rank = [&candidates](
+        std::function<bool(const candidate&, const candidate&)> better)
+    {
+        std::sort(candidates.begin(), candidates.end(), better);
+
+        for (size_t index = 0; index < candidates.size(); ++index)
+            candidates[index].rank += index;
+    };
+
+    rank([](const candidate& left, const candidate& right)
+    {
+        return left.latency < right.latency;
+    });
+
+    rank([](const candidate& left, const candidate& right)
+    {
+        return left.idle < right.idle;
+    });
+
+    rank([](const candidate& left, const candidate& right)
+    {
+        return left.peers < right.peers;
+    });
+
+    const auto worst = std::max_element(candidates.begin(), candidates.end(),
+        [](const candidate& left, const candidate& right)
+        {
+            return left.rank < right.rank;
+        });
+
+    const auto channel = worst->channel;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    const auto it = std::find(channels_.begin(), channels_.end(), channel);
+    const auto found = it != channels_.end();
+
+    // Removal here prevents a concurrent admission from evicting it again.
+    if (found)
+    {
+        channels_.erase(it);
+        evicted_.push_back(channel);
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (!found)
+        return false;
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Evicting idle inbound channel [" << channel->authority()
+        << "] for new connection.";
+
+    channel->stop(error::channel_timeout);
+    return true;
 }
 
 void session_inbound::handle_channel_start(const code& ec,
@@ -172,6 +466,15 @@ void session_inbound::handle_channel_start(const code& ec,
         << "Connected inbound channel [" << channel->authority() << "] ("
         << connection_count() << ")";
 
+    if (settings_.inbound_eviction_idle_seconds != 0)
+    {
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        unique_lock lock(mutex_);
+        channels_.push_back(channel);
+        ///////////////////////////////////////////////////////////////////////
+    }
+
     attach_protocols(channel);
 }
 
@@ -188,12 +491,56 @@ void session_inbound::attach_protocols(channel::ptr channel)
         attach<protocol_reject_70002>(channel)->start();
 
     attach<protocol_address_31402>(channel)->start();
+
+    if (settings_.inventory_relay_milliseconds != 0)
+        attach<protocol_inventory_relay>(channel)->start();
 }
 
-void session_inbound::handle_channel_stop(const code& ec)
+void session_inbound::handle_channel_stop(const code& ec,
+    channel::ptr channel)
 {
     LOG_DEBUG(LOG_NETWORK)
         << "Inbound channel stopped: " << ec.message();
+
+    channel::ptr deferred;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    channels_.erase(std::remove(channels_.begin(), channels_.end(), channel),
+        channels_.end());
+
+    // The slot of an evicted channel passes to the first deferred channel.
+    const auto it = std::find(evicted_.begin(), evicted_.end(), channel);
+
+    if (it != evicted_.end())
+    {
+        evicted_.erase(it);
+
+        if (!deferred_.empty())
+        {
+            deferred = deferred_.front();
+            deferred_.pop_front();
+        }
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    release_subnet(channel->authority());
+
+    if (!deferred)
+        return;
+
+    // A deferred channel was never started, so its stop closes the transport.
+    if (stopped())
+    {
+        deferred->stop(error::service_stopped);
+        release_subnet(deferred->authority());
+        return;
+    }
+
+    start_accepted(deferred);
 }
 
 // Channel start sequence.
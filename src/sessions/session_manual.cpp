@@ -25,6 +25,7 @@
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_inventory_relay.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
@@ -33,15 +34,31 @@ namespace libbitcoin {
 namespace network {
 
 #define CLASS session_manual
+#define NAME "session_manual"
 
 using namespace std::placeholders;
 
+// Manual peers are expected to be reachable, so back off to a slow retry.
+static const auto manual_initial_delay = asio::seconds(1);
+static const auto manual_maximum_delay = asio::seconds(300);
+
 session_manual::session_manual(p2p& network, bool notify_on_connect)
   : session(network, notify_on_connect),
+    backoff_(manual_initial_delay, manual_maximum_delay),
     CONSTRUCT_TRACK(session_manual)
 {
 }
 
+std::string session_manual::name() const
+{
+    return NAME;
+}
+
+bool session_manual::validate_checksum() const
+{
+    return settings_.validate_checksum || settings_.validate_manual_checksum;
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 // Manual connections are always enabled.
@@ -111,6 +128,7 @@ void session_manual::handle_connect(const code& ec, channel::ptr channel,
     connector::ptr connector, channel_handler handler)
 {
     unpend(connector);
+    record_connect(ec, connector);
 
     if (ec)
     {
@@ -123,8 +141,8 @@ void session_manual::handle_connect(const code& ec, channel::ptr channel,
 
         if (remaining > 0)
         {
-            // Retry with conditional delay in case of network error.
-            dispatch_delayed(cycle_delay(ec),
+            // Retry with increasing delay in case of repeated failure.
+            dispatch_delayed(cycle_delay(ec, backoff_),
                 BIND5(start_connect, _1, hostname, port, remaining, handler));
             return;
         }
@@ -139,6 +157,8 @@ void session_manual::handle_connect(const code& ec, channel::ptr channel,
         return;
     }
 
+    backoff_.reset();
+
     register_channel(channel,
         BIND5(handle_channel_start, _1, hostname, port, channel, handler),
         BIND3(handle_channel_stop, _1, hostname, port));
@@ -181,6 +201,9 @@ void session_manual::attach_protocols(channel::ptr channel)
         attach<protocol_reject_70002>(channel)->start();
 
     attach<protocol_address_31402>(channel)->start();
+
+    if (settings_.inventory_relay_milliseconds != 0)
+        attach<protocol_inventory_relay>(channel)->start();
 }
 
 void session_manual::handle_channel_stop(const code& ec,
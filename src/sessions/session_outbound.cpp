@@ -18,30 +18,62 @@
  */
 #include <bitcoin/network/sessions/session_outbound.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <set>
+#include <utility>
+#include <vector>
 #include <bitcoin/bitcoin.hpp>
 #include <bitcoin/network/p2p.hpp>
 #include <bitcoin/network/protocols/protocol_address_31402.hpp>
+#include <bitcoin/network/protocols/protocol_inventory_relay.hpp>
 #include <bitcoin/network/protocols/protocol_ping_31402.hpp>
 #include <bitcoin/network/protocols/protocol_ping_60001.hpp>
 #include <bitcoin/network/protocols/protocol_reject_70002.hpp>
 #include <bitcoin/network/protocols/protocol_version_31402.hpp>
 #include <bitcoin/network/protocols/protocol_version_70002.hpp>
+#include <bitcoin/network/subnet.hpp>
 
 namespace libbitcoin {
 namespace network {
 
 #define CLASS session_outbound
+#define NAME "session_outbound"
 
 using namespace std::placeholders;
 
+// Dead addresses are common, so retry promptly but back off if persistent.
+static const auto outbound_initial_delay = asio::milliseconds(250);
+static const auto outbound_maximum_delay = asio::seconds(30);
+
+// The slowest peer is rotated out when its latency exceeds this multiple of
+// the median, given at least the minimum number of measured peers.
+static const int rotation_factor = 2;
+static const size_t rotation_minimum_peers = 3;
+
+// Addresses are resampled this many times to avoid connected network groups.
+static const size_t group_attempts = 8;
+
 session_outbound::session_outbound(p2p& network, bool notify_on_connect)
   : session_batch(network, notify_on_connect),
+    backoff_(outbound_initial_delay, outbound_maximum_delay),
+    connecting_(0),
+    waiting_(0),
     CONSTRUCT_TRACK(session_outbound)
 {
 }
 
+std::string session_outbound::name() const
+{
+    return NAME;
+}
+
+bool session_outbound::validate_checksum() const
+{
+    return settings_.validate_checksum || settings_.validate_outbound_checksum;
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 
@@ -69,9 +101,18 @@ void session_outbound::handle_started(const code& ec, result_handler handler)
         return;
     }
 
-    for (size_t peer = 0; peer < settings_.outbound_connections; ++peer)
+    const auto saved = load_anchors();
+    const size_t slots = settings_.outbound_connections;
+    const auto anchored = std::min(saved.size(), slots);
+
+    for (size_t peer = 0; peer < anchored; ++peer)
+        connect_anchor(saved[peer]);
+
+    for (size_t peer = anchored; peer < slots; ++peer)
         new_connection(error::success);
 
+    start_rotation();
+
     // This is the end of the start sequence.
     handler(error::success);
 }
@@ -88,21 +129,30 @@ void session_outbound::new_connection(const code&)
         return;
     }
 
+    // The slot resumes upon completion of another connect.
+    if (!reserve_slot())
+        return;
+
     session_batch::connect(BIND2(handle_connect, _1, _2));
 }
 
 void session_outbound::handle_connect(const code& ec, channel::ptr channel)
 {
+    release_slot();
+
     if (ec)
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Failure connecting outbound: " << ec.message();
 
-        // Retry with conditional delay in case of network error.
-        dispatch_delayed(cycle_delay(ec), BIND1(new_connection, _1));
+        // Retry with increasing delay in case of repeated failure.
+        dispatch_delayed(cycle_delay(ec, backoff_),
+            BIND1(new_connection, _1));
         return;
     }
 
+    backoff_.reset();
+
     register_channel(channel,
         BIND2(handle_channel_start, _1, channel),
         BIND2(handle_channel_stop, _1, channel));
@@ -124,6 +174,13 @@ void session_outbound::handle_channel_start(const code& ec,
         << "Connected outbound channel [" << channel->authority() << "] ("
         << connection_count() << ")";
 
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    channels_.push_back(channel);
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
     attach_protocols(channel);
 }
 
@@ -140,6 +197,9 @@ void session_outbound::attach_protocols(channel::ptr channel)
         attach<protocol_reject_70002>(channel)->start();
 
     attach<protocol_address_31402>(channel)->start();
+
+    if (settings_.inventory_relay_milliseconds != 0)
+        attach<protocol_inventory_relay>(channel)->start();
 }
 
 void session_outbound::attach_handshake_protocols(channel::ptr channel,
@@ -160,12 +220,12 @@ void session_outbound::attach_handshake_protocols(channel::ptr channel,
     // The negotiated_version is initialized to the configured maximum.
     if (channel->negotiated_version() >= message::version::level::bip61)
         attach<protocol_version_70002>(channel, own_version, own_services,
-            invalid_services, minimum_version, minimum_services, relay)
-            ->start(handle_started);
+            invalid_services, minimum_version, minimum_services, relay,
+            version_template())->start(handle_started);
     else
         attach<protocol_version_31402>(channel, own_version, own_services,
-            invalid_services, minimum_version, minimum_services)
-            ->start(handle_started);
+            invalid_services, minimum_version, minimum_services,
+            version_template())->start(handle_started);
 }
 
 void session_outbound::handle_channel_stop(const code& ec,
@@ -175,9 +235,270 @@ void session_outbound::handle_channel_stop(const code& ec,
         << "Outbound channel stopped [" << channel->authority() << "] "
         << ec.message();
 
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+    channels_.erase(std::remove(channels_.begin(), channels_.end(), channel),
+        channels_.end());
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
     new_connection(error::success);
 }
 
+// Anchors.
+// ----------------------------------------------------------------------------
+// Peers connected at the last stop are likely to accept again at once.
+
+bool session_outbound::save_anchors() const
+{
+    anchors::list values;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    for (const auto channel: channels_)
+        values.push_back({ channel->authority(),
+            channel->negotiated_version(), channel->round_trip() });
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    const auto saved = anchors(settings_.anchors_file).save(values);
+
+    if (!saved)
+        LOG_WARNING(LOG_NETWORK)
+            << "Failed to save anchors file.";
+
+    return saved;
+}
+
+// The fastest anchors are preferred, and those not measured are last.
+// Of anchors sharing an authority or network group only the fastest is kept,
+// so that anchors do not bypass the group diversity of fetch_address.
+anchors::list session_outbound::load_anchors() const
+{
+    auto values = anchors(settings_.anchors_file).load();
+    const auto self = settings_.self.port() != 0;
+
+    values.erase(std::remove_if(values.begin(), values.end(),
+        [this, self](const anchors::anchor& value)
+        {
+            return value.version < settings_.protocol_minimum ||
+                (self && value.authority == settings_.self) ||
+                blacklisted(value.authority);
+        }), values.end());
+
+    std::stable_sort(values.begin(), values.end(),
+        [](const anchors::anchor& left, const anchors::anchor& right)
+        {
+            const auto zero = asio::duration::zero();
+            return left.round_trip != zero && (right.round_trip == zero ||
+                left.round_trip < right.round_trip);
+        });
+
+    std::set<subnet> groups;
+
+    // A duplicate authority is also a duplicate group.
+    values.erase(std::remove_if(values.begin(), values.end(),
+        [&groups](const anchors::anchor& value)
+        {
+            return !groups.insert(subnet::group(value.authority)).second;
+        }), values.end());
+
+    if (!values.empty())
+        LOG_INFO(LOG_NETWORK)
+            << "Loaded (" << values.size() << ") outbound anchors.";
+
+    return values;
+}
+
+void session_outbound::connect_anchor(const anchors::anchor& anchor)
+{
+    if (stopped())
+        return;
+
+    const auto& host = anchor.authority;
+
+    // The slot resumes as a batch connection upon completion of another.
+    if (!reserve_slot())
+        return;
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Connecting to anchor [" << host << "]";
+
+    const auto connector = create_connector();
+    pend(connector);
+
+    // OUTBOUND CONNECT
+    connector->connect(host,
+        BIND4(handle_anchor_connect, _1, _2, host, connector));
+}
+
+void session_outbound::handle_anchor_connect(const code& ec,
+    channel::ptr channel, const config::authority& host,
+    connector::ptr connector)
+{
+    unpend(connector);
+    record_connect(ec, connector);
+    release_slot();
+
+    // The slot of a failed anchor reverts to batch connection.
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure connecting to anchor [" << host << "] "
+            << ec.message();
+        new_connection(error::success);
+        return;
+    }
+
+    register_channel(channel,
+        BIND2(handle_channel_start, _1, channel),
+        BIND2(handle_channel_stop, _1, channel));
+}
+
+// Connect scheduling.
+// ----------------------------------------------------------------------------
+// Limiting concurrent connects keeps batches from saturating the host pool.
+
+bool session_outbound::reserve_slot()
+{
+    const auto limit = settings_.outbound_connect_limit;
+
+    if (limit == 0)
+        return true;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (connecting_ >= limit)
+    {
+        ++waiting_;
+        return false;
+    }
+
+    ++connecting_;
+    return true;
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void session_outbound::release_slot()
+{
+    if (settings_.outbound_connect_limit == 0)
+        return;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    --connecting_;
+    const auto resume = waiting_ != 0;
+
+    if (resume)
+        --waiting_;
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (resume)
+        new_connection(error::success);
+}
+
+// Peers sharing a network group are likely under common control or routing,
+// so sampling the host pool away from connected groups improves diversity.
+code session_outbound::fetch_address(address& out_address) const
+{
+    std::set<subnet> groups;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    for (const auto channel: channels_)
+        groups.insert(subnet::group(channel->authority()));
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    code ec;
+
+    // If all attempts collide the last address is used (best effort).
+    for (size_t attempt = 0; attempt < group_attempts; ++attempt)
+    {
+        ec = session_batch::fetch_address(out_address);
+
+        if (ec || groups.empty())
+            break;
+
+        const auto group = subnet::group(authority(out_address));
+
+        if (groups.find(group) == groups.end())
+            break;
+    }
+
+    return ec;
+}
+
+// Rotation cycle.
+// ----------------------------------------------------------------------------
+// Replacing the slowest of a full set of peers lowers propagation latency.
+
+void session_outbound::start_rotation()
+{
+    if (stopped() || settings_.outbound_rotation_minutes == 0)
+        return;
+
+    dispatch_delayed(settings_.outbound_rotation(),
+        BIND1(handle_rotation, _1));
+}
+
+void session_outbound::handle_rotation(const code& ec)
+{
+    if (stopped(ec))
+        return;
+
+    typedef std::pair<asio::duration, channel::ptr> ranked;
+    std::vector<ranked> ranks;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    // Scores are read once, as they may change while sorting.
+    if (channels_.size() >= settings_.outbound_connections)
+        for (const auto channel: channels_)
+            if (channel->round_trip() != asio::duration::zero())
+                ranks.emplace_back(channel->latency_score(), channel);
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    if (ranks.size() >= rotation_minimum_peers)
+    {
+        std::sort(ranks.begin(), ranks.end(),
+            [](const ranked& left, const ranked& right)
+            {
+                return left.first < right.first;
+            });
+
+        const auto median = ranks[ranks.size() / 2].first;
+        const auto& slowest = ranks.back();
+
+        if (slowest.first > median * rotation_factor)
+        {
+            LOG_DEBUG(LOG_NETWORK)
+                << "Rotating out slow outbound channel ["
+                << slowest.second->authority() << "]";
+            slowest.second->stop(error::channel_timeout);
+        }
+    }
+
+    start_rotation();
+}
+
 // Channel start sequence.
 // ----------------------------------------------------------------------------
 // Pend outgoing connections so we can detect connection to self.
@@ -40,12 +40,36 @@ namespace network {
 static const size_t minimum_host_increase = 100;
 
 using namespace std::placeholders;
+
+session_seed::seeding::seeding(size_t target, size_t size,
+    result_handler handler)
+  : target(target),
+    handler(handler),
+    complete(false),
+    remaining(size)
+{
+}
+
 session_seed::session_seed(p2p& network)
   : session(network, false),
+    seed_template_(protocol_version_31402::make_template(
+        network.network_settings(),
+        network.network_settings().protocol_maximum,
+        message::version::service::none, false)),
     CONSTRUCT_TRACK(session_seed)
 {
 }
 
+std::string session_seed::name() const
+{
+    return NAME;
+}
+
+version_const_ptr session_seed::version_template() const
+{
+    return seed_template_;
+}
+
 // Start sequence.
 // ----------------------------------------------------------------------------
 
@@ -81,7 +105,7 @@ void session_seed::handle_started(const code& ec, result_handler handler)
         return;
     }
 
-    if (settings_.seeds.empty())
+    if (settings_.seeds.empty() && settings_.dns_seeds.empty())
     {
         LOG_ERROR(LOG_NETWORK)
             << "Seeding is required but no seeds are configured.";
@@ -109,62 +133,87 @@ void session_seed::attach_handshake_protocols(channel::ptr channel,
     // The negotiated_version is initialized to the configured maximum.
     if (channel->negotiated_version() >= message::version::level::bip61)
         attach<protocol_version_70002>(channel, own_version, own_services,
-            invalid_services, minimum_version, minimum_services, relay)
-            ->start(handle_started);
+            invalid_services, minimum_version, minimum_services, relay,
+            version_template())->start(handle_started);
     else
         attach<protocol_version_31402>(channel, own_version, own_services,
-            invalid_services, minimum_version, minimum_services)
-            ->start(handle_started);
+            invalid_services, minimum_version, minimum_services,
+            version_template())->start(handle_started);
 }
 
 // Seed sequence.
 // ----------------------------------------------------------------------------
+// Seeds are contacted concurrently and seeding completes as soon as the host
+// increase is reached, canceling the slower seeds, or once all have finished.
 
 void session_seed::start_seeding(size_t start_size, result_handler handler)
 {
-    const auto complete = BIND2(handle_complete, start_size, handler);
+    const auto target = ceiling_add(start_size, minimum_host_increase);
+    const auto seeds = settings_.seeds.size() + settings_.dns_seeds.size();
+    const auto state = std::make_shared<seeding>(target, seeds, handler);
+    state->connectors.reserve(settings_.seeds.size());
 
-    const auto join_handler = synchronize(complete, settings_.seeds.size(),
-        NAME, synchronizer_terminate::on_count);
+    // All connectors exist before any attempt, so all can be canceled.
+    for (size_t seed = 0; seed < settings_.seeds.size(); ++seed)
+        state->connectors.push_back(create_connector());
 
     // We don't use parallel here because connect is itself asynchronous.
-    for (const auto& seed: settings_.seeds)
-        start_seed(seed, join_handler);
+    for (size_t seed = 0; seed < settings_.seeds.size(); ++seed)
+        start_seed(settings_.seeds[seed], state->connectors[seed], state);
+
+    // Name resolution is also asynchronous.
+    for (const auto& seed: settings_.dns_seeds)
+        start_dns_seed(seed, state);
 }
 
 void session_seed::start_seed(const config::endpoint& seed,
-    result_handler handler)
+    connector::ptr connector, seeding::ptr state)
 {
     if (stopped())
     {
         LOG_DEBUG(LOG_NETWORK)
             << "Suspended seed connection";
-        handler(error::channel_stopped);
+        handle_complete(error::channel_stopped, state);
+        return;
+    }
+
+    if (state->complete)
+    {
+        handle_complete(error::channel_stopped, state);
         return;
     }
 
     LOG_INFO(LOG_NETWORK)
         << "Contacting seed [" << seed << "]";
 
-    const auto connector = create_connector();
     pend(connector);
 
     // OUTBOUND CONNECT
     connector->connect(seed,
-        BIND5(handle_connect, _1, _2, seed, connector, handler));
+        BIND5(handle_connect, _1, _2, seed, connector, state));
 }
 
 void session_seed::handle_connect(const code& ec, channel::ptr channel,
     const config::endpoint& seed, connector::ptr connector,
-    result_handler handler)
+    seeding::ptr state)
 {
     unpend(connector);
+    record_connect(ec, connector);
 
     if (ec)
     {
         LOG_INFO(LOG_NETWORK)
             << "Failure contacting seed [" << seed << "] " << ec.message();
-        handler(ec);
+        handle_complete(ec, state);
+        return;
+    }
+
+    if (state->complete)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Dropping seed [" << seed << "] connected after completion.";
+        channel->stop(error::channel_stopped);
+        handle_complete(error::channel_stopped, state);
         return;
     }
 
@@ -173,7 +222,7 @@ void session_seed::handle_connect(const code& ec, channel::ptr channel,
         LOG_DEBUG(LOG_NETWORK)
             << "Seed [" << seed << "] on blacklisted address ["
             << channel->authority() << "]";
-        handler(error::address_blocked);
+        handle_complete(error::address_blocked, state);
         return;
     }
 
@@ -181,20 +230,90 @@ void session_seed::handle_connect(const code& ec, channel::ptr channel,
         << "Connected seed [" << seed << "] as " << channel->authority();
 
     register_channel(channel,
-        BIND3(handle_channel_start, _1, channel, handler),
+        BIND3(handle_channel_start, _1, channel, state),
         BIND1(handle_channel_stop, _1));
 }
 
+// DNS seeds answer with the addresses of recently good peers, so one round of
+// queries can populate the host pool without a connection to any seed.
+void session_seed::start_dns_seed(const config::endpoint& seed,
+    seeding::ptr state)
+{
+    if (stopped() || state->complete)
+    {
+        handle_complete(error::channel_stopped, state);
+        return;
+    }
+
+    LOG_INFO(LOG_NETWORK)
+        << "Querying DNS seed [" << seed << "]";
+
+    resolve(seed.host(), seed.port(),
+        BIND4(handle_dns_seed, _1, _2, seed, state));
+}
+
+void session_seed::handle_dns_seed(const code& ec,
+    const dns_cache::endpoints& resolved, const config::endpoint& seed,
+    seeding::ptr state)
+{
+    if (ec)
+    {
+        LOG_INFO(LOG_NETWORK)
+            << "Failure querying DNS seed [" << seed << "] " << ec.message();
+        handle_complete(ec, state);
+        return;
+    }
+
+    // DNS seeds list only full nodes, seen recently by the seed's crawler.
+    const auto now = static_cast<uint32_t>(zulu_time());
+    address::list addresses;
+    addresses.reserve(resolved.size());
+
+    for (const auto& endpoint: resolved)
+    {
+        const authority host(endpoint);
+
+        if (blacklisted(host))
+            continue;
+
+        auto address = host.to_network_address();
+        address.set_timestamp(now);
+        address.set_services(message::version::service::node_network);
+        addresses.push_back(address);
+    }
+
+    LOG_DEBUG(LOG_NETWORK)
+        << "Storing addresses from DNS seed [" << seed << "] ("
+        << addresses.size() << ")";
+
+    store(addresses, BIND2(handle_complete, _1, state));
+}
+
 void session_seed::handle_channel_start(const code& ec, channel::ptr channel,
-    result_handler handler)
+    seeding::ptr state)
 {
     if (ec)
     {
-        handler(ec);
+        handle_complete(ec, state);
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    state->mutex.lock();
+    state->channels.push_back(channel);
+    state->mutex.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Completion may have collected the channels before this was added.
+    if (state->complete)
+    {
+        channel->stop(error::channel_stopped);
+        handle_complete(error::channel_stopped, state);
         return;
     }
 
-    attach_protocols(channel, handler);
+    attach_protocols(channel, BIND2(handle_complete, _1, state));
 }
 
 void session_seed::attach_protocols(channel::ptr channel,
@@ -219,15 +338,40 @@ void session_seed::handle_channel_stop(const code& ec)
         << "Seed channel stopped: " << ec.message();
 }
 
-// This accepts no error code because individual seed errors are suppressed.
-void session_seed::handle_complete(size_t start_size, result_handler handler)
+// This is invoked once for each seed, whether it succeeded or failed.
+// Individual seed errors are suppressed, as only the host increase matters.
+void session_seed::handle_complete(const code&, seeding::ptr state)
 {
+    const auto remaining = --state->remaining;
+
     // We succeed only if there is a host count increase of at least 100.
-    const auto increase = address_count() >=
-        ceiling_add(start_size, minimum_host_increase);
+    const auto increase = address_count() >= state->target;
+
+    if ((!increase && remaining != 0) || state->complete.exchange(true))
+        return;
+
+    if (remaining != 0)
+    {
+        LOG_INFO(LOG_NETWORK)
+            << "Seeding complete, canceling (" << remaining << ") seeds.";
+
+        // Stopping a completed connector has no effect.
+        for (const auto connector: state->connectors)
+            connector->stop(error::service_stopped);
+
+        // Critical Section
+        ///////////////////////////////////////////////////////////////////////
+        state->mutex.lock_shared();
+        const auto channels = state->channels;
+        state->mutex.unlock_shared();
+        ///////////////////////////////////////////////////////////////////////
+
+        for (const auto channel: channels)
+            channel->stop(error::channel_stopped);
+    }
 
     // This is the end of the seed sequence.
-    handler(increase ? error::success : error::peer_throttling);
+    state->handler(increase ? error::success : error::peer_throttling);
 }
 
 } // namespace network
@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/sessions/session_sync.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/protocols/protocol_ping_31402.hpp>
+#include <bitcoin/network/protocols/protocol_ping_60001.hpp>
+#include <bitcoin/network/protocols/protocol_reject_70002.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define CLASS session_sync
+
+using namespace std::placeholders;
+
+// Dead addresses are common, so retry promptly but back off if persistent.
+static const auto sync_initial_delay = asio::milliseconds(250);
+static const auto sync_maximum_delay = asio::seconds(30);
+
+session_sync::session_sync(p2p& network)
+  : session_outbound(network, false),
+    complete_(false),
+    backoff_(sync_initial_delay, sync_maximum_delay)
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void session_sync::start(result_handler handler)
+{
+    if (settings_.outbound_connections == 0)
+    {
+        LOG_ERROR(LOG_NETWORK)
+            << "Sync [" << name() << "] is required but outbound connections "
+            << "are not.";
+        handler(error::operation_failed);
+        return;
+    }
+
+    session::start(CONCURRENT_DELEGATE2(handle_started, _1, handler));
+}
+
+void session_sync::handle_started(const code& ec, result_handler handler)
+{
+    if (ec)
+    {
+        handler(ec);
+        return;
+    }
+
+    // This is NOT the end of the start sequence, since the handler is not
+    // invoked until sync is complete.
+    for (size_t peer = 0; peer < settings_.outbound_connections; ++peer)
+        new_connection(error::success, handler);
+}
+
+// Connect cycle.
+// ----------------------------------------------------------------------------
+
+void session_sync::new_connection(const code&, result_handler handler)
+{
+    if (complete_)
+        return;
+
+    if (stopped())
+    {
+        handle_complete(error::service_stopped, handler);
+        return;
+    }
+
+    session_batch::connect(BIND3(handle_connect, _1, _2, handler));
+}
+
+void session_sync::handle_connect(const code& ec, channel::ptr channel,
+    result_handler handler)
+{
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure connecting [" << name() << "]: " << ec.message();
+
+        // Retry with increasing delay in case of repeated failure.
+        dispatch_delayed(cycle_delay(ec, backoff_),
+            BIND2(new_connection, _1, handler));
+        return;
+    }
+
+    backoff_.reset();
+
+    register_channel(channel,
+        BIND3(handle_channel_start, _1, channel, handler),
+        BIND2(handle_channel_stop, _1, handler));
+}
+
+void session_sync::handle_channel_start(const code& ec, channel::ptr channel,
+    result_handler handler)
+{
+    // The start failure is also caught by handle_channel_stop.
+    if (ec)
+        return;
+
+    LOG_INFO(LOG_NETWORK)
+        << "Connected [" << name() << "] channel [" << channel->authority()
+        << "]";
+
+    attach_protocols(channel, handler);
+}
+
+void session_sync::attach_protocols(channel::ptr channel,
+    result_handler handler)
+{
+    const auto version = channel->negotiated_version();
+
+    if (version >= message::version::level::bip31)
+        attach<protocol_ping_60001>(channel)->start();
+    else
+        attach<protocol_ping_31402>(channel)->start();
+
+    if (version >= message::version::level::bip61)
+        attach<protocol_reject_70002>(channel)->start();
+
+    attach_sync_protocol(channel, BIND2(handle_complete, _1, handler));
+}
+
+void session_sync::handle_channel_stop(const code& ec,
+    result_handler handler)
+{
+    LOG_DEBUG(LOG_NETWORK)
+        << "Channel [" << name() << "] stopped: " << ec.message();
+
+    new_connection(error::success, handler);
+}
+
+// The first completion of the sync, or of the session, ends the session.
+void session_sync::handle_complete(const code& ec, result_handler handler)
+{
+    if (complete_.exchange(true))
+        return;
+
+    // This is the end of the sync sequence.
+    handler(ec);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -18,7 +18,10 @@
  */
 #include <bitcoin/network/settings.hpp>
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <bitcoin/bitcoin.hpp>
 
 namespace libbitcoin {
@@ -30,24 +33,61 @@ using namespace bc::message;
 // Common default values (no settings context).
 settings::settings()
   : threads(0),
+    channel_shards(0),
     protocol_maximum(version::level::maximum),
     protocol_minimum(version::level::minimum),
     services(version::service::none),
     invalid_services(176),
     relay_transactions(false),
     validate_checksum(false),
+    validate_inbound_checksum(false),
+    validate_outbound_checksum(false),
+    validate_manual_checksum(false),
     inbound_connections(0),
+    inbound_accepts(4),
+    inbound_subnet_limit(0),
+    inbound_accept_rate(0),
+    inbound_eviction_idle_seconds(0),
+    inbound_backlog(0),
+    inbound_transport_only(false),
     outbound_connections(8),
+    outbound_rotation_minutes(10),
+    outbound_connect_limit(4),
     manual_attempt_limit(0),
     connect_batch_size(5),
     connect_timeout_seconds(5),
+    connect_attempt_delay_milliseconds(250),
     channel_handshake_seconds(30),
+    channel_handshake_pipelining(false),
     channel_germination_seconds(30),
     channel_heartbeat_minutes(5),
     channel_inactivity_minutes(10),
     channel_expiration_minutes(1440),
+    header_sync_stall_seconds(30),
+    block_download_stall_seconds(10),
+    block_download_window(64),
+    inventory_relay_milliseconds(1000),
+    inventory_relay_batch(1000),
+    known_inventory_capacity(50000),
     host_pool_capacity(0),
+    host_pool_shards(8),
+    hosts_checkpoint_minutes(10),
+    address_cache_minutes(60),
+    address_accepts_per_minute(6),
+    dns_cache_minutes(10),
+    dns_negative_cache_seconds(30),
+    buffer_pool_megabytes(64),
+    channel_cache_size(100),
+    read_buffer_bytes(65536),
+    send_batch_bytes(262144),
+    send_high_water_bytes(16777216),
+    send_high_water_messages(1000),
+    socket_no_delay(true),
+    socket_keep_alive(true),
+    socket_send_buffer_bytes(0),
+    socket_receive_buffer_bytes(0),
     hosts_file("hosts.cache"),
+    anchors_file("anchors.cache"),
     self(unspecified_network_address),
 
     // [log]
@@ -59,6 +99,7 @@ settings::settings()
     maximum_archive_size(0),
     maximum_archive_files(0),
     statistics_server(unspecified_network_address),
+    statistics_interval_seconds(10),
     verbose(false)
 {
 }
@@ -116,11 +157,54 @@ size_t settings::minimum_connections() const
     return ceiling_add<size_t>(outbound_connections, peers.size());
 }
 
+size_t settings::buffer_pool_capacity() const
+{
+    static const size_t megabyte = 1024 * 1024;
+    const auto limit = max_size_t / megabyte;
+    return std::min(static_cast<size_t>(buffer_pool_megabytes), limit) *
+        megabyte;
+}
+
+// Zero uses the system maximum.
+int settings::listen_backlog() const
+{
+    static const auto maximum = static_cast<uint32_t>(
+        std::numeric_limits<int>::max());
+
+    if (inbound_backlog == 0)
+        return asio::max_connections;
+
+    return static_cast<int>(std::min(inbound_backlog, maximum));
+}
+
+// Zero retains the system default.
+int settings::socket_send_buffer() const
+{
+    static const auto maximum = static_cast<uint32_t>(
+        std::numeric_limits<int>::max());
+
+    return static_cast<int>(std::min(socket_send_buffer_bytes, maximum));
+}
+
+// Zero retains the system default.
+int settings::socket_receive_buffer() const
+{
+    static const auto maximum = static_cast<uint32_t>(
+        std::numeric_limits<int>::max());
+
+    return static_cast<int>(std::min(socket_receive_buffer_bytes, maximum));
+}
+
 duration settings::connect_timeout() const
 {
     return seconds(connect_timeout_seconds);
 }
 
+duration settings::connect_attempt_delay() const
+{
+    return milliseconds(connect_attempt_delay_milliseconds);
+}
+
 duration settings::channel_handshake() const
 {
     return seconds(channel_handshake_seconds);
@@ -146,5 +230,55 @@ duration settings::channel_germination() const
     return seconds(channel_germination_seconds);
 }
 
+duration settings::header_sync_stall() const
+{
+    return seconds(header_sync_stall_seconds);
+}
+
+duration settings::block_download_stall() const
+{
+    return seconds(block_download_stall_seconds);
+}
+
+duration settings::inventory_relay() const
+{
+    return milliseconds(inventory_relay_milliseconds);
+}
+
+duration settings::hosts_checkpoint() const
+{
+    return minutes(hosts_checkpoint_minutes);
+}
+
+duration settings::address_cache() const
+{
+    return minutes(address_cache_minutes);
+}
+
+duration settings::outbound_rotation() const
+{
+    return minutes(outbound_rotation_minutes);
+}
+
+duration settings::inbound_eviction_idle() const
+{
+    return seconds(inbound_eviction_idle_seconds);
+}
+
+duration settings::dns_ttl() const
+{
+    return minutes(dns_cache_minutes);
+}
+
+duration settings::dns_negative_ttl() const
+{
+    return seconds(dns_negative_cache_seconds);
+}
+
+duration settings::statistics_interval() const
+{
+    return seconds(statistics_interval_seconds);
+}
+
 } // namespace network
 } // namespace libbitcoin
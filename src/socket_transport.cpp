@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/socket_transport.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/settings.hpp>
+#include <bitcoin/network/transport.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace boost::asio;
+
+// Zero buffer sizes retain the system defaults.
+template <typename Socket>
+static void configure_buffers(Socket& value, const settings& settings)
+{
+    boost_code ignore;
+    const auto send = settings.socket_send_buffer();
+    const auto receive = settings.socket_receive_buffer();
+
+    if (send != 0)
+        value.set_option(socket_base::send_buffer_size(send), ignore);
+
+    if (receive != 0)
+        value.set_option(socket_base::receive_buffer_size(receive), ignore);
+}
+
+// The buffers are also set here for sockets not configured before connect.
+void socket_transport::configure(socket& connection, const settings& settings)
+{
+    boost_code ignore;
+    auto& value = connection.get();
+
+    value.set_option(ip::tcp::no_delay(settings.socket_no_delay), ignore);
+    value.set_option(socket_base::keep_alive(settings.socket_keep_alive),
+        ignore);
+
+    configure_buffers(value, settings);
+}
+
+void socket_transport::configure(asio::socket& connecting,
+    const settings& settings)
+{
+    configure_buffers(connecting, settings);
+}
+
+void socket_transport::configure(asio::acceptor& listener,
+    const settings& settings)
+{
+    configure_buffers(listener, settings);
+}
+
+// The options are read once, before the socket is shared with a proxy.
+static transport_options read_options(socket& connection)
+{
+    boost_code ignore;
+    auto& value = connection.get();
+    ip::tcp::no_delay no_delay;
+    socket_base::keep_alive keep_alive;
+    socket_base::send_buffer_size send_buffer(0);
+    socket_base::receive_buffer_size receive_buffer(0);
+
+    value.get_option(no_delay, ignore);
+    value.get_option(keep_alive, ignore);
+    value.get_option(send_buffer, ignore);
+    value.get_option(receive_buffer, ignore);
+
+    return
+    {
+        no_delay.value(),
+        keep_alive.value(),
+        static_cast<size_t>(std::max(send_buffer.value(), 0)),
+        static_cast<size_t>(std::max(receive_buffer.value(), 0))
+    };
+}
+
+socket_transport::socket_transport(socket::ptr socket)
+  : socket_(socket),
+    options_(read_options(*socket))
+{
+}
+
+config::authority socket_transport::authority() const
+{
+    return socket_->authority();
+}
+
+transport_options socket_transport::options() const
+{
+    return options_;
+}
+
+void socket_transport::read(const mutable_buffer& buffer,
+    io_handler handler)
+{
+    async_read(socket_->get(), mutable_buffers_1(buffer), handler);
+}
+
+void socket_transport::read_some(const mutable_buffer& buffer,
+    io_handler handler)
+{
+    socket_->get().async_read_some(mutable_buffers_1(buffer), handler);
+}
+
+void socket_transport::write(const const_buffers& buffers,
+    io_handler handler)
+{
+    async_write(socket_->get(), buffers, handler);
+}
+
+void socket_transport::stop()
+{
+    socket_->stop();
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,359 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/statistics_exporter.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/channel_metrics.hpp>
+#include <bitcoin/network/p2p.hpp>
+#include <bitcoin/network/settings.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+#define PREFIX "network."
+
+using namespace std::chrono;
+using namespace std::placeholders;
+
+// A datagram within the minimum internet path mtu is not fragmented.
+static const size_t maximum_datagram = 1432;
+
+// The upper bounds of the connect latency histogram buckets, beyond which
+// samples are counted in a final unbounded bucket.
+static const uint32_t latency_bounds[] =
+{
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000
+};
+
+static const size_t latency_buckets =
+    sizeof(latency_bounds) / sizeof(latency_bounds[0]) + 1;
+
+static std::string line(const std::string& name, uint64_t value,
+    const char* type)
+{
+    return PREFIX + name + ":" + std::to_string(value) + "|" + type;
+}
+
+static std::string gauge(const std::string& name, uint64_t value)
+{
+    return line(name, value, "g");
+}
+
+static std::string count(const std::string& name, uint64_t value)
+{
+    return line(name, value, "c");
+}
+
+statistics_exporter::statistics_exporter(p2p& network)
+  : network_(network),
+    pool_(network.thread_pool()),
+    settings_(network.network_settings()),
+    stopped_(true),
+    sending_(false),
+    connects_(0),
+    connect_failures_(0),
+    handshakes_(0),
+    handshake_failures_(0),
+    accepts_(0),
+    latencies_(latency_buckets)
+{
+    for (auto& latency: latencies_)
+        latency = 0;
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void statistics_exporter::start()
+{
+    const auto& server = settings_.statistics_server;
+
+    if (server.port() == 0 || settings_.statistics_interval_seconds == 0)
+        return;
+
+    const udp::endpoint endpoint(server.asio_ip(), server.port());
+    const auto socket = std::make_shared<udp::socket>(pool_.service());
+    boost_code ec;
+
+    // Connecting a datagram socket only fixes the destination.
+    socket->open(endpoint.protocol(), ec);
+
+    if (!ec)
+        socket->connect(endpoint, ec);
+
+    if (ec)
+    {
+        LOG_WARNING(LOG_NETWORK)
+            << "Failure opening statistics socket to [" << server << "] "
+            << code(error::boost_to_error_code(ec)).message();
+        return;
+    }
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(mutex_);
+
+        socket_ = socket;
+        timer_ = std::make_shared<deadline>(pool_,
+            settings_.statistics_interval());
+        stopped_ = false;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    start_timer();
+}
+
+void statistics_exporter::stop()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    if (stopped_.exchange(true))
+        return;
+
+    timer_->stop();
+
+    // Outstanding sends complete with operation_aborted.
+    boost_code ignore;
+    socket_->close(ignore);
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// Recording.
+// ----------------------------------------------------------------------------
+
+void statistics_exporter::connected(const code& ec,
+    const asio::duration& elapsed)
+{
+    if (ec)
+    {
+        connect_failures_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    connects_.fetch_add(1, std::memory_order_relaxed);
+    latencies_[bucket(elapsed)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void statistics_exporter::handshaken(const code& ec)
+{
+    auto& counter = ec ? handshake_failures_ : handshakes_;
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
+
+void statistics_exporter::accepted()
+{
+    accepts_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void statistics_exporter::registered(const std::string& session)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    ++sessions_[session];
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void statistics_exporter::removed(const std::string& session)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    unique_lock lock(mutex_);
+
+    --sessions_[session];
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+// private
+size_t statistics_exporter::bucket(const asio::duration& elapsed)
+{
+    const auto value = duration_cast<milliseconds>(elapsed).count();
+    size_t index = 0;
+
+    while (index < latency_buckets - 1 && value > latency_bounds[index])
+        ++index;
+
+    return index;
+}
+
+// Export sequence.
+// ----------------------------------------------------------------------------
+
+void statistics_exporter::start_timer()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (stopped_)
+        return;
+
+    timer_->start(
+        std::bind(&statistics_exporter::handle_timer,
+            shared_from_this(), _1));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void statistics_exporter::handle_timer(const code& ec)
+{
+    if (stopped_ || ec == error::service_stopped)
+        return;
+
+    // A slow or unreachable server delays the next push, not the network.
+    if (!sending_.exchange(true))
+        send(std::make_shared<datagrams>(collect()), 0);
+
+    start_timer();
+}
+
+// Counters are reset upon collection, so each push covers one interval.
+statistics_exporter::datagrams statistics_exporter::collect()
+{
+    std::vector<std::string> lines;
+
+    lines.push_back(gauge("connections", network_.connection_count()));
+    lines.push_back(gauge("hosts", network_.address_count()));
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock_shared();
+
+    for (const auto& session: sessions_)
+        lines.push_back(gauge("sessions." + session.first,
+            static_cast<uint64_t>(std::max(session.second, int64_t(0)))));
+
+    mutex_.unlock_shared();
+    ///////////////////////////////////////////////////////////////////////////
+
+    lines.push_back(count("connects", connects_.exchange(0)));
+    lines.push_back(count("connect_failures", connect_failures_.exchange(0)));
+    lines.push_back(count("handshakes", handshakes_.exchange(0)));
+    lines.push_back(count("handshake_failures",
+        handshake_failures_.exchange(0)));
+    lines.push_back(count("accepts", accepts_.exchange(0)));
+
+    for (size_t index = 0; index < latency_buckets; ++index)
+    {
+        const auto bound = index < latency_buckets - 1 ?
+            std::to_string(latency_bounds[index]) : std::string("inf");
+
+        lines.push_back(count("connect_latency.le_" + bound,
+            latencies_[index].exchange(0)));
+    }
+
+    // Traffic is totaled over the channels open at the time of collection.
+    std::vector<uint64_t> received;
+    std::vector<uint64_t> sent;
+    uint64_t queued = 0;
+
+    for (const auto& channel: network_.statistics())
+    {
+        received.resize(channel.received.size(), 0);
+        sent.resize(channel.sent.size(), 0);
+        queued += channel.queued_bytes;
+
+        for (size_t type = 0; type < channel.received.size(); ++type)
+            received[type] += channel.received[type].bytes;
+
+        for (size_t type = 0; type < channel.sent.size(); ++type)
+            sent[type] += channel.sent[type].bytes;
+    }
+
+    lines.push_back(gauge("queued_bytes", queued));
+
+    const auto command = [](size_t type)
+    {
+        return channel_metrics::to_command(
+            static_cast<message::message_type>(type));
+    };
+
+    for (size_t type = 0; type < received.size(); ++type)
+        if (received[type] != 0)
+            lines.push_back(gauge("received_bytes." + command(type),
+                received[type]));
+
+    for (size_t type = 0; type < sent.size(); ++type)
+        if (sent[type] != 0)
+            lines.push_back(gauge("sent_bytes." + command(type), sent[type]));
+
+    // Pack the lines into as few datagrams as possible.
+    datagrams out(1);
+
+    for (const auto& entry: lines)
+    {
+        if (!out.back().empty() &&
+            out.back().size() + entry.size() + 1 > maximum_datagram)
+            out.emplace_back();
+
+        out.back() += entry + "\n";
+    }
+
+    return out;
+}
+
+// Datagrams are sent one at a time, in order.
+void statistics_exporter::send(datagrams_ptr batch, size_t index)
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (stopped_ || index == batch->size())
+    {
+        sending_ = false;
+        return;
+    }
+
+    socket_->async_send(boost::asio::buffer((*batch)[index]),
+        std::bind(&statistics_exporter::handle_send,
+            shared_from_this(), _1, batch, index));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void statistics_exporter::handle_send(const boost_code& ec,
+    datagrams_ptr batch, size_t index)
+{
+    // An unreachable server is not retried until the next interval.
+    if (ec)
+    {
+        LOG_DEBUG(LOG_NETWORK)
+            << "Failure sending statistics "
+            << code(error::boost_to_error_code(ec)).message();
+        sending_ = false;
+        return;
+    }
+
+    send(batch, index + 1);
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/stream_decoder.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <bitcoin/bitcoin.hpp>
+#include <bitcoin/network/message_subscriber.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace bc::message;
+
+// A stream over received bytes, counting those consumed by a parse.
+class received_buffer
+  : public std::streambuf
+{
+public:
+    received_buffer(const uint8_t* data, size_t size)
+    {
+        const auto begin = reinterpret_cast<char*>(const_cast<uint8_t*>(data));
+        setg(begin, begin, begin + size);
+    }
+
+    size_t consumed() const
+    {
+        return static_cast<size_t>(gptr() - eback());
+    }
+};
+
+stream_decoder::stream_decoder(const message_subscriber& subscriber)
+  : subscriber_(subscriber),
+    type_(message_type::unknown),
+    version_(0),
+    stage_(stage::done),
+    size_(0),
+    offset_(0),
+    pending_(0),
+    count_(0),
+    index_(0)
+{
+}
+
+bool stream_decoder::start(message_type type, uint32_t version,
+    size_t size)
+{
+    type_ = type;
+    version_ = version;
+    size_ = size;
+    offset_ = 0;
+    pending_ = 0;
+    count_ = 0;
+    index_ = 0;
+    header_.reset();
+
+    if (!subscriber_.stream_subscribed(type))
+    {
+        stage_ = stage::done;
+        return false;
+    }
+
+    // A headers message has no block header, only a count of headers.
+    stage_ = type == message_type::block ? stage::header : stage::count;
+    return true;
+}
+
+bool stream_decoder::streaming() const
+{
+    return stage_ != stage::done;
+}
+
+void stream_decoder::parse(const uint8_t* payload, size_t size)
+{
+    const auto complete = size >= size_;
+
+    while (stage_ != stage::done && offset_ < size)
+    {
+        const auto available = size - offset_;
+
+        // Wait for the bytes of an incomplete part to double, bounding the
+        // total of its repeated parses to a multiple of its size.
+        if (!complete && available < 2 * pending_)
+            return;
+
+        received_buffer buffer(payload + offset_, available);
+        std::istream stream(&buffer);
+        istream_reader source(stream);
+
+        // The part is incomplete, or invalid if the payload is complete.
+        if (!parse_next(source))
+        {
+            pending_ = available;
+            return;
+        }
+
+        offset_ += buffer.consumed();
+        pending_ = 0;
+    }
+}
+
+// private
+bool stream_decoder::parse_next(reader& source)
+{
+    switch (stage_)
+    {
+        case stage::header:
+        {
+            const auto header = std::make_shared<chain::header>();
+
+            if (!header->from_data(source))
+                return false;
+
+            header_ = header;
+            stage_ = stage::count;
+            return true;
+        }
+
+        case stage::count:
+        {
+            const auto count = source.read_size_little_endian();
+
+            if (!source)
+                return false;
+
+            count_ = count;
+            stage_ = count_ == 0 ? stage::done : stage::parts;
+            return true;
+        }
+
+        case stage::parts:
+        {
+            if (type_ == message_type::block)
+            {
+                const auto transaction =
+                    std::make_shared<chain::transaction>();
+
+                if (!transaction->from_data(source, true, true))
+                    return false;
+
+                subscriber_.notify_block_part(header_, index_, transaction);
+            }
+            else
+            {
+                const auto header = std::make_shared<message::header>();
+
+                if (!header->from_data(version_, source))
+                    return false;
+
+                subscriber_.notify_headers_part(index_, header);
+            }
+
+            stage_ = ++index_ == count_ ? stage::done : stage::parts;
+            return true;
+        }
+
+        default:
+        case stage::done:
+            return false;
+    }
+}
+
+} // namespace network
+} // namespace libbitcoin
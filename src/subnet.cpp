@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/subnet.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <boost/program_options.hpp>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace boost::program_options;
+
+static const uint8_t ipv6_bits = 128;
+static const uint8_t ipv4_bits = 32;
+static const uint8_t mapped_bits = ipv6_bits - ipv4_bits;
+static const uint8_t ipv4_group_bits = 16;
+static const uint8_t ipv6_group_bits = 32;
+
+// Clear the host bits of the address.
+static asio::ipv6 mask(const asio::ipv6& ip, uint8_t prefix)
+{
+    auto bytes = ip.to_bytes();
+
+    for (size_t bit = prefix; bit < ipv6_bits; ++bit)
+        bytes[bit / 8] &= ~(0x80 >> (bit % 8));
+
+    return asio::ipv6(bytes);
+}
+
+subnet subnet::group(const config::authority& authority)
+{
+    const auto ip = authority.ip();
+    return { ip, ip.is_v4_mapped() ? uint8_t(mapped_bits + ipv4_group_bits) :
+        ipv6_group_bits };
+}
+
+subnet::subnet()
+  : subnet(asio::ipv6(), ipv6_bits)
+{
+}
+
+subnet::subnet(const std::string& value)
+  : subnet()
+{
+    std::stringstream(value) >> *this;
+}
+
+subnet::subnet(const config::authority& authority)
+  : subnet(authority.ip(), ipv6_bits)
+{
+}
+
+subnet::subnet(const asio::ipv6& ip, uint8_t prefix)
+  : ip_(mask(ip, std::min(prefix, ipv6_bits))),
+    prefix_(std::min(prefix, ipv6_bits))
+{
+}
+
+const asio::ipv6& subnet::ip() const
+{
+    return ip_;
+}
+
+uint8_t subnet::prefix() const
+{
+    return prefix_;
+}
+
+std::string subnet::to_string() const
+{
+    std::stringstream value;
+    value << *this;
+    return value.str();
+}
+
+bool subnet::operator==(const subnet& other) const
+{
+    return ip_ == other.ip_ && prefix_ == other.prefix_;
+}
+
+bool subnet::operator!=(const subnet& other) const
+{
+    return !(*this == other);
+}
+
+bool subnet::operator<(const subnet& other) const
+{
+    return ip_ < other.ip_ || (ip_ == other.ip_ && prefix_ < other.prefix_);
+}
+
+std::istream& operator>>(std::istream& input, subnet& argument)
+{
+    std::string value;
+    input >> value;
+
+    const auto slash = value.find('/');
+    const auto host = value.substr(0, slash);
+    const auto bracketed = host.size() > 2 && host.front() == '[' &&
+        host.back() == ']';
+
+    boost_code ec;
+    const auto ip = asio::address::from_string(bracketed ?
+        host.substr(1, host.size() - 2) : host, ec);
+
+    if (ec)
+        BOOST_THROW_EXCEPTION(invalid_option_value(value));
+
+    const auto v4 = ip.is_v4();
+    const auto limit = v4 ? ipv4_bits : ipv6_bits;
+    auto prefix = limit;
+
+    if (slash != std::string::npos)
+    {
+        const auto length = value.substr(slash + 1);
+
+        if (length.empty() || length.size() > 3 ||
+            length.find_first_not_of("0123456789") != std::string::npos)
+            BOOST_THROW_EXCEPTION(invalid_option_value(value));
+
+        const auto bits = std::stoul(length);
+
+        if (bits > limit)
+            BOOST_THROW_EXCEPTION(invalid_option_value(value));
+
+        prefix = static_cast<uint8_t>(bits);
+    }
+
+    if (v4)
+        argument = subnet(asio::ipv6::v4_mapped(ip.to_v4()),
+            static_cast<uint8_t>(prefix + mapped_bits));
+    else
+        argument = subnet(ip.to_v6(), prefix);
+
+    return input;
+}
+
+std::ostream& operator<<(std::ostream& output, const subnet& argument)
+{
+    const auto& ip = argument.ip_;
+
+    if (ip.is_v4_mapped() && argument.prefix_ >= mapped_bits)
+        output << ip.to_v4() << "/" << (argument.prefix_ - mapped_bits);
+    else
+        output << ip << "/" << static_cast<uint32_t>(argument.prefix_);
+
+    return output;
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <bitcoin/network/timer_wheel.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libbitcoin {
+namespace network {
+
+using namespace std::placeholders;
+
+timer_wheel::timer_wheel(threadpool& pool, const asio::duration& resolution,
+    size_t slots)
+  : pool_(pool),
+    resolution_(std::max(resolution, asio::duration(1))),
+    stopped_(false),
+    started_(false),
+    next_(0),
+    cursor_(0),
+    slots_(std::max(slots, size_t(1))),
+    timer_(std::make_shared<deadline>(pool_, resolution_))
+{
+}
+
+// Start sequence.
+// ----------------------------------------------------------------------------
+
+void timer_wheel::start()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(mutex_);
+
+        if (started_)
+            return;
+
+        started_ = true;
+        stopped_ = false;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    start_timer();
+}
+
+void timer_wheel::stop()
+{
+    entries stopping;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (stopped_.exchange(true))
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        return;
+    }
+
+    started_ = false;
+    timer_->stop();
+    stopping.reserve(locations_.size());
+
+    for (auto& slot: slots_)
+    {
+        for (auto& timer: slot)
+            stopping.push_back(std::move(timer.second));
+
+        slot.clear();
+    }
+
+    locations_.clear();
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    post(stopping, error::service_stopped);
+}
+
+// Timers.
+// ----------------------------------------------------------------------------
+
+timer_wheel::key timer_wheel::schedule(const asio::duration& delay,
+    result_handler handler)
+{
+    return schedule(pool_, delay, std::move(handler));
+}
+
+timer_wheel::key timer_wheel::schedule(threadpool& pool,
+    const asio::duration& delay, result_handler handler)
+{
+    // Round up, so that a timer never expires before its delay.
+    const auto span = resolution_.count();
+    const auto ticks = static_cast<size_t>(
+        std::max(int64_t((delay.count() + span - 1) / span), int64_t(1)));
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    if (stopped_)
+    {
+        mutex_.unlock();
+        //---------------------------------------------------------------------
+        post(pool, std::move(handler), error::service_stopped);
+        return 0;
+    }
+
+    const auto timer = ++next_;
+    const auto size = slots_.size();
+    const auto target = (cursor_ + ticks) % size;
+    slots_[target].emplace(timer, entry{ (ticks - 1) / size, &pool,
+        std::move(handler) });
+    locations_.emplace(timer, target);
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    return timer;
+}
+
+bool timer_wheel::cancel(key timer)
+{
+    result_handler canceled;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    {
+        unique_lock lock(mutex_);
+
+        const auto location = locations_.find(timer);
+
+        if (location == locations_.end())
+            return false;
+
+        // The handler is destroyed outside of the lock, as it may hold the
+        // last reference to an object that cancels timers upon destruct.
+        auto& slot = slots_[location->second];
+        const auto it = slot.find(timer);
+        canceled = std::move(it->second.handler);
+        slot.erase(it);
+        locations_.erase(location);
+    }
+    ///////////////////////////////////////////////////////////////////////////
+
+    return true;
+}
+
+size_t timer_wheel::size() const
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    return locations_.size();
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void timer_wheel::advance()
+{
+    entries expired;
+
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    mutex_.lock();
+
+    cursor_ = (cursor_ + 1) % slots_.size();
+    auto& slot = slots_[cursor_];
+
+    for (auto it = slot.begin(); it != slot.end();)
+    {
+        if (it->second.rounds > 0)
+        {
+            --it->second.rounds;
+            ++it;
+            continue;
+        }
+
+        expired.push_back(std::move(it->second));
+        locations_.erase(it->first);
+        it = slot.erase(it);
+    }
+
+    mutex_.unlock();
+    ///////////////////////////////////////////////////////////////////////////
+
+    post(expired, error::success);
+}
+
+// private
+// Handlers are posted outside of the lock, as they may reschedule.
+void timer_wheel::post(entries& fired, const code& ec)
+{
+    for (auto& timer: fired)
+        post(*timer.pool, std::move(timer.handler), ec);
+}
+
+// private
+void timer_wheel::post(threadpool& pool, result_handler handler,
+    const code& ec)
+{
+    pool.service().post(std::bind(std::move(handler), ec));
+}
+
+// Tick sequence.
+// ----------------------------------------------------------------------------
+
+// private
+void timer_wheel::start_timer()
+{
+    // Critical Section
+    ///////////////////////////////////////////////////////////////////////////
+    shared_lock lock(mutex_);
+
+    if (stopped_)
+        return;
+
+    timer_->start(
+        std::bind(&timer_wheel::handle_timer,
+            shared_from_this(), _1));
+    ///////////////////////////////////////////////////////////////////////////
+}
+
+void timer_wheel::handle_timer(const code& ec)
+{
+    if (stopped_ || ec == error::service_stopped)
+        return;
+
+    advance();
+    start_timer();
+}
+
+} // namespace network
+} // namespace libbitcoin
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+#define ANCHORS_FILE "anchors_tests.cache"
+
+BOOST_AUTO_TEST_SUITE(anchors_tests)
+
+BOOST_AUTO_TEST_CASE(anchors__load__missing_file__empty)
+{
+    boost::filesystem::remove_all(ANCHORS_FILE);
+    const anchors instance(ANCHORS_FILE);
+    BOOST_REQUIRE(instance.load().empty());
+}
+
+BOOST_AUTO_TEST_CASE(anchors__save__round_trip__expected)
+{
+    boost::filesystem::remove_all(ANCHORS_FILE);
+    const anchors instance(ANCHORS_FILE);
+    const anchors::list values
+    {
+        { config::authority("1.2.3.4:8333"), 70015,
+            asio::duration(std::chrono::milliseconds(42)) },
+        { config::authority("[2001:db8::1]:18333"), 70002,
+            asio::duration::zero() }
+    };
+
+    BOOST_REQUIRE(instance.save(values));
+
+    const auto loaded = instance.load();
+    BOOST_REQUIRE_EQUAL(loaded.size(), 2u);
+    BOOST_REQUIRE(loaded[0].authority == values[0].authority);
+    BOOST_REQUIRE_EQUAL(loaded[0].version, 70015u);
+    BOOST_REQUIRE(loaded[0].round_trip == values[0].round_trip);
+    BOOST_REQUIRE(loaded[1].authority == values[1].authority);
+    BOOST_REQUIRE(loaded[1].round_trip == asio::duration::zero());
+}
+
+BOOST_AUTO_TEST_CASE(anchors__load__saved__file_removed)
+{
+    boost::filesystem::remove_all(ANCHORS_FILE);
+    const anchors instance(ANCHORS_FILE);
+    BOOST_REQUIRE(instance.save({ { config::authority("1.2.3.4:8333"),
+        70015, asio::duration::zero() } }));
+    BOOST_REQUIRE_EQUAL(instance.load().size(), 1u);
+    BOOST_REQUIRE(!boost::filesystem::exists(ANCHORS_FILE));
+    BOOST_REQUIRE(instance.load().empty());
+}
+
+BOOST_AUTO_TEST_CASE(anchors__load__corrupt_line__skipped)
+{
+    boost::filesystem::remove_all(ANCHORS_FILE);
+    {
+        std::ofstream file(ANCHORS_FILE);
+        file << "garbage" << std::endl;
+        file << "not-an-address 70015 1000" << std::endl;
+        file << "1.2.3.4:8333 70015 1000" << std::endl;
+    }
+
+    const anchors instance(ANCHORS_FILE);
+    const auto loaded = instance.load();
+    BOOST_REQUIRE_EQUAL(loaded.size(), 1u);
+    BOOST_REQUIRE_EQUAL(loaded[0].authority.port(), 8333u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(backoff_tests)
+
+BOOST_AUTO_TEST_CASE(backoff__next__initial__within_upper_half)
+{
+    backoff instance(asio::seconds(8), asio::seconds(60));
+    const auto delay = instance.next();
+    BOOST_REQUIRE(delay >= asio::seconds(4));
+    BOOST_REQUIRE(delay <= asio::seconds(8));
+}
+
+BOOST_AUTO_TEST_CASE(backoff__next__repeated__doubles)
+{
+    backoff instance(asio::seconds(8), asio::seconds(60));
+    instance.next();
+    const auto delay = instance.next();
+    BOOST_REQUIRE(delay >= asio::seconds(8));
+    BOOST_REQUIRE(delay <= asio::seconds(16));
+}
+
+BOOST_AUTO_TEST_CASE(backoff__next__repeated__capped_at_maximum)
+{
+    backoff instance(asio::seconds(8), asio::seconds(20));
+    instance.next();
+    instance.next();
+    const auto delay = instance.next();
+    BOOST_REQUIRE(delay >= asio::seconds(10));
+    BOOST_REQUIRE(delay <= asio::seconds(20));
+}
+
+BOOST_AUTO_TEST_CASE(backoff__reset__after_next__initial)
+{
+    backoff instance(asio::seconds(8), asio::seconds(60));
+    instance.next();
+    instance.next();
+    instance.reset();
+    const auto delay = instance.next();
+    BOOST_REQUIRE(delay >= asio::seconds(4));
+    BOOST_REQUIRE(delay <= asio::seconds(8));
+}
+
+BOOST_AUTO_TEST_CASE(backoff__next__zero_initial__zero)
+{
+    backoff instance(asio::seconds(0), asio::seconds(60));
+    BOOST_REQUIRE(instance.next() == asio::seconds(0));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::config;
+using namespace bc::network;
+
+static subnet::list make_list(const std::string& first,
+    const std::string& second = "")
+{
+    subnet::list list{ subnet(first) };
+
+    if (!second.empty())
+        list.push_back(subnet(second));
+
+    return list;
+}
+
+BOOST_AUTO_TEST_SUITE(blacklist_tests)
+
+BOOST_AUTO_TEST_CASE(subnet__construct__ipv4_range__round_trip)
+{
+    const subnet instance("10.1.2.3/16");
+    BOOST_REQUIRE_EQUAL(instance.prefix(), 96u + 16u);
+    BOOST_REQUIRE_EQUAL(instance.to_string(), "10.1.0.0/16");
+}
+
+BOOST_AUTO_TEST_CASE(subnet__construct__ipv6_range__round_trip)
+{
+    const subnet instance("2001:db8:ffff::1/32");
+    BOOST_REQUIRE_EQUAL(instance.prefix(), 32u);
+    BOOST_REQUIRE_EQUAL(instance.to_string(), "2001:db8::/32");
+}
+
+BOOST_AUTO_TEST_CASE(subnet__construct__excessive_prefix__throws)
+{
+    BOOST_REQUIRE_THROW(subnet("10.0.0.0/33"), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(subnet__group__ipv4__slash_16)
+{
+    const auto group = subnet::group(authority("10.1.2.3:8333"));
+    BOOST_REQUIRE_EQUAL(group.to_string(), "10.1.0.0/16");
+    BOOST_REQUIRE(group == subnet::group(authority("10.1.200.4:42")));
+    BOOST_REQUIRE(group != subnet::group(authority("10.2.2.3:8333")));
+}
+
+BOOST_AUTO_TEST_CASE(subnet__group__ipv6__slash_32)
+{
+    const auto group = subnet::group(authority("[2001:db8:ffff::1]:8333"));
+    BOOST_REQUIRE_EQUAL(group.to_string(), "2001:db8::/32");
+    BOOST_REQUIRE(group == subnet::group(authority("[2001:db8::2]:42")));
+    BOOST_REQUIRE(group != subnet::group(authority("[2001:db9::1]:8333")));
+}
+
+BOOST_AUTO_TEST_CASE(subnet__less__distinct_groups__strict_order)
+{
+    const auto first = subnet::group(authority("10.1.0.1:8333"));
+    const auto second = subnet::group(authority("10.2.0.1:8333"));
+    BOOST_REQUIRE(first < second);
+    BOOST_REQUIRE(!(second < first));
+    BOOST_REQUIRE(!(first < first));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__contains__ipv4_range__inside_only)
+{
+    const blacklist instance(make_list("10.1.0.0/16"));
+    BOOST_REQUIRE(instance.contains(authority("10.1.200.3:8333")));
+    BOOST_REQUIRE(!instance.contains(authority("10.2.0.1:8333")));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__contains__ipv6_range__inside_only)
+{
+    const blacklist instance(make_list("2001:db8::/32"));
+    BOOST_REQUIRE(instance.contains(authority("[2001:db8:1::1]:8333")));
+    BOOST_REQUIRE(!instance.contains(authority("[2001:db9::1]:8333")));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__contains__host_and_range__either)
+{
+    const blacklist instance(make_list("1.2.3.4", "1.2.0.0/16"));
+    BOOST_REQUIRE(instance.contains(authority("1.2.3.4:42")));
+    BOOST_REQUIRE(instance.contains(authority("1.2.3.5:42")));
+    BOOST_REQUIRE(!instance.contains(authority("1.3.3.4:42")));
+}
+
+BOOST_AUTO_TEST_CASE(blacklist__load__replacement__previous_removed)
+{
+    blacklist instance(make_list("10.0.0.0/8"));
+    instance.load(make_list("192.168.0.0/16"));
+    BOOST_REQUIRE(!instance.contains(authority("10.0.0.1:8333")));
+    BOOST_REQUIRE(instance.contains(authority("192.168.1.1:8333")));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
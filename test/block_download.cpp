@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+// A block distinguished by the nonce of its header.
+static block_const_ptr make_block(uint32_t nonce)
+{
+    return std::make_shared<const block>(
+        chain::header(1, null_hash, null_hash, 0, 0, nonce),
+        chain::transaction::list{});
+}
+
+static const block_download::block_handler deliver_nothing =
+    [](size_t, block_const_ptr)
+    {
+        return error::success;
+    };
+
+static const block_download::result_handler no_reject =
+    [](const code&)
+    {
+    };
+
+BOOST_AUTO_TEST_SUITE(block_download_tests)
+
+BOOST_AUTO_TEST_CASE(block_download__claim__buffer__lowest_heights_within)
+{
+    block_download instance(10, 2, deliver_nothing);
+    instance.enqueue(make_block(12)->header().hash(), 12);
+    instance.enqueue(make_block(11)->header().hash(), 11);
+    instance.enqueue(make_block(10)->header().hash(), 10);
+
+    block_download::items claimed;
+    instance.claim(5, claimed);
+    BOOST_REQUIRE_EQUAL(claimed.size(), 2u);
+    BOOST_REQUIRE_EQUAL(claimed[0].first, 10u);
+    BOOST_REQUIRE_EQUAL(claimed[1].first, 11u);
+
+    block_download::items more;
+    instance.claim(5, more);
+    BOOST_REQUIRE(more.empty());
+}
+
+BOOST_AUTO_TEST_CASE(block_download__release__claimed__reclaimed)
+{
+    block_download instance(0, 10, deliver_nothing);
+    instance.enqueue(make_block(0)->header().hash(), 0);
+    instance.enqueue(make_block(1)->header().hash(), 1);
+
+    block_download::items claimed;
+    instance.claim(1, claimed);
+    BOOST_REQUIRE_EQUAL(claimed.size(), 1u);
+
+    instance.release(claimed);
+
+    block_download::items reclaimed;
+    instance.claim(2, reclaimed);
+    BOOST_REQUIRE_EQUAL(reclaimed.size(), 2u);
+    BOOST_REQUIRE_EQUAL(reclaimed[0].first, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(block_download__accept__out_of_order__delivered_in_order)
+{
+    std::vector<size_t> delivered;
+    block_download instance(0, 10, [&](size_t height, block_const_ptr)
+    {
+        delivered.push_back(height);
+        return error::success;
+    });
+
+    const auto block0 = make_block(0);
+    const auto block1 = make_block(1);
+    const auto block2 = make_block(2);
+    instance.enqueue(block0->header().hash(), 0);
+    instance.enqueue(block1->header().hash(), 1);
+    instance.enqueue(block2->header().hash(), 2);
+
+    block_download::items claimed;
+    instance.claim(3, claimed);
+
+    BOOST_REQUIRE_EQUAL(instance.accept(block2, no_reject), error::success);
+    BOOST_REQUIRE_EQUAL(instance.accept(block1, no_reject), error::success);
+    BOOST_REQUIRE(delivered.empty());
+    BOOST_REQUIRE(!instance.complete());
+
+    BOOST_REQUIRE_EQUAL(instance.accept(block0, no_reject), error::success);
+    BOOST_REQUIRE_EQUAL(delivered.size(), 3u);
+    BOOST_REQUIRE_EQUAL(delivered[0], 0u);
+    BOOST_REQUIRE_EQUAL(delivered[2], 2u);
+    BOOST_REQUIRE_EQUAL(instance.next_height(), 3u);
+    BOOST_REQUIRE(instance.complete());
+}
+
+BOOST_AUTO_TEST_CASE(block_download__accept__unclaimed__not_found)
+{
+    block_download instance(0, 10, deliver_nothing);
+    const auto block0 = make_block(0);
+    instance.enqueue(block0->header().hash(), 0);
+    BOOST_REQUIRE_EQUAL(instance.accept(block0, no_reject), error::not_found);
+}
+
+BOOST_AUTO_TEST_CASE(block_download__accept__rejected__requeued_supplier_notified)
+{
+    auto reject = true;
+    std::vector<size_t> delivered;
+    block_download instance(0, 10, [&](size_t height, block_const_ptr)
+    {
+        if (height == 1 && reject)
+            return error::operation_failed;
+
+        delivered.push_back(height);
+        return error::success;
+    });
+
+    const auto block0 = make_block(0);
+    const auto block1 = make_block(1);
+    instance.enqueue(block0->header().hash(), 0);
+    instance.enqueue(block1->header().hash(), 1);
+
+    block_download::items claimed;
+    instance.claim(2, claimed);
+
+    code supplier1;
+    code supplier0;
+    const auto reject1 = [&](const code& ec) { supplier1 = ec; };
+    const auto reject0 = [&](const code& ec) { supplier0 = ec; };
+
+    // The block is rejected upon delivery driven by the other supplier.
+    BOOST_REQUIRE_EQUAL(instance.accept(block1, reject1), error::success);
+    BOOST_REQUIRE_EQUAL(instance.accept(block0, reject0), error::success);
+    BOOST_REQUIRE_EQUAL(supplier1, error::operation_failed);
+    BOOST_REQUIRE_EQUAL(supplier0, error::success);
+    BOOST_REQUIRE_EQUAL(delivered.size(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.next_height(), 1u);
+    BOOST_REQUIRE(!instance.complete());
+
+    block_download::items reclaimed;
+    instance.claim(2, reclaimed);
+    BOOST_REQUIRE_EQUAL(reclaimed.size(), 1u);
+    BOOST_REQUIRE_EQUAL(reclaimed[0].first, 1u);
+
+    reject = false;
+    BOOST_REQUIRE_EQUAL(instance.accept(block1, reject0), error::success);
+    BOOST_REQUIRE_EQUAL(supplier0, error::success);
+    BOOST_REQUIRE_EQUAL(delivered.size(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.next_height(), 2u);
+    BOOST_REQUIRE(instance.complete());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+BOOST_AUTO_TEST_SUITE(buffer_pool_tests)
+
+BOOST_AUTO_TEST_CASE(buffer_pool__get__empty__miss_expected_size)
+{
+    const auto pool = std::make_shared<buffer_pool>(1024 * 1024);
+    const auto buffer = pool->get(42);
+    BOOST_REQUIRE_EQUAL(buffer->size(), 42u);
+    BOOST_REQUIRE_EQUAL(pool->hits(), 0u);
+    BOOST_REQUIRE_EQUAL(pool->misses(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_pool__get__released_same_class__hit)
+{
+    const auto pool = std::make_shared<buffer_pool>(1024 * 1024);
+    pool->get(42);
+    BOOST_REQUIRE_EQUAL(pool->retained(), 1024u);
+
+    const auto buffer = pool->get(1000);
+    BOOST_REQUIRE_EQUAL(buffer->size(), 1000u);
+    BOOST_REQUIRE_EQUAL(pool->hits(), 1u);
+    BOOST_REQUIRE_EQUAL(pool->misses(), 1u);
+    BOOST_REQUIRE_EQUAL(pool->retained(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_pool__get__released_other_class__miss)
+{
+    const auto pool = std::make_shared<buffer_pool>(1024 * 1024);
+    pool->get(42);
+    pool->get(2000);
+    BOOST_REQUIRE_EQUAL(pool->hits(), 0u);
+    BOOST_REQUIRE_EQUAL(pool->misses(), 2u);
+    BOOST_REQUIRE_EQUAL(pool->retained(), 1024u + 2048u);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_pool__get__over_capacity__not_retained)
+{
+    const auto pool = std::make_shared<buffer_pool>(1024);
+    pool->get(2000);
+    BOOST_REQUIRE_EQUAL(pool->retained(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_pool__get__zero_capacity__not_retained)
+{
+    const auto pool = std::make_shared<buffer_pool>(0);
+    pool->get(42);
+    pool->get(42);
+    BOOST_REQUIRE_EQUAL(pool->retained(), 0u);
+    BOOST_REQUIRE_EQUAL(pool->misses(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_pool__get__pool_destroyed__buffer_valid)
+{
+    auto pool = std::make_shared<buffer_pool>(1024 * 1024);
+    const auto buffer = pool->get(42);
+    pool.reset();
+    BOOST_REQUIRE_EQUAL(buffer->size(), 42u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+static const config::authority first("127.0.0.1:1");
+static const config::authority second("127.0.0.2:2");
+
+struct channel_cache_fixture
+{
+    channel_cache_fixture()
+      : pool(1),
+        buffers(std::make_shared<buffer_pool>(0)),
+        timers(std::make_shared<timer_wheel>(pool, asio::seconds(3600), 4)),
+        ends(pipe_transport::make_pair(pool, first, second))
+    {
+    }
+
+    ~channel_cache_fixture()
+    {
+        ends.first->stop();
+        ends.second->stop();
+        pool.shutdown();
+        pool.join();
+    }
+
+    channel::ptr create(channel_cache::ptr cache)
+    {
+        return cache->create(pool, ends.first, configuration, buffers,
+            timers);
+    }
+
+    threadpool pool;
+    network::settings configuration;
+    buffer_pool::ptr buffers;
+    timer_wheel::ptr timers;
+    pipe_transport::pair ends;
+};
+
+BOOST_FIXTURE_TEST_SUITE(channel_cache_tests, channel_cache_fixture)
+
+BOOST_AUTO_TEST_CASE(channel_cache__create__empty__miss)
+{
+    const auto cache = std::make_shared<channel_cache>(10);
+    const auto created = create(cache);
+    BOOST_REQUIRE(created);
+    BOOST_REQUIRE_EQUAL(created->authority(), second);
+    BOOST_REQUIRE_EQUAL(cache->misses(), 1u);
+    BOOST_REQUIRE_EQUAL(cache->hits(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(channel_cache__create__released__hit)
+{
+    const auto cache = std::make_shared<channel_cache>(10);
+    create(cache).reset();
+    BOOST_REQUIRE_EQUAL(cache->retained(), 1u);
+
+    const auto created = create(cache);
+    BOOST_REQUIRE(created);
+    BOOST_REQUIRE_EQUAL(cache->hits(), 1u);
+    BOOST_REQUIRE_EQUAL(cache->retained(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(channel_cache__release__zero_limit__not_retained)
+{
+    const auto cache = std::make_shared<channel_cache>(0);
+    create(cache).reset();
+    BOOST_REQUIRE_EQUAL(cache->retained(), 0u);
+    create(cache).reset();
+    BOOST_REQUIRE_EQUAL(cache->hits(), 0u);
+    BOOST_REQUIRE_EQUAL(cache->misses(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(channel_cache__release__over_limit__capped)
+{
+    const auto cache = std::make_shared<channel_cache>(1);
+    auto one = create(cache);
+    auto two = create(cache);
+    one.reset();
+    two.reset();
+    BOOST_REQUIRE_EQUAL(cache->retained(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(channel_cache__release__cache_destroyed__freed)
+{
+    auto cache = std::make_shared<channel_cache>(10);
+    auto created = create(cache);
+    cache.reset();
+    created.reset();
+    BOOST_REQUIRE(!created);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
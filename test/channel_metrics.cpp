@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+using namespace std::chrono;
+
+BOOST_AUTO_TEST_SUITE(channel_metrics_tests)
+
+static size_t index(message_type type)
+{
+    return static_cast<size_t>(type);
+}
+
+BOOST_AUTO_TEST_CASE(channel_metrics__to_type__known_command__type)
+{
+    BOOST_REQUIRE(channel_metrics::to_type(ping::command) ==
+        message_type::ping);
+    BOOST_REQUIRE(channel_metrics::to_type(get_headers::command) ==
+        message_type::get_headers);
+}
+
+BOOST_AUTO_TEST_CASE(channel_metrics__to_type__unknown_command__unknown)
+{
+    BOOST_REQUIRE(channel_metrics::to_type("bogus") == message_type::unknown);
+}
+
+BOOST_AUTO_TEST_CASE(channel_metrics__to_command__known_type__command)
+{
+    BOOST_REQUIRE_EQUAL(channel_metrics::to_command(message_type::inventory),
+        inventory::command);
+}
+
+BOOST_AUTO_TEST_CASE(channel_metrics__to_command__unknown__unknown)
+{
+    BOOST_REQUIRE_EQUAL(channel_metrics::to_command(message_type::unknown),
+        "unknown");
+}
+
+BOOST_AUTO_TEST_CASE(channel_metrics__copy__default__zeroed)
+{
+    channel_metrics instance;
+    channel_statistics out;
+    instance.copy(out);
+    BOOST_REQUIRE(!out.received.empty());
+    BOOST_REQUIRE_EQUAL(out.received.size(), out.sent.size());
+    BOOST_REQUIRE_EQUAL(out.received[index(message_type::ping)].messages, 0u);
+    BOOST_REQUIRE_EQUAL(out.reads.count, 0u);
+    BOOST_REQUIRE_EQUAL(out.writes.count, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(channel_metrics__received__twice__counted_by_type)
+{
+    channel_metrics instance;
+    instance.received(message_type::ping, 32, microseconds(10));
+    instance.received(message_type::ping, 32, microseconds(30));
+    instance.received(message_type::pong, 32, microseconds(20));
+
+    channel_statistics out;
+    instance.copy(out);
+    BOOST_REQUIRE_EQUAL(out.received[index(message_type::ping)].messages, 2u);
+    BOOST_REQUIRE_EQUAL(out.received[index(message_type::ping)].bytes, 64u);
+    BOOST_REQUIRE_EQUAL(out.received[index(message_type::pong)].messages, 1u);
+    BOOST_REQUIRE_EQUAL(out.sent[index(message_type::ping)].messages, 0u);
+    BOOST_REQUIRE_EQUAL(out.reads.count, 3u);
+    BOOST_REQUIRE(out.reads.total == microseconds(60));
+    BOOST_REQUIRE(out.reads.maximum == microseconds(30));
+}
+
+BOOST_AUTO_TEST_CASE(channel_metrics__sent__written__counted)
+{
+    channel_metrics instance;
+    instance.sent(message_type::inventory, 61);
+    instance.written(microseconds(5));
+
+    channel_statistics out;
+    instance.copy(out);
+    BOOST_REQUIRE_EQUAL(out.sent[index(message_type::inventory)].bytes, 61u);
+    BOOST_REQUIRE_EQUAL(out.writes.count, 1u);
+    BOOST_REQUIRE(out.writes.maximum == microseconds(5));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
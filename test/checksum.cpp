@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+static data_chunk sequence(size_t size)
+{
+    data_chunk out(size);
+
+    for (size_t index = 0; index < size; ++index)
+        out[index] = static_cast<uint8_t>(index * 7 + 3);
+
+    return out;
+}
+
+BOOST_AUTO_TEST_SUITE(checksum_tests)
+
+BOOST_AUTO_TEST_CASE(checksum__payload_checksum__empty__bitcoin_checksum)
+{
+    const data_chunk payload;
+    BOOST_REQUIRE_EQUAL(payload_checksum(payload), bitcoin_checksum(payload));
+}
+
+// Sizes about the padding boundaries of one and two blocks.
+BOOST_AUTO_TEST_CASE(checksum__payload_checksum__sizes__bitcoin_checksum)
+{
+    for (const size_t size: { 1, 55, 56, 63, 64, 65, 119, 120, 128, 100000 })
+    {
+        const auto payload = sequence(size);
+        BOOST_REQUIRE_EQUAL(payload_checksum(payload),
+            bitcoin_checksum(payload));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(checksum__payload_hasher__parts__bitcoin_checksum)
+{
+    const auto payload = sequence(100000);
+    payload_hasher hasher;
+    size_t offset = 0;
+
+    // Parts of varying size split blocks at every offset.
+    for (size_t part = 1; offset < payload.size(); part = part % 149 + 1)
+    {
+        const auto size = std::min(part, payload.size() - offset);
+        hasher.update(payload.data() + offset, size);
+        offset += size;
+    }
+
+    BOOST_REQUIRE_EQUAL(hasher.checksum(), bitcoin_checksum(payload));
+}
+
+BOOST_AUTO_TEST_CASE(checksum__payload_hasher__checksum__resets)
+{
+    const auto payload = sequence(100);
+    payload_hasher hasher;
+    hasher.update(payload.data(), payload.size());
+    hasher.checksum();
+    hasher.update(payload.data(), payload.size());
+    BOOST_REQUIRE_EQUAL(hasher.checksum(), bitcoin_checksum(payload));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
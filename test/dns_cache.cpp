@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <future>
+#include <string>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+static code resolve_result(dns_cache::ptr cache, const std::string& hostname,
+    uint16_t port, dns_cache::endpoints& out_endpoints)
+{
+    std::promise<code> promise;
+    const auto handler = [&](const code& ec,
+        const dns_cache::endpoints& endpoints)
+    {
+        out_endpoints = endpoints;
+        promise.set_value(ec);
+    };
+
+    cache->resolve(hostname, port, handler);
+    return promise.get_future().get();
+}
+
+BOOST_AUTO_TEST_SUITE(dns_cache_tests)
+
+BOOST_AUTO_TEST_CASE(dns_cache__resolve__numeric_host__expected_endpoint)
+{
+    threadpool pool(1);
+    const network::settings configuration;
+    const auto cache = std::make_shared<dns_cache>(pool, configuration);
+
+    dns_cache::endpoints endpoints;
+    const auto ec = resolve_result(cache, "127.0.0.1", 42, endpoints);
+    BOOST_REQUIRE_EQUAL(ec, error::success);
+    BOOST_REQUIRE_EQUAL(endpoints.size(), 1u);
+    BOOST_REQUIRE_EQUAL(endpoints.front().port(), 42u);
+
+    cache->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(dns_cache__resolve__cached__same_endpoints)
+{
+    threadpool pool(1);
+    const network::settings configuration;
+    const auto cache = std::make_shared<dns_cache>(pool, configuration);
+
+    dns_cache::endpoints first;
+    dns_cache::endpoints second;
+    BOOST_REQUIRE_EQUAL(resolve_result(cache, "127.0.0.1", 42, first),
+        error::success);
+    BOOST_REQUIRE_EQUAL(resolve_result(cache, "127.0.0.1", 42, second),
+        error::success);
+    BOOST_REQUIRE(first == second);
+
+    cache->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
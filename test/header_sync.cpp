@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::config;
+using namespace bc::message;
+using namespace bc::network;
+
+// A chain of linked headers, the first of which is the start.
+static header::list make_chain(size_t count)
+{
+    header::list out;
+    auto previous = null_hash;
+
+    for (size_t height = 0; height < count; ++height)
+    {
+        out.emplace_back(1, previous, null_hash, 0, 0,
+            static_cast<uint32_t>(height));
+        previous = out.back().hash();
+    }
+
+    return out;
+}
+
+static checkpoint at(const header::list& chain, size_t height)
+{
+    return { chain[height].hash(), height };
+}
+
+static const header_sync::store_handler store_nothing =
+    [](size_t, const header::list&)
+    {
+        return error::success;
+    };
+
+BOOST_AUTO_TEST_SUITE(header_sync_tests)
+
+BOOST_AUTO_TEST_CASE(header_sync__assign__two_checkpoints__three_ranges)
+{
+    const auto chain = make_chain(5);
+    header_sync instance(at(chain, 0), { at(chain, 4), at(chain, 2) },
+        store_nothing);
+
+    size_t range;
+    BOOST_REQUIRE(instance.assign(range));
+    BOOST_REQUIRE_EQUAL(range, 0u);
+    BOOST_REQUIRE(instance.assign(range));
+    BOOST_REQUIRE(instance.assign(range));
+    BOOST_REQUIRE_EQUAL(range, 2u);
+    BOOST_REQUIRE(!instance.assign(range));
+
+    instance.release(1);
+    BOOST_REQUIRE(instance.assign(range));
+    BOOST_REQUIRE_EQUAL(range, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(header_sync__accept__linked_to_checkpoint__complete)
+{
+    const auto chain = make_chain(5);
+    size_t stored_height = 0;
+    size_t stored_count = 0;
+
+    header_sync instance(at(chain, 0), { at(chain, 2) },
+        [&](size_t height, const header::list& headers)
+        {
+            stored_height = height;
+            stored_count = headers.size();
+            return error::success;
+        });
+
+    size_t range;
+    BOOST_REQUIRE(instance.assign(range));
+
+    bool complete;
+    const headers response({ chain[1], chain[2] });
+    BOOST_REQUIRE_EQUAL(instance.accept(range, response, complete),
+        error::success);
+    BOOST_REQUIRE(complete);
+    BOOST_REQUIRE_EQUAL(stored_height, 1u);
+    BOOST_REQUIRE_EQUAL(stored_count, 2u);
+    BOOST_REQUIRE_EQUAL(instance.top().height(), 2u);
+    BOOST_REQUIRE(!instance.complete());
+}
+
+BOOST_AUTO_TEST_CASE(header_sync__accept__open_short_response__complete)
+{
+    const auto chain = make_chain(3);
+    header_sync instance(at(chain, 0), {}, store_nothing);
+
+    size_t range;
+    BOOST_REQUIRE(instance.assign(range));
+
+    bool complete;
+    const headers response({ chain[1], chain[2] });
+    BOOST_REQUIRE_EQUAL(instance.accept(range, response, complete),
+        error::success);
+    BOOST_REQUIRE(complete);
+    BOOST_REQUIRE(instance.complete());
+    BOOST_REQUIRE(instance.top().hash() == chain[2].hash());
+}
+
+BOOST_AUTO_TEST_CASE(header_sync__accept__unlinked__bad_stream)
+{
+    const auto chain = make_chain(3);
+    header_sync instance(at(chain, 0), {}, store_nothing);
+
+    size_t range;
+    BOOST_REQUIRE(instance.assign(range));
+
+    bool complete;
+    const headers response({ chain[2] });
+    BOOST_REQUIRE_EQUAL(instance.accept(range, response, complete),
+        error::bad_stream);
+    BOOST_REQUIRE(!complete);
+    BOOST_REQUIRE_EQUAL(instance.top().height(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(header_sync__accept__checkpoint_mismatch__failed)
+{
+    const auto chain = make_chain(2);
+    header_sync instance(at(chain, 0), { { null_hash, 1 } }, store_nothing);
+
+    size_t range;
+    BOOST_REQUIRE(instance.assign(range));
+
+    bool complete;
+    const headers response({ chain[1] });
+    BOOST_REQUIRE_EQUAL(instance.accept(range, response, complete),
+        error::checkpoints_failed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
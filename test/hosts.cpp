@@ -0,0 +1,330 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <fstream>
+#include <set>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+#define HOSTS_FILE "hosts_tests.cache"
+
+static network_address make_address(uint8_t last, uint16_t port)
+{
+    const ip_address ip
+    {
+        { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 1, 2, 3, last }
+    };
+
+    return network_address(0, 0, ip, port);
+}
+
+// A single shard makes eviction order deterministic.
+static network::settings make_settings(size_t capacity, size_t shards = 1)
+{
+    boost::filesystem::remove_all(HOSTS_FILE);
+    network::settings configuration;
+    configuration.host_pool_capacity = static_cast<uint32_t>(capacity);
+    configuration.host_pool_shards = static_cast<uint32_t>(shards);
+    configuration.hosts_file = HOSTS_FILE;
+    return configuration;
+}
+
+BOOST_AUTO_TEST_SUITE(hosts_tests)
+
+BOOST_AUTO_TEST_CASE(hosts__store__duplicate__count_one)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__store__distinct_port__count_two)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 43)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__remove__stored__removed)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(2, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(3, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(1, 42)),
+        error::not_found);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+
+    // The moved address remains indexed.
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(3, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(2, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__store__full__oldest_evicted)
+{
+    const auto configuration = make_settings(2);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(2, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(3, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(1, 42)),
+        error::not_found);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(2, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(3, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__stop__stored__reloaded)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(2, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__store__sharded__all_found)
+{
+    const auto configuration = make_settings(100, 8);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+
+    for (uint8_t index = 0; index < 16; ++index)
+        BOOST_REQUIRE_EQUAL(instance.store(make_address(index, 42)),
+            error::success);
+
+    BOOST_REQUIRE_EQUAL(instance.count(), 16u);
+
+    network_address host;
+    BOOST_REQUIRE_EQUAL(instance.fetch(host), error::success);
+    BOOST_REQUIRE_EQUAL(instance.remove(host), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 15u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__store_list__duplicates__stored_once)
+{
+    const auto configuration = make_settings(10, 2);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+
+    const network_address::list list
+    {
+        make_address(1, 42), make_address(2, 42), make_address(2, 42),
+        make_address(3, 42)
+    };
+
+    code result(error::operation_failed);
+    instance.store(list, [&](const code& ec) { result = ec; });
+    BOOST_REQUIRE_EQUAL(result, error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 3u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__fetch_list__sharded__distinct_addresses)
+{
+    const auto configuration = make_settings(200, 4);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+
+    for (uint16_t port = 1; port <= 200; ++port)
+        BOOST_REQUIRE_EQUAL(instance.store(make_address(1, port)),
+            error::success);
+
+    network_address::list out;
+    BOOST_REQUIRE_EQUAL(instance.fetch(out), error::success);
+    BOOST_REQUIRE(!out.empty());
+
+    std::set<uint16_t> ports;
+
+    for (const auto& host: out)
+        BOOST_REQUIRE(ports.insert(host.port()).second);
+
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__store__zero_timestamp__aged)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+
+    network_address host;
+    const auto current = static_cast<uint32_t>(zulu_time());
+    BOOST_REQUIRE_EQUAL(instance.fetch(host), error::success);
+    BOOST_REQUIRE(host.timestamp() != 0);
+    BOOST_REQUIRE(host.timestamp() < current);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__good__stored__timestamp_current)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+
+    const auto before = static_cast<uint32_t>(zulu_time());
+    BOOST_REQUIRE_EQUAL(instance.good(make_address(1, 42)), error::success);
+
+    network_address host;
+    BOOST_REQUIRE_EQUAL(instance.fetch(host), error::success);
+    BOOST_REQUIRE_GE(host.timestamp(), before);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__failed__new_once__retained)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__failed__new_to_limit__removed)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)),
+        error::not_found);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__failed__tried__demoted_after_limit)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.good(make_address(1, 42)), error::success);
+
+    // Three failures demote to new, and three more failures remove.
+    for (size_t failure = 0; failure < 5; ++failure)
+        BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)),
+            error::success);
+
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__good__unknown__not_found)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.good(make_address(1, 42)), error::not_found);
+    BOOST_REQUIRE_EQUAL(instance.count(), 0u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__stop__tried__reloaded_tried)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(2, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.good(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+
+    // A tried address survives more failures than a new address.
+    for (size_t failure = 0; failure < 3; ++failure)
+    {
+        BOOST_REQUIRE_EQUAL(instance.failed(make_address(1, 42)),
+            error::success);
+        BOOST_REQUIRE_EQUAL(instance.failed(make_address(2, 42)),
+            error::success);
+    }
+
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__start__text_file__loaded)
+{
+    const auto configuration = make_settings(10);
+
+    {
+        std::ofstream file(HOSTS_FILE);
+        file << "1.2.3.1:42" << std::endl;
+        file << "1.2.3.2:42" << std::endl;
+        file << "1.2.3.2:42" << std::endl;
+    }
+
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 2u);
+    BOOST_REQUIRE_EQUAL(instance.remove(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_CASE(hosts__save__started__file_retained)
+{
+    const auto configuration = make_settings(10);
+    hosts instance(configuration);
+    BOOST_REQUIRE_EQUAL(instance.start(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.store(make_address(1, 42)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.save(), error::success);
+    BOOST_REQUIRE_EQUAL(instance.count(), 1u);
+    BOOST_REQUIRE(boost::filesystem::exists(HOSTS_FILE));
+    BOOST_REQUIRE_EQUAL(instance.stop(), error::success);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,9 +16,13 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <future>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <boost/test/unit_test.hpp>
@@ -171,6 +175,37 @@ static int send_result(const Message& message, p2p& network, int channels)
     return result;
 }
 
+// Reports whether the first pended channel is pending under its own nonce.
+class loopback_p2p
+  : public p2p
+{
+public:
+    loopback_p2p(const network::settings& settings)
+      : p2p(settings), pended_(false)
+    {
+    }
+
+    code pend(channel::ptr channel) override
+    {
+        const auto ec = p2p::pend(channel);
+
+        if (!pended_.exchange(true))
+            promise_.set_value(channel->nonce() != 0 &&
+                pending(channel->nonce()));
+
+        return ec;
+    }
+
+    std::future<bool> pended()
+    {
+        return promise_.get_future();
+    }
+
+private:
+    std::atomic<bool> pended_;
+    std::promise<bool> promise_;
+};
+
 // Trivial tests just validate static inits (required because p2p tests disabled in travis).
 BOOST_AUTO_TEST_SUITE(empty_tests)
 
@@ -428,6 +463,97 @@ BOOST_AUTO_TEST_CASE(p2p__subscribe__started_stop__service_stopped)
     network.subscribe_connection(handler);
 }
 
+BOOST_AUTO_TEST_CASE(p2p__announce__started__relayed_to_subscriber)
+{
+    print_headers(TEST_NAME);
+    SETTINGS_TESTNET_ONE_THREAD_NO_CONNECTIONS(configuration);
+    p2p network(configuration);
+    BOOST_REQUIRE_EQUAL(start_result(network), error::success);
+
+    std::promise<hash_digest> promise;
+    const auto handler = [&promise](code ec,
+        const message::inventory_vector& inventory)
+    {
+        BOOST_REQUIRE_EQUAL(ec, error::success);
+        promise.set_value(inventory.hash());
+        return false;
+    };
+
+    network.subscribe_announcement(handler);
+    network.announce({ message::inventory_vector::type_id::transaction,
+        bitcoin_hash(to_chunk("relay")) });
+
+    BOOST_REQUIRE(promise.get_future().get() ==
+        bitcoin_hash(to_chunk("relay")));
+}
+
+BOOST_AUTO_TEST_CASE(p2p__unsubscribe_announcement__subscribed__not_relayed)
+{
+    print_headers(TEST_NAME);
+    SETTINGS_TESTNET_ONE_THREAD_NO_CONNECTIONS(configuration);
+    p2p network(configuration);
+    BOOST_REQUIRE_EQUAL(start_result(network), error::success);
+
+    std::promise<code> promise;
+    const auto key = network.subscribe_announcement([&promise](code ec,
+        const message::inventory_vector&)
+    {
+        promise.set_value(ec);
+        return false;
+    });
+
+    BOOST_REQUIRE_NE(key, 0u);
+    network.unsubscribe_announcement(key);
+    network.announce({ message::inventory_vector::type_id::transaction,
+        bitcoin_hash(to_chunk("relay")) });
+
+    // The released handler is neither relayed nor stopped.
+    BOOST_REQUIRE(network.stop());
+    auto future = promise.get_future();
+    BOOST_REQUIRE(future.wait_for(std::chrono::milliseconds(100)) ==
+        std::future_status::timeout);
+}
+
+BOOST_AUTO_TEST_CASE(p2p__protocol_inventory_relay__channel_stopped__released)
+{
+    print_headers(TEST_NAME);
+    SETTINGS_TESTNET_ONE_THREAD_NO_CONNECTIONS(configuration);
+    p2p network(configuration);
+    BOOST_REQUIRE_EQUAL(start_result(network), error::success);
+
+    threadpool pool(1);
+    const auto ends = pipe_transport::make_pair(pool,
+        config::authority("127.0.0.1:1"), config::authority("127.0.0.2:2"));
+    const auto channel = std::make_shared<network::channel>(pool, ends.first,
+        configuration, std::make_shared<buffer_pool>(0), network.timers());
+
+    std::promise<code> started;
+    channel->start([&started](const code& ec)
+    {
+        started.set_value(ec);
+    });
+
+    BOOST_REQUIRE_EQUAL(started.get_future().get(), error::success);
+
+    auto protocol = std::make_shared<protocol_inventory_relay>(network,
+        channel);
+    protocol->start();
+    const std::weak_ptr<protocol_inventory_relay> released(protocol);
+    protocol.reset();
+
+    // The protocol is released upon channel stop, without any announcement.
+    channel->stop(error::channel_stopped);
+
+    for (size_t wait = 0; wait < 100 && !released.expired(); ++wait)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    BOOST_REQUIRE(released.expired());
+
+    ends.second->stop();
+    pool.shutdown();
+    pool.join();
+}
+
 BOOST_AUTO_TEST_CASE(p2p__subscribe__started_connect1__success)
 {
     print_headers(TEST_NAME);
@@ -462,6 +588,33 @@ BOOST_AUTO_TEST_CASE(p2p__broadcast__ping_two_distinct_hosts__two_sends_and_succ
     BOOST_REQUIRE_EQUAL(send_result(ping(0), network, 2), error::success);
 }
 
+// The outbound session connects to the inbound listener of the same node.
+BOOST_AUTO_TEST_CASE(p2p__pend__loopback__pending_under_version_nonce)
+{
+    print_headers(TEST_NAME);
+    SETTINGS_TESTNET_ONE_THREAD_NO_CONNECTIONS(configuration);
+    configuration.threads = 2;
+    configuration.inbound_port = 18339;
+    configuration.inbound_connections = 1;
+    configuration.outbound_connections = 1;
+    configuration.host_pool_capacity = 42;
+    configuration.hosts_file = get_log_path(TEST_NAME, "hosts");
+    loopback_p2p network(configuration);
+    auto pended = network.pended();
+
+    BOOST_REQUIRE_EQUAL(start_result(network), error::success);
+    BOOST_REQUIRE_EQUAL(run_result(network), error::success);
+
+    const config::authority self("127.0.0.1:18339");
+    BOOST_REQUIRE_EQUAL(network.store(self.to_network_address()),
+        error::success);
+
+    BOOST_REQUIRE(pended.wait_for(std::chrono::seconds(30)) ==
+        std::future_status::ready);
+    BOOST_REQUIRE(pended.get());
+    BOOST_REQUIRE(network.stop());
+}
+
 ////BOOST_AUTO_TEST_CASE(p2p__subscribe__seed_outbound__success)
 ////{
 ////    print_headers(TEST_NAME);
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+// Transactions distinguished by lock time, the first treated as coinbase.
+static chain::transaction make_transaction(uint32_t locktime)
+{
+    return { 1, locktime, chain::input::list{}, chain::output::list{} };
+}
+
+static block make_block()
+{
+    const chain::transaction::list transactions
+    {
+        make_transaction(0), make_transaction(1), make_transaction(2)
+    };
+
+    const auto merkle = chain::block(chain::header{},
+        chain::transaction::list(transactions)).generate_merkle_root();
+
+    return { chain::header(1, null_hash, merkle, 0, 0, 0),
+        chain::transaction::list(transactions) };
+}
+
+static partial_block::transaction_pool make_pool(
+    const chain::transaction::list& transactions)
+{
+    return [transactions](partial_block::transaction_visitor visitor)
+    {
+        for (const auto& tx: transactions)
+            if (!visitor(std::make_shared<const transaction>(tx)))
+                return;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(partial_block_tests)
+
+BOOST_AUTO_TEST_CASE(partial_block__populate__all_pooled__block)
+{
+    const auto full = make_block();
+    const auto compact = partial_block::compact(full, 42, false);
+    partial_block instance(compact, false);
+    BOOST_REQUIRE(instance.valid());
+    BOOST_REQUIRE_EQUAL(instance.missing(), 2u);
+
+    const auto& transactions = full.transactions();
+    BOOST_REQUIRE_EQUAL(instance.populate(make_pool(transactions)), 2u);
+    BOOST_REQUIRE_EQUAL(instance.missing(), 0u);
+
+    const auto out = instance.block();
+    BOOST_REQUIRE(out);
+    BOOST_REQUIRE(out->header().hash() == full.header().hash());
+}
+
+BOOST_AUTO_TEST_CASE(partial_block__fill__one_missing__block)
+{
+    const auto full = make_block();
+    const auto& transactions = full.transactions();
+    partial_block instance(partial_block::compact(full, 42, false), false);
+    instance.populate(make_pool({ transactions[1] }));
+    BOOST_REQUIRE_EQUAL(instance.missing(), 1u);
+    BOOST_REQUIRE(!instance.block());
+
+    // Indexes are differentially encoded, the first is absolute.
+    const auto request = instance.request();
+    BOOST_REQUIRE_EQUAL(request.indexes().size(), 1u);
+    BOOST_REQUIRE_EQUAL(request.indexes().front(), 2u);
+
+    const block_transactions response(full.header().hash(),
+        { transactions[2] });
+    BOOST_REQUIRE_EQUAL(instance.fill(response), error::success);
+    BOOST_REQUIRE(instance.block());
+}
+
+BOOST_AUTO_TEST_CASE(partial_block__fill__wrong_count__bad_stream)
+{
+    const auto full = make_block();
+    partial_block instance(partial_block::compact(full, 42, false), false);
+
+    const block_transactions response(full.header().hash(), {});
+    BOOST_REQUIRE_EQUAL(instance.fill(response), error::bad_stream);
+}
+
+BOOST_AUTO_TEST_CASE(partial_block__construct__duplicate_short_ids__invalid)
+{
+    const auto full = make_block();
+    const auto compact = partial_block::compact(full, 42, false);
+    auto short_ids = compact.short_ids();
+    short_ids.back() = short_ids.front();
+
+    const compact_block duplicated(compact.header(), compact.nonce(),
+        short_ids, compact.transactions());
+    BOOST_REQUIRE(!partial_block(duplicated, false).valid());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+static const config::authority first("127.0.0.1:1");
+static const config::authority second("127.0.0.2:2");
+
+static boost_code read_result(pipe_transport::ptr end, data_chunk& out)
+{
+    std::promise<boost_code> promise;
+    end->read(boost::asio::buffer(out), [&](const boost_code& ec, size_t)
+    {
+        promise.set_value(ec);
+    });
+
+    return promise.get_future().get();
+}
+
+static size_t read_some_result(pipe_transport::ptr end, data_chunk& out)
+{
+    std::promise<size_t> promise;
+    end->read_some(boost::asio::buffer(out),
+        [&](const boost_code& ec, size_t size)
+        {
+            promise.set_value(ec ? 0 : size);
+        });
+
+    return promise.get_future().get();
+}
+
+static boost_code write_result(pipe_transport::ptr end, const data_chunk& in)
+{
+    std::promise<boost_code> promise;
+    end->write({ boost::asio::buffer(in) }, [&](const boost_code& ec, size_t)
+    {
+        promise.set_value(ec);
+    });
+
+    return promise.get_future().get();
+}
+
+BOOST_AUTO_TEST_SUITE(pipe_transport_tests)
+
+BOOST_AUTO_TEST_CASE(pipe_transport__make_pair__authorities__reversed)
+{
+    threadpool pool(1);
+    const auto ends = pipe_transport::make_pair(pool, first, second);
+    BOOST_REQUIRE_EQUAL(ends.first->authority(), second);
+    BOOST_REQUIRE_EQUAL(ends.second->authority(), first);
+
+    ends.first->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(pipe_transport__read__written__same_bytes)
+{
+    threadpool pool(1);
+    const auto ends = pipe_transport::make_pair(pool, first, second);
+    const data_chunk written{ 1, 2, 3, 4, 5 };
+    BOOST_REQUIRE(!write_result(ends.first, written));
+
+    data_chunk head(2);
+    data_chunk tail(3);
+    BOOST_REQUIRE(!read_result(ends.second, head));
+    BOOST_REQUIRE(!read_result(ends.second, tail));
+    BOOST_REQUIRE(head == (data_chunk{ 1, 2 }));
+    BOOST_REQUIRE(tail == (data_chunk{ 3, 4, 5 }));
+
+    ends.first->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(pipe_transport__read_some__written__available_bytes)
+{
+    threadpool pool(1);
+    const auto ends = pipe_transport::make_pair(pool, first, second);
+    BOOST_REQUIRE(!write_result(ends.first, { 1, 2, 3 }));
+
+    data_chunk out(8, 0);
+    BOOST_REQUIRE_EQUAL(read_some_result(ends.second, out), 3u);
+    BOOST_REQUIRE(out == (data_chunk{ 1, 2, 3, 0, 0, 0, 0, 0 }));
+
+    ends.first->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(pipe_transport__read__peer_stopped__eof)
+{
+    threadpool pool(1);
+    const auto ends = pipe_transport::make_pair(pool, first, second);
+    ends.first->stop();
+
+    data_chunk out(1);
+    BOOST_REQUIRE(read_result(ends.second, out) == boost::asio::error::eof);
+    BOOST_REQUIRE(write_result(ends.second, out) ==
+        boost::asio::error::broken_pipe);
+
+    ends.second->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
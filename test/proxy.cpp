@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <future>
+#include <memory>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+static const config::authority first("127.0.0.1:1");
+static const config::authority second("127.0.0.2:2");
+
+struct proxy_fixture
+{
+    proxy_fixture()
+      : pool(2),
+        configuration(config::settings::mainnet),
+        buffers(std::make_shared<buffer_pool>(0)),
+        timers(std::make_shared<timer_wheel>(pool, asio::seconds(1), 60)),
+        ends(pipe_transport::make_pair(pool, first, second))
+    {
+        timers->start();
+    }
+
+    ~proxy_fixture()
+    {
+        ends.first->stop();
+        ends.second->stop();
+        timers->stop();
+        pool.shutdown();
+        pool.join();
+    }
+
+    template <class Message>
+    void write(const channel::ptr channel, const Message& message)
+    {
+        const auto data = std::make_shared<data_chunk>(message::serialize(
+            channel->negotiated_version(), message, configuration.identifier));
+
+        ends.second->write({ boost::asio::buffer(*data) },
+            [data](const boost_code&, size_t) {});
+    }
+
+    threadpool pool;
+    network::settings configuration;
+    buffer_pool::ptr buffers;
+    timer_wheel::ptr timers;
+    pipe_transport::pair ends;
+};
+
+BOOST_FIXTURE_TEST_SUITE(proxy_tests, proxy_fixture)
+
+BOOST_AUTO_TEST_CASE(proxy__read__unsubscribed_payload__skipped)
+{
+    const auto channel = std::make_shared<network::channel>(pool,
+        ends.first, configuration, buffers, timers);
+
+    std::promise<code> started;
+    channel->start([&](const code& ec)
+    {
+        started.set_value(ec);
+    });
+
+    BOOST_REQUIRE_EQUAL(started.get_future().get(), error::success);
+
+    auto received = std::make_shared<std::promise<code>>();
+    channel->subscribe<ping>([received](const code& ec, ping_const_ptr)
+    {
+        received->set_value(ec);
+        return false;
+    });
+
+    // The get_headers payload is not empty and has no subscriber.
+    write(channel, get_headers({ null_hash }, null_hash));
+    write(channel, ping(42));
+
+    auto future = received->get_future();
+    BOOST_REQUIRE(future.wait_for(std::chrono::seconds(10)) ==
+        std::future_status::ready);
+    // A stop upon the skipped payload would notify with channel_stopped.
+    BOOST_REQUIRE_EQUAL(future.get(), error::success);
+
+    channel->stop(error::channel_stopped);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
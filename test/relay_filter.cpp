@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstddef>
+#include <cstdint>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+static chain::transaction make_transaction(uint32_t locktime)
+{
+    return { 1, locktime, chain::input::list{}, chain::output::list{} };
+}
+
+// An empty filter of the given size, which matches nothing until added to.
+static filter_load make_filter(size_t size)
+{
+    return { data_chunk(size, 0x00), 10, 42, relay_filter::update_none };
+}
+
+BOOST_AUTO_TEST_SUITE(relay_filter_tests)
+
+BOOST_AUTO_TEST_CASE(relay_filter__admits__no_filters__true)
+{
+    relay_filter instance;
+    BOOST_REQUIRE(!instance.loaded());
+    BOOST_REQUIRE(instance.admits(make_transaction(0), 0));
+}
+
+BOOST_AUTO_TEST_CASE(relay_filter__admits__below_fee_rate__false)
+{
+    relay_filter instance;
+    instance.set_minimum_fee_rate(1000);
+    BOOST_REQUIRE(!instance.admits(make_transaction(0), 999));
+    BOOST_REQUIRE(instance.admits(make_transaction(0), 1000));
+}
+
+BOOST_AUTO_TEST_CASE(relay_filter__admits__unknown_fee_rate__true)
+{
+    relay_filter instance;
+    instance.set_minimum_fee_rate(1000);
+    BOOST_REQUIRE(instance.admits(make_transaction(0), max_uint64));
+}
+
+BOOST_AUTO_TEST_CASE(relay_filter__admits__loaded_empty__false)
+{
+    relay_filter instance;
+    BOOST_REQUIRE_EQUAL(instance.load(make_filter(64)), error::success);
+    BOOST_REQUIRE(instance.loaded());
+    BOOST_REQUIRE(!instance.admits(make_transaction(0), max_uint64));
+}
+
+BOOST_AUTO_TEST_CASE(relay_filter__admits__added_hash__true)
+{
+    relay_filter instance;
+    const auto tx = make_transaction(0);
+    BOOST_REQUIRE_EQUAL(instance.load(make_filter(64)), error::success);
+    BOOST_REQUIRE_EQUAL(instance.add(filter_add{ to_chunk(tx.hash()) }),
+        error::success);
+    BOOST_REQUIRE(instance.admits(tx, max_uint64));
+    BOOST_REQUIRE(!instance.admits(make_transaction(1), max_uint64));
+}
+
+BOOST_AUTO_TEST_CASE(relay_filter__clear__loaded__admits)
+{
+    relay_filter instance;
+    BOOST_REQUIRE_EQUAL(instance.load(make_filter(64)), error::success);
+    instance.clear();
+    BOOST_REQUIRE(!instance.loaded());
+    BOOST_REQUIRE(instance.admits(make_transaction(0), max_uint64));
+}
+
+BOOST_AUTO_TEST_CASE(relay_filter__load__oversized__bad_stream)
+{
+    relay_filter instance;
+    BOOST_REQUIRE_EQUAL(instance.load(make_filter(36001)), error::bad_stream);
+    BOOST_REQUIRE(!instance.loaded());
+}
+
+BOOST_AUTO_TEST_CASE(relay_filter__add__not_loaded__bad_stream)
+{
+    relay_filter instance;
+    BOOST_REQUIRE_EQUAL(instance.add(filter_add{ data_chunk(32, 0x01) }),
+        error::bad_stream);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+static hash_digest make_hash(uint32_t value)
+{
+    return bitcoin_hash(to_chunk(to_little_endian(value)));
+}
+
+BOOST_AUTO_TEST_SUITE(rolling_bloom_tests)
+
+BOOST_AUTO_TEST_CASE(rolling_bloom__insert__new__true_contains)
+{
+    rolling_bloom instance(100, 0.000001);
+    BOOST_REQUIRE(!instance.contains(make_hash(1)));
+    BOOST_REQUIRE(instance.insert(make_hash(1)));
+    BOOST_REQUIRE(instance.contains(make_hash(1)));
+}
+
+BOOST_AUTO_TEST_CASE(rolling_bloom__insert__duplicate__false)
+{
+    rolling_bloom instance(100, 0.000001);
+    BOOST_REQUIRE(instance.insert(make_hash(1)));
+    BOOST_REQUIRE(!instance.insert(make_hash(1)));
+}
+
+BOOST_AUTO_TEST_CASE(rolling_bloom__contains__most_recent_capacity__true)
+{
+    const size_t capacity = 100;
+    rolling_bloom instance(capacity, 0.000001);
+
+    for (uint32_t value = 0; value < 10 * capacity; ++value)
+    {
+        instance.insert(make_hash(value));
+
+        const auto oldest = value < capacity ? 0 : value - capacity + 1;
+        BOOST_REQUIRE(instance.contains(make_hash(oldest)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rolling_bloom__contains__rolled_out__false)
+{
+    const size_t capacity = 100;
+    rolling_bloom instance(capacity, 0.000001);
+
+    for (uint32_t value = 0; value < 10 * capacity; ++value)
+        instance.insert(make_hash(value));
+
+    BOOST_REQUIRE(!instance.contains(make_hash(0)));
+}
+
+BOOST_AUTO_TEST_CASE(rolling_bloom__clear__inserted__not_contained)
+{
+    rolling_bloom instance(100, 0.000001);
+    instance.insert(make_hash(1));
+    instance.clear();
+    BOOST_REQUIRE(!instance.contains(make_hash(1)));
+}
+
+BOOST_AUTO_TEST_CASE(rolling_bloom__insert__zero_capacity__never_contained)
+{
+    rolling_bloom instance(0, 0.000001);
+    BOOST_REQUIRE(instance.insert(make_hash(1)));
+    BOOST_REQUIRE(instance.insert(make_hash(1)));
+    BOOST_REQUIRE(!instance.contains(make_hash(1)));
+    BOOST_REQUIRE_EQUAL(instance.capacity(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
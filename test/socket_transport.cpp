@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <memory>
+#include <boost/asio.hpp>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+static socket::ptr make_socket(threadpool& pool)
+{
+    const auto value = std::make_shared<bc::socket>(pool);
+    value->get().open(boost::asio::ip::tcp::v4());
+    return value;
+}
+
+BOOST_AUTO_TEST_SUITE(socket_transport_tests)
+
+BOOST_AUTO_TEST_CASE(socket_transport__configure__no_delay__effective)
+{
+    threadpool pool(1);
+    network::settings configuration;
+    configuration.socket_no_delay = true;
+    configuration.socket_keep_alive = true;
+
+    const auto socket = make_socket(pool);
+    socket_transport::configure(*socket, configuration);
+    const socket_transport instance(socket);
+
+    BOOST_REQUIRE(instance.options().no_delay);
+    BOOST_REQUIRE(instance.options().keep_alive);
+    BOOST_REQUIRE_GT(instance.options().send_buffer_bytes, 0u);
+    BOOST_REQUIRE_GT(instance.options().receive_buffer_bytes, 0u);
+    socket->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(socket_transport__configure__disabled__effective)
+{
+    threadpool pool(1);
+    network::settings configuration;
+    configuration.socket_no_delay = false;
+    configuration.socket_keep_alive = false;
+
+    const auto socket = make_socket(pool);
+    socket_transport::configure(*socket, configuration);
+    const socket_transport instance(socket);
+
+    BOOST_REQUIRE(!instance.options().no_delay);
+    BOOST_REQUIRE(!instance.options().keep_alive);
+    socket->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(socket_transport__configure__send_buffer__not_below)
+{
+    threadpool pool(1);
+    network::settings configuration;
+    configuration.socket_send_buffer_bytes = 262144;
+
+    const auto socket = make_socket(pool);
+    socket_transport::configure(*socket, configuration);
+    const socket_transport instance(socket);
+
+    // The system may round or double the requested size.
+    BOOST_REQUIRE_GE(instance.options().send_buffer_bytes, 131072u);
+    socket->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(socket_transport__options__pipe__none)
+{
+    threadpool pool(1);
+    const auto ends = pipe_transport::make_pair(pool,
+        config::authority("127.0.0.1:1"), config::authority("127.0.0.2:2"));
+
+    BOOST_REQUIRE(!ends.first->options().no_delay);
+    BOOST_REQUIRE_EQUAL(ends.first->options().send_buffer_bytes, 0u);
+    ends.first->stop();
+    ends.second->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
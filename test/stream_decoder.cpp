@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::message;
+using namespace bc::network;
+
+static const auto level = version::level::maximum;
+
+BOOST_AUTO_TEST_SUITE(stream_decoder_tests)
+
+BOOST_AUTO_TEST_CASE(stream_decoder__start__unsubscribed__false)
+{
+    threadpool pool(1);
+    message_subscriber subscriber(pool);
+    subscriber.start();
+    stream_decoder decoder(subscriber);
+    BOOST_REQUIRE(!decoder.start(message_type::block, level, 0));
+    BOOST_REQUIRE(!decoder.streaming());
+    subscriber.stop();
+}
+
+BOOST_AUTO_TEST_CASE(stream_decoder__start__subscribed_after_start__true)
+{
+    threadpool pool(1);
+    message_subscriber subscriber(pool);
+    subscriber.start();
+    BOOST_REQUIRE(!subscriber.stream_subscribed(message_type::headers));
+
+    // The stream subscriber is created, and started, upon subscription.
+    subscriber.subscribe_headers_stream(
+        [](const code&, size_t, streamed_header_ptr)
+        {
+            return false;
+        });
+
+    stream_decoder decoder(subscriber);
+    BOOST_REQUIRE(decoder.start(message_type::headers, level, 1));
+    BOOST_REQUIRE(!subscriber.stream_subscribed(message_type::block));
+    subscriber.stop();
+}
+
+BOOST_AUTO_TEST_CASE(stream_decoder__parse__block_bytewise__transactions)
+{
+    threadpool pool(1);
+    message_subscriber subscriber(pool);
+    subscriber.start();
+
+    const block instance(chain::block::genesis_mainnet());
+    const auto payload = instance.to_data(level);
+    std::vector<hash_digest> hashes;
+
+    subscriber.subscribe_block_stream(
+        [&](const code& ec, streamed_header_ptr header, size_t index,
+            streamed_transaction_ptr transaction)
+        {
+            if (ec)
+                return false;
+
+            BOOST_REQUIRE_EQUAL(index, hashes.size());
+            BOOST_REQUIRE(header->hash() == instance.header().hash());
+            hashes.push_back(transaction->hash());
+            return true;
+        });
+
+    stream_decoder decoder(subscriber);
+    BOOST_REQUIRE(decoder.start(message_type::block, level,
+        payload.size()));
+
+    // Each byte arrives alone, so every part is first incomplete.
+    for (size_t size = 1; size <= payload.size(); ++size)
+        decoder.parse(payload.data(), size);
+
+    BOOST_REQUIRE(!decoder.streaming());
+    BOOST_REQUIRE_EQUAL(hashes.size(), instance.transactions().size());
+    BOOST_REQUIRE(hashes.front() == instance.transactions().front().hash());
+    subscriber.stop();
+}
+
+BOOST_AUTO_TEST_CASE(stream_decoder__parse__headers_halves__headers)
+{
+    threadpool pool(1);
+    message_subscriber subscriber(pool);
+    subscriber.start();
+
+    const auto genesis = chain::block::genesis_mainnet().header();
+    const headers instance({ genesis, genesis });
+    const auto payload = instance.to_data(level);
+    size_t count = 0;
+
+    subscriber.subscribe_headers_stream(
+        [&](const code& ec, size_t index, streamed_header_ptr header)
+        {
+            if (ec)
+                return false;
+
+            BOOST_REQUIRE_EQUAL(index, count++);
+            BOOST_REQUIRE(header->hash() == genesis.hash());
+            return true;
+        });
+
+    stream_decoder decoder(subscriber);
+    BOOST_REQUIRE(decoder.start(message_type::headers, level,
+        payload.size()));
+    decoder.parse(payload.data(), payload.size() / 2);
+    BOOST_REQUIRE_EQUAL(count, 0u);
+    decoder.parse(payload.data(), payload.size());
+    BOOST_REQUIRE_EQUAL(count, 2u);
+    BOOST_REQUIRE(!decoder.streaming());
+    subscriber.stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2011-2017 libbitcoin developers (see AUTHORS)
+ *
+ * This file is part of libbitcoin.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/network.hpp>
+
+using namespace bc;
+using namespace bc::network;
+
+// The tick never fires within a test, the wheel is advanced explicitly.
+static const auto resolution = asio::seconds(3600);
+static const size_t slots = 4;
+
+// Handlers are posted, so wait out those posted to the single thread pool.
+static void flush(threadpool& pool)
+{
+    std::promise<void> flushed;
+    pool.service().post([&]()
+    {
+        flushed.set_value();
+    });
+
+    flushed.get_future().wait();
+}
+
+BOOST_AUTO_TEST_SUITE(timer_wheel_tests)
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__single_tick__fires_once)
+{
+    threadpool pool(1);
+    const auto wheel = std::make_shared<timer_wheel>(pool, resolution, slots);
+    wheel->start();
+
+    size_t fired = 0;
+    wheel->schedule(resolution, [&](const code& ec)
+    {
+        BOOST_REQUIRE_EQUAL(ec, error::success);
+        ++fired;
+    });
+
+    BOOST_REQUIRE_EQUAL(wheel->size(), 1u);
+    wheel->advance();
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(fired, 1u);
+    BOOST_REQUIRE_EQUAL(wheel->size(), 0u);
+    wheel->advance();
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(fired, 1u);
+
+    wheel->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__beyond_revolution__fires_on_round)
+{
+    threadpool pool(1);
+    const auto wheel = std::make_shared<timer_wheel>(pool, resolution, slots);
+    wheel->start();
+
+    size_t fired = 0;
+    const auto ticks = slots + 2;
+    const auto delay = resolution * static_cast<int64_t>(ticks);
+    wheel->schedule(delay, [&](const code&)
+    {
+        ++fired;
+    });
+
+    for (size_t tick = 1; tick < ticks; ++tick)
+        wheel->advance();
+
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(fired, 0u);
+    wheel->advance();
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(fired, 1u);
+
+    wheel->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__cancel__scheduled__not_fired)
+{
+    threadpool pool(1);
+    const auto wheel = std::make_shared<timer_wheel>(pool, resolution, slots);
+    wheel->start();
+
+    size_t fired = 0;
+    const auto timer = wheel->schedule(resolution, [&](const code&)
+    {
+        ++fired;
+    });
+
+    BOOST_REQUIRE(wheel->cancel(timer));
+    BOOST_REQUIRE(!wheel->cancel(timer));
+    wheel->advance();
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(fired, 0u);
+
+    wheel->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__stop__scheduled__service_stopped)
+{
+    threadpool pool(1);
+    const auto wheel = std::make_shared<timer_wheel>(pool, resolution, slots);
+    wheel->start();
+
+    code result;
+    wheel->schedule(resolution, [&](const code& ec)
+    {
+        result = ec;
+    });
+
+    wheel->stop();
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(result, error::service_stopped);
+    BOOST_REQUIRE_EQUAL(wheel->size(), 0u);
+
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__schedule__stopped__service_stopped)
+{
+    threadpool pool(1);
+    const auto wheel = std::make_shared<timer_wheel>(pool, resolution, slots);
+    wheel->start();
+    wheel->stop();
+
+    code result;
+    const auto timer = wheel->schedule(resolution, [&](const code& ec)
+    {
+        result = ec;
+    });
+
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(timer, 0u);
+    BOOST_REQUIRE_EQUAL(result, error::service_stopped);
+
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__schedule__before_start__scheduled)
+{
+    threadpool pool(1);
+    const auto wheel = std::make_shared<timer_wheel>(pool, resolution, slots);
+
+    code result(error::operation_failed);
+    const auto timer = wheel->schedule(resolution, [&](const code& ec)
+    {
+        result = ec;
+    });
+
+    BOOST_REQUIRE_NE(timer, 0u);
+    BOOST_REQUIRE_EQUAL(wheel->size(), 1u);
+    wheel->start();
+    wheel->advance();
+    flush(pool);
+    BOOST_REQUIRE_EQUAL(result, error::success);
+
+    wheel->stop();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_CASE(timer_wheel__advance__owner_pool__posted_to_owner)
+{
+    threadpool pool(1);
+    threadpool owner(1);
+    const auto wheel = std::make_shared<timer_wheel>(pool, resolution, slots);
+    wheel->start();
+
+    std::promise<std::thread::id> fired;
+    wheel->schedule(owner, resolution, [&](const code&)
+    {
+        fired.set_value(std::this_thread::get_id());
+    });
+
+    std::promise<std::thread::id> owned;
+    owner.service().post([&]()
+    {
+        owned.set_value(std::this_thread::get_id());
+    });
+
+    wheel->advance();
+    BOOST_REQUIRE(fired.get_future().get() == owned.get_future().get());
+
+    wheel->stop();
+    owner.shutdown();
+    owner.join();
+    pool.shutdown();
+    pool.join();
+}
+
+BOOST_AUTO_TEST_SUITE_END()